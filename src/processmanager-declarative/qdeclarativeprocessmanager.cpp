@@ -42,20 +42,26 @@
 #include "qdeclarativeprocessmanager.h"
 #include "qprocessbackendfactory.h"
 #include "qprocessfrontend.h"
+#include "qprocessevents.h"
+#include "qprocessgroup.h"
 
 #include "qprelaunchprocessbackend.h"
 #include "qremoteprocessbackend.h"
 #include "qstandardprocessbackend.h"
 
 #include "qcpuidledelegate.h"
+#include "qpsiidledelegate.h"
 #include "qtimeoutidledelegate.h"
 #include "qgdbrewritedelegate.h"
 #include "qinfomatchdelegate.h"
 #include "qkeymatchdelegate.h"
+#include "qlaunchpredictor.h"
 #include "qpipelauncher.h"
 #include "qpipeprocessbackendfactory.h"
 #include "qpreforkprocessbackendfactory.h"
 #include "qprelaunchprocessbackendfactory.h"
+#include "qrulematchdelegate.h"
+#include "qrulerewritedelegate.h"
 #include "qsocketlauncher.h"
 #include "qstandardprocessbackendfactory.h"
 #include "qsocketprocessbackendfactory.h"
@@ -123,6 +129,7 @@ void QDeclarativeProcessManager::registerTypes(const char *uri)
     qmlRegisterType<QPrelaunchProcessBackend>();
     qmlRegisterType<QProcessBackend>();
     qmlRegisterType<QProcessFrontend>();
+    qmlRegisterType<QProcessGroup>();
     qmlRegisterType<QProcessBackendFactory>();
     qmlRegisterType<QRemoteProcessBackend>();
     qmlRegisterType<QRemoteProcessBackendFactory>();
@@ -140,16 +147,21 @@ void QDeclarativeProcessManager::registerTypes(const char *uri)
 
     // Types registered from the Core library
     qmlRegisterType<QCpuIdleDelegate>(uri, 1, 0, "CpuIdleDelegate");
+    qmlRegisterType<QPsiIdleDelegate>(uri, 1, 0, "PsiIdleDelegate");
     qmlRegisterType<QGdbRewriteDelegate>(uri, 1, 0, "GdbRewriteDelegate");
     qmlRegisterType<QInfoMatchDelegate>(uri, 1, 0, "InfoMatchDelegate");
     qmlRegisterType<QKeyMatchDelegate>(uri, 1, 0, "KeyMatchDelegate");
+    qmlRegisterType<QLaunchPredictor>(uri, 1, 0, "LaunchPredictor");
     qmlRegisterType<QPipeLauncher>(uri, 1, 0, "PipeLauncher");
     qmlRegisterType<QPipeProcessBackendFactory>(uri, 1, 0, "PipeProcessBackendFactory");
     qmlRegisterType<QPreforkProcessBackendFactory>(uri, 1, 0, "PreforkProcessBackendFactory");
     qmlRegisterType<QPrelaunchProcessBackendFactory>(uri, 1, 0, "PrelaunchProcessBackendFactory");
     qmlRegisterType<QProcessBackendManager>(uri, 1, 0, "ProcessBackendManager");
+    qmlRegisterType<QProcessEvents>(uri, 1, 0, "ProcessEvents");
     qmlRegisterType<QProcessInfo>(uri, 1, 0, "ProcessInfo");
     qmlRegisterType<QProcessManager>(uri, 1, 0, "ProcessManager");
+    qmlRegisterType<QRuleMatchDelegate>(uri, 1, 0, "RuleMatchDelegate");
+    qmlRegisterType<QRuleRewriteDelegate>(uri, 1, 0, "RuleRewriteDelegate");
     qmlRegisterType<QSocketLauncher>(uri, 1, 0, "SocketLauncher");
     qmlRegisterType<QSocketProcessBackendFactory>(uri, 1, 0, "SocketProcessBackendFactory");
     qmlRegisterType<QStandardProcessBackendFactory>(uri, 1, 0, "StandardProcessBackendFactory");
@@ -205,6 +217,21 @@ QQmlListProperty<QProcessBackendFactory> QDeclarativeProcessManager::factories()
     return QQmlListProperty<QProcessBackendFactory>(this, NULL, append_factory, 0, 0, 0);
 }
 
+/*!
+  Return the last memory and CPU statistics sampled for the process
+  called \a name, as described for QProcessStatistics::toMap().  The
+  map is empty if there is no such process or nothing has been
+  sampled yet.
+
+  \sa QProcessManager::samplingInterval
+*/
+
+QVariantMap QDeclarativeProcessManager::processStatistics(const QString& name) const
+{
+    QProcessFrontend *frontend = processForName(name);
+    return frontend ? frontend->statistics().toMap() : QVariantMap();
+}
+
 /*!
   Raise the processAboutToStart() signal.
 */
@@ -292,6 +319,18 @@ void QDeclarativeProcessManager::processFrontendDestroyed()
     QProcessManager::processFrontendDestroyed();
 }
 
+/*!
+  Raise the processStatisticsChanged() signal.
+*/
+
+void QDeclarativeProcessManager::processFrontendStatisticsChanged()
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    if (frontend)
+        emit processStatisticsChanged(frontend->name());
+    QProcessManager::processFrontendStatisticsChanged();
+}
+
 /*!
     \fn void QDeclarativeProcessManager::processAboutToStart(const QString& name)
     This signal is emitted when a process is about to start.
@@ -357,6 +396,13 @@ void QDeclarativeProcessManager::processFrontendDestroyed()
     object because it no longer exists.
 */
 
+/*!
+    \fn void QDeclarativeProcessManager::processStatisticsChanged(const QString& name)
+    This signal is emitted when new memory and CPU statistics have
+    been sampled for a process.  The \a name may be used to retrieve
+    the figures with processStatistics().
+*/
+
 
 
 #include "moc_qdeclarativeprocessmanager.cpp"
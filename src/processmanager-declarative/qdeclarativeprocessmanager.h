@@ -67,6 +67,8 @@ public:
     void classBegin();
     void componentComplete();
 
+    Q_INVOKABLE QVariantMap processStatistics(const QString& name) const;
+
 signals:
     void processAboutToStart(const QString& name);
     void processAboutToStop(const QString& name);
@@ -75,6 +77,7 @@ signals:
     void processFinished(const QString& name, int exitCode, int exitStatus);
     void processStateChanged(const QString& name, int state);
     void processDestroyed(const QString &name);
+    void processStatisticsChanged(const QString& name);
 
 protected slots:
     virtual void processFrontendAboutToStart();
@@ -84,6 +87,7 @@ protected slots:
     virtual void processFrontendFinished(int, QProcess::ExitStatus);
     virtual void processFrontendStateChanged(QProcess::ProcessState);
     virtual void processFrontendDestroyed();
+    virtual void processFrontendStatisticsChanged();
 
 private:
     static void append_factory(QQmlListProperty<QProcessBackendFactory>*,
@@ -3,7 +3,10 @@
 
 #include <QString>
 
-#include "processmanager-global.h"
+#include <string.h>
+#include <sys/types.h>
+
+#include "qprocessmanager-global.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -21,17 +24,12 @@ public:
 };
 
 // proc/pid/stat
-class stat {
+class ProcStat {
 public:
-    stat()
-        : ppid(0)
-        , pgrp(0)
-        , session(0)
-        , it_real_value(0)
-        , start_time(0)
-        , vsize(0)
-        , rss(0) {}
-    QByteArray comm;
+    ProcStat() { memset(this, 0, sizeof(*this)); }
+
+    pid_t pid;
+    char comm[64];   // Without the parentheses; truncated to fit
     char state;
     int ppid;
     int pgrp;
@@ -49,6 +47,7 @@ public:
     long tms_cstime;
     long priority;
     long nice;
+    long num_threads;
 
     long it_real_value;
     ulong start_time;
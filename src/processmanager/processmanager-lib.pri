@@ -15,12 +15,17 @@ PUBLIC_HEADERS += \
   $$PWD/qgdbrewritedelegate.h \
   $$PWD/qidledelegate.h \
   $$PWD/qtimeoutidledelegate.h \
+  $$PWD/qlaunchpredictor.h \
   $$PWD/qcpuidledelegate.h \
   $$PWD/qioidledelegate.h \
+  $$PWD/qpsiidledelegate.h \
   $$PWD/qinfomatchdelegate.h \
   $$PWD/qkeymatchdelegate.h \
+  $$PWD/qrulematchdelegate.h \
+  $$PWD/qrulerewritedelegate.h \
   $$PWD/qprocessinfo.h \
   $$PWD/qprocessmanager.h \
+  $$PWD/qprocessgroup.h \
   $$PWD/qstandardprocessbackendfactory.h \
   $$PWD/qprelaunchprocessbackendfactory.h \
   $$PWD/qremoteprocessbackendfactory.h \
@@ -36,13 +41,22 @@ PUBLIC_HEADERS += \
   $$PWD/qpipelauncher.h \
   $$PWD/qsocketlauncher.h \
   $$PWD/qprocutils.h \
+  $$PWD/qprocesssnapshot.h \
+  $$PWD/qprocessevents.h \
+  $$PWD/qprocessstatistics.h \
+  $$PWD/qprocessjournal.h \
+  $$PWD/qcgroup.h \
   $$PWD/qremoteprotocol.h \
+  $$PWD/qremoteframereader.h \
+  $$PWD/qremotewireformat.h \
   $$PWD/qforklauncher.h \
   $$PWD/qprefork.h
 
 HEADERS += \
   $$PUBLIC_HEADERS \
-  $$PWD/qunixsandboxprocess_p.h
+  $$PWD/qunixsandboxprocess_p.h \
+  $$PWD/memorystatistics_p.h \
+  $$PWD/qprocparser_p.h
 
 SOURCES += \
   $$PWD/qpmprocess.cpp \
@@ -55,12 +69,17 @@ SOURCES += \
   $$PWD/qgdbrewritedelegate.cpp \
   $$PWD/qidledelegate.cpp \
   $$PWD/qtimeoutidledelegate.cpp \
+  $$PWD/qlaunchpredictor.cpp \
   $$PWD/qcpuidledelegate.cpp \
   $$PWD/qioidledelegate.cpp \
+  $$PWD/qpsiidledelegate.cpp \
   $$PWD/qinfomatchdelegate.cpp \
   $$PWD/qkeymatchdelegate.cpp \
+  $$PWD/qrulematchdelegate.cpp \
+  $$PWD/qrulerewritedelegate.cpp \
   $$PWD/qprocessinfo.cpp \
   $$PWD/qprocessmanager.cpp \
+  $$PWD/qprocessgroup.cpp \
   $$PWD/qunixprocessbackend.cpp \
   $$PWD/qstandardprocessbackendfactory.cpp \
   $$PWD/qstandardprocessbackend.cpp \
@@ -69,6 +88,8 @@ SOURCES += \
   $$PWD/qprelaunchprocessbackend.cpp \
   $$PWD/qremoteprocessbackend.cpp \
   $$PWD/qremoteprocessbackendfactory.cpp \
+  $$PWD/qremoteframereader.cpp \
+  $$PWD/qremotewireformat.cpp \
   $$PWD/qpipeprocessbackendfactory.cpp \
   $$PWD/qsocketprocessbackendfactory.cpp \
   $$PWD/qpreforkprocessbackendfactory.cpp \
@@ -76,5 +97,11 @@ SOURCES += \
   $$PWD/qpipelauncher.cpp \
   $$PWD/qsocketlauncher.cpp \
   $$PWD/qprocutils.cpp \
+  $$PWD/qprocparser.cpp \
+  $$PWD/qprocesssnapshot.cpp \
+  $$PWD/qprocessevents.cpp \
+  $$PWD/qprocessstatistics.cpp \
+  $$PWD/qprocessjournal.cpp \
+  $$PWD/qcgroup.cpp \
   $$PWD/qforklauncher.cpp \
   $$PWD/qprefork.cpp
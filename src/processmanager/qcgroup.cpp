@@ -0,0 +1,421 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcgroup.h"
+#include "qprocessinfo.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+static const char kMount[] = "/sys/fs/cgroup";
+static const char *const kControllers[] = { "memory", "cpu", "io", "pids" };
+const int kCpuPeriod = 100000;   // Microseconds of cpu.max period
+
+static QString s_root;
+static bool    s_prepared = false;
+static int     s_counter = 0;
+
+/*!
+  \class QCgroup
+  \brief The QCgroup class places processes in cgroup v2 subtrees with resource limits
+  \inmodule QtProcessManager
+
+  A process whose QProcessInfo sets any of the resource limits
+  (memoryMax, memoryHigh, cpuMax, cpuWeight, ioWeight or pidsMax) or
+  names a \l{QProcessInfo::cgroup}{cgroup} is moved into a cgroup below
+  root() before it executes.  Without a cgroup name every process gets
+  a cgroup of its own, which is removed again when the process has
+  exited; named cgroups are shared and left in place.
+
+  The root must be a cgroup v2 directory delegated to the user the
+  process manager runs as.  By default it is the cgroup of the
+  process manager itself, or the directory in the
+  \c{QT_PROCESSMANAGER_CGROUP_ROOT} environment variable.  The kernel
+  only lets a cgroup hand controllers to its children once it holds no
+  processes, so if the process manager sits in the root it first moves
+  itself into a \c{manager} leaf below it.
+
+  Placement is best effort.  If the cgroup can't be created or a limit
+  can't be written, a warning is printed and the process runs anyway.
+*/
+
+/*
+  Write \a value to \a file, returning false on failure
+ */
+
+static bool writeFile(const QString& file, const QByteArray& value)
+{
+    QFile f(file);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+        return false;
+    return f.write(value) == value.size();
+}
+
+static QByteArray readFile(const QString& file)
+{
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return f.readAll();
+}
+
+/*
+  Return the value of \a key in a flat-keyed file such as cpu.stat
+ */
+
+static qint64 keyedValue(const QByteArray& contents, const QByteArray& key, bool *ok)
+{
+    foreach (const QByteArray& line, contents.split('\n')) {
+        if (line.startsWith(key) && line.size() > key.size() && line.at(key.size()) == ' ')
+            return line.mid(key.size() + 1).toLongLong(ok);
+    }
+    *ok = false;
+    return 0;
+}
+
+static QByteArray limitValue(qint64 value)
+{
+    return value < 0 ? QByteArray("max") : QByteArray::number(value);
+}
+
+/*
+  Move ourselves out of the root if we live there and enable every
+  controller we know how to use in its subtree_control.
+ */
+
+static void prepareRoot()
+{
+    if (s_prepared)
+        return;
+    s_prepared = true;
+
+    QString root = QCgroup::root();
+    if (QCgroup::cgroupForPid(::getpid()) == root) {
+        QString leaf = root + QStringLiteral("/manager");
+        QDir().mkpath(leaf);
+        if (!QCgroup::attach(QFile::encodeName(leaf).constData(), 0))
+            qWarning("Unable to move the process manager into %s: %s", qPrintable(leaf), strerror(errno));
+    }
+
+    QList<QByteArray> available = readFile(root + QStringLiteral("/cgroup.controllers")).simplified().split(' ');
+    for (size_t i = 0 ; i < sizeof(kControllers) / sizeof(kControllers[0]) ; i++) {
+        QByteArray controller(kControllers[i]);
+        if (!available.contains(controller))
+            continue;
+        if (!writeFile(root + QStringLiteral("/cgroup.subtree_control"), "+" + controller))
+            qWarning("Unable to enable the %s controller in %s", kControllers[i], qPrintable(root));
+    }
+}
+
+/*!
+  Return the directory that process cgroups are created in.
+ */
+
+QString QCgroup::root()
+{
+    if (s_root.isEmpty()) {
+        QString path = QString::fromLocal8Bit(qgetenv("QT_PROCESSMANAGER_CGROUP_ROOT"));
+        if (path.isEmpty())
+            path = cgroupForPid(::getpid());
+        setRoot(path);
+    }
+    return s_root;
+}
+
+/*!
+  Set the directory that process cgroups are created in to \a path.
+  A relative path is taken from the cgroup v2 mount point.  This must
+  be called before the first process is placed.
+ */
+
+void QCgroup::setRoot(const QString& path)
+{
+    if (path.startsWith(QLatin1Char('/')))
+        s_root = QDir::cleanPath(path);
+    else
+        s_root = QDir::cleanPath(QLatin1String(kMount) + QLatin1Char('/') + path);
+    s_prepared = false;
+}
+
+/*!
+  Return true if \a info asks for the process to be placed in a cgroup.
+ */
+
+bool QCgroup::needsCgroup(const QProcessInfo& info)
+{
+    return info.contains(QProcessInfoConstants::Cgroup)
+        || info.contains(QProcessInfoConstants::MemoryMax)
+        || info.contains(QProcessInfoConstants::MemoryHigh)
+        || info.contains(QProcessInfoConstants::CpuMax)
+        || info.contains(QProcessInfoConstants::CpuWeight)
+        || info.contains(QProcessInfoConstants::IoWeight)
+        || info.contains(QProcessInfoConstants::PidsMax);
+}
+
+/*!
+  Create (or find) the cgroup for a process started with \a info and
+  write its resource limits.  \a owned is set to true if the cgroup
+  belongs to this process alone and should be removed when it exits.
+  Returns the path of the cgroup, or an empty string on failure.  A
+  named cgroup that is empty, absolute or contains a \c{..} component
+  is refused.
+
+  Call this in the parent before forking; the child then only needs
+  to attach() itself.
+ */
+
+QString QCgroup::create(const QProcessInfo& info, bool *owned)
+{
+    // The name may come from a remote manager, so it must stay below root()
+    QString cgroup = info.cgroup();
+    if (info.contains(QProcessInfoConstants::Cgroup)
+            && (cgroup.isEmpty() || cgroup.startsWith(QLatin1Char('/'))
+                || cgroup.split(QLatin1Char('/')).contains(QStringLiteral("..")))) {
+        qWarning("Refusing cgroup name '%s' outside of %s", qPrintable(cgroup), qPrintable(root()));
+        return QString();
+    }
+
+    prepareRoot();
+
+    QString path;
+    if (info.contains(QProcessInfoConstants::Cgroup)) {
+        path = QDir::cleanPath(root() + QLatin1Char('/') + cgroup);
+        *owned = false;
+    }
+    else {
+        QString name = info.identifier();
+        if (name.isEmpty())
+            name = QFileInfo(info.program()).fileName();
+        name.replace(QLatin1Char('/'), QLatin1Char('_'));
+        path = QString::fromLatin1("%1/%2-%3-%4").arg(root()).arg(name).arg(::getpid()).arg(++s_counter);
+        *owned = true;
+    }
+
+    if (!QDir().mkpath(path)) {
+        qWarning("Unable to create cgroup %s", qPrintable(path));
+        return QString();
+    }
+
+    struct { QLatin1String key; const char *file; } limits[] = {
+        { QProcessInfoConstants::MemoryMax,  "memory.max" },
+        { QProcessInfoConstants::MemoryHigh, "memory.high" },
+        { QProcessInfoConstants::CpuMax,     "cpu.max" },
+        { QProcessInfoConstants::CpuWeight,  "cpu.weight" },
+        { QProcessInfoConstants::IoWeight,   "io.weight" },
+        { QProcessInfoConstants::PidsMax,    "pids.max" }
+    };
+    for (size_t i = 0 ; i < sizeof(limits) / sizeof(limits[0]) ; i++) {
+        if (!info.contains(limits[i].key))
+            continue;
+        qint64 value = info.value(limits[i].key).toLongLong();
+        QByteArray text;
+        if (limits[i].key == QProcessInfoConstants::CpuMax)
+            text = limitValue(value < 0 ? -1 : value * kCpuPeriod / 100) + ' ' + QByteArray::number(kCpuPeriod);
+        else if (limits[i].key == QProcessInfoConstants::IoWeight)
+            text = "default " + QByteArray::number(value);
+        else
+            text = limitValue(value);
+        if (!writeFile(path + QLatin1Char('/') + QLatin1String(limits[i].file), text))
+            qWarning("Unable to set %s of %s to %s", limits[i].file, qPrintable(path), text.constData());
+    }
+    return path;
+}
+
+/*!
+  Move process \a pid into the cgroup at \a path; a \a pid of 0 moves
+  the calling process.  Only plain system calls are used, so this is
+  safe to call in a child between fork() and exec().
+  Returns false and leaves errno set on failure.
+ */
+
+bool QCgroup::attach(const char *path, pid_t pid)
+{
+    char file[PATH_MAX];
+    if (::snprintf(file, sizeof(file), "%s/cgroup.procs", path) >= (int) sizeof(file)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    int fd = ::open(file, O_WRONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+    char buf[16];
+    int len = ::snprintf(buf, sizeof(buf), "%d", (int) pid);
+    bool ok = (::write(fd, buf, len) == len);
+    int saved = errno;
+    ::close(fd);
+    errno = saved;
+    return ok;
+}
+
+/*!
+  Kill every process in the cgroup at \a path.  Kernels without
+  \c{cgroup.kill} (before Linux 5.14) get a SIGKILL sent to each
+  process listed in \c{cgroup.procs} instead.
+ */
+
+bool QCgroup::kill(const QString& path)
+{
+    if (writeFile(path + QStringLiteral("/cgroup.kill"), "1"))
+        return true;
+
+    QByteArray procs = readFile(path + QStringLiteral("/cgroup.procs"));
+    if (procs.isNull())
+        return false;
+    foreach (const QByteArray& line, procs.split('\n')) {
+        bool ok;
+        pid_t pid = line.toInt(&ok);
+        if (ok && pid > 0)
+            ::kill(pid, SIGKILL);
+    }
+    return true;
+}
+
+/*!
+  Return true if any process is left in the cgroup at \a path or below it.
+ */
+
+bool QCgroup::isPopulated(const QString& path)
+{
+    bool ok;
+    qint64 populated = keyedValue(readFile(path + QStringLiteral("/cgroup.events")), "populated", &ok);
+    return ok && populated != 0;
+}
+
+/*!
+  Remove the empty cgroup at \a path.
+ */
+
+bool QCgroup::remove(const QString& path)
+{
+    if (QDir().rmdir(path))
+        return true;
+    qWarning("Unable to remove cgroup %s", qPrintable(path));
+    return false;
+}
+
+/*!
+  Return the cgroup v2 directory of process \a pid, or an empty string
+  if it can't be read.
+ */
+
+QString QCgroup::cgroupForPid(pid_t pid)
+{
+    QByteArray contents = readFile(QString::fromLatin1("/proc/%1/cgroup").arg(pid));
+    foreach (const QByteArray& line, contents.split('\n')) {
+        if (line.startsWith("0::"))
+            return QDir::cleanPath(QLatin1String(kMount) + QString::fromLocal8Bit(line.mid(3)));
+    }
+    return QString();
+}
+
+/*!
+  Return the live resource usage of the cgroup at \a path.  The map
+  holds whichever of these values the enabled controllers provide:
+
+  \table
+  \header \li Key \li Value
+  \row \li memoryCurrent \li Memory in use, in bytes
+  \row \li memoryPeak \li Highest memory use, in bytes
+  \row \li cpuUsage \li CPU time consumed, in microseconds
+  \row \li cpuUser \li User CPU time consumed, in microseconds
+  \row \li cpuSystem \li System CPU time consumed, in microseconds
+  \row \li pidsCurrent \li Number of processes and threads
+  \row \li ioReadBytes \li Bytes read from block devices
+  \row \li ioWriteBytes \li Bytes written to block devices
+  \endtable
+ */
+
+QVariantMap QCgroup::usage(const QString& path)
+{
+    QVariantMap result;
+    bool ok;
+    qint64 value = readFile(path + QStringLiteral("/memory.current")).trimmed().toLongLong(&ok);
+    if (ok)
+        result.insert(QStringLiteral("memoryCurrent"), value);
+    value = readFile(path + QStringLiteral("/memory.peak")).trimmed().toLongLong(&ok);
+    if (ok)
+        result.insert(QStringLiteral("memoryPeak"), value);
+    QByteArray cpu = readFile(path + QStringLiteral("/cpu.stat"));
+    value = keyedValue(cpu, "usage_usec", &ok);
+    if (ok)
+        result.insert(QStringLiteral("cpuUsage"), value);
+    value = keyedValue(cpu, "user_usec", &ok);
+    if (ok)
+        result.insert(QStringLiteral("cpuUser"), value);
+    value = keyedValue(cpu, "system_usec", &ok);
+    if (ok)
+        result.insert(QStringLiteral("cpuSystem"), value);
+    value = readFile(path + QStringLiteral("/pids.current")).trimmed().toLongLong(&ok);
+    if (ok)
+        result.insert(QStringLiteral("pidsCurrent"), value);
+
+    // io.stat has one line per device: "8:0 rbytes=1 wbytes=2 ..."
+    QByteArray io = readFile(path + QStringLiteral("/io.stat"));
+    if (!io.isNull()) {
+        qint64 rbytes = 0, wbytes = 0;
+        foreach (const QByteArray& line, io.split('\n')) {
+            foreach (const QByteArray& field, line.split(' ')) {
+                if (field.startsWith("rbytes="))
+                    rbytes += field.mid(7).toLongLong();
+                else if (field.startsWith("wbytes="))
+                    wbytes += field.mid(7).toLongLong();
+            }
+        }
+        result.insert(QStringLiteral("ioReadBytes"), rbytes);
+        result.insert(QStringLiteral("ioWriteBytes"), wbytes);
+    }
+    return result;
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -42,21 +42,28 @@
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QByteArray>
+#include <QHash>
 #include <QMap>
-#include <QtEndian>
+#include <QPair>
+#include <QSet>
 #include <QFile>
 #include <QElapsedTimer>
+#include <QDateTime>
 #include <QProcess>
 
 #include <signal.h>
 #include <sys/select.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <limits.h>
 
 // Linux only?
 #include <sys/wait.h>
@@ -65,10 +72,15 @@
 #include "qforklauncher.h"
 #include "qremoteprotocol.h"
 #include "qprocessinfo.h"
+#include "qprocessjournal.h"
 #include "qprocutils.h"
+#include "qcgroup.h"
+#include "qremoteframereader.h"
+#include "qremotewireformat.h"
 
 #if defined(Q_OS_LINUX)
 #include <sys/prctl.h>
+#include <sys/epoll.h>
 #endif
 
 #if defined(Q_OS_MAC) && !defined(QT_NO_CORESERVICES)
@@ -152,11 +164,23 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   and \c{argv} variables.  Just remember, you can only access the child's
   command line arguments \e{after} you return from \c{qForkLauncher()}
 
+  On Linux the parent process waits on an edge-triggered \c{epoll}
+  set rather than \c{select()}, so the number of children is not
+  limited by \c{FD_SETSIZE} and the cost of each wakeup does not grow
+  with the number of idle children.
+
+  A child whose QProcessInfo names an \l{QProcessInfo::accountingJournal}{accounting journal}
+  has a QProcessJournal record appended when the parent reaps it.  The
+  CPU time, peak memory, context switches and block I/O come from the
+  \c{wait4()} resource usage of the child.
 */
 
 static int sig_child_pipe[2];
 static struct sigaction old_sig_child_handler;
 
+// Agreed with the manager through a "wireformat" message
+static int wire_version = QRemoteWireFormat::JsonVersion;
+
 static void sig_child_handler(int sig)
 {
     ::write(sig_child_pipe[1], "@", 1);
@@ -167,9 +191,23 @@ static void sig_child_handler(int sig)
         oldAction(sig);
 }
 
-static void readToBuffer(int fd, QByteArray& buffer)
+const int kMinReadSize = 1024;
+const int kMaxReadSize = 65536;
+
+/*
+  Read from fd into the end of buffer.  The read is sized to the amount
+  of data waiting in the pipe, so a busy child is emptied in one call
+  rather than in many small ones.  If full is set, it reports whether the
+  read filled the space we offered (meaning there may be more to read).
+ */
+
+static int readToBuffer(int fd, QByteArray& buffer, bool *full = 0)
 {
-    const int bufsize = 1024;
+    int bufsize = kMinReadSize;
+    int available;
+    if (::ioctl(fd, FIONREAD, &available) == 0)
+        bufsize = qBound(kMinReadSize, available, kMaxReadSize);
+
     uint oldSize = buffer.size();
     buffer.resize(oldSize + bufsize);
     int n = ::read(fd, buffer.data()+oldSize, bufsize);
@@ -177,23 +215,48 @@ static void readToBuffer(int fd, QByteArray& buffer)
         buffer.resize(oldSize+n);
     else
         buffer.resize(oldSize);
+    if (full)
+        *full = (n == bufsize);
+    return n;
 }
 
-static void writeFromBuffer(int fd, QByteArray& buffer)
+/*
+  Write as much of buffer to fd as it will take.  The written bytes are
+  removed in place; building a new array with mid() would allocate and
+  copy the remainder after every partial write.  Return false if the
+  write failed for a reason other than a full pipe.
+ */
+
+static bool writeFromBuffer(int fd, QByteArray& buffer)
 {
-    int n = ::write(fd, buffer.data(), buffer.size());
+    int n;
+    do {
+        n = ::write(fd, buffer.constData(), buffer.size());
+    } while (n == -1 && errno == EINTR);
     if (n == -1) {
-        qDebug() << "Failed to write to " << fd;
-        exit(-1);
+        if (errno == EAGAIN)
+            return true;
+        qWarning("Failed to write to %d: %s", fd, strerror(errno));
+        return false;
     }
-    if (n < buffer.size())
-        buffer = buffer.mid(n);
-    else
+    if (n == buffer.size())
         buffer.clear();
+    else
+        buffer.remove(0, n);
+    return true;
 }
 
 static void copyToOutgoing(QByteArray& outgoing, const QString& channel, QByteArray& buf, int id)
 {
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QRemoteWireFormat::append(outgoing, (channel == QRemoteProtocol::standardout()
+                                             ? QRemoteWireFormat::StandardOutput
+                                             : QRemoteWireFormat::StandardError),
+                                  id, 0, 0, buf.constData(), buf.size());
+        buf.clear();
+        return;
+    }
+
     QJsonObject message;
     message.insert(QRemoteProtocol::event(), QRemoteProtocol::output());
     message.insert(QRemoteProtocol::id(), id);
@@ -203,6 +266,25 @@ static void copyToOutgoing(QByteArray& outgoing, const QString& channel, QByteAr
     buf.clear();
 }
 
+/*
+  Point fd at the end of filename.  If the file can't be opened we use
+  /dev/null, because fd is still connected to the launcher's own output.
+ */
+
+static void redirectToFile(const QString& filename, int fd)
+{
+    QByteArray name = QFile::encodeName(filename);
+    int file = ::open(name.constData(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (file == -1) {
+        qWarning("Unable to open %s: %s", name.constData(), strerror(errno));
+        file = ::open("/dev/null", O_WRONLY);
+    }
+    if (file != -1 && file != fd) {
+        ::dup2(file, fd);
+        ::close(file);
+    }
+}
+
 /*
   Update the current process to match the information in info
  */
@@ -239,6 +321,12 @@ static void fixProcessState(const QProcessInfo& info, int *argc_ptr, char ***arg
             qWarning("Unable to set oom adjustment of pid=%d to %d", ::getpid(), adj);
     }
 
+    // Open redirected output as the new user
+    if (info.contains(QProcessInfoConstants::StandardOutputFile))
+        redirectToFile(info.standardOutputFile(), STDOUT_FILENO);
+    if (info.contains(QProcessInfoConstants::StandardErrorFile))
+        redirectToFile(info.standardErrorFile(), STDERR_FILENO);
+
     if (info.contains(QProcessInfoConstants::WorkingDirectory)) {
         QByteArray wd = QFile::encodeName(info.workingDirectory());
         if (!::chdir(wd.constData()))
@@ -294,6 +382,87 @@ static void fixProcessState(const QProcessInfo& info, int *argc_ptr, char ***arg
 }
 
 
+#if defined(Q_OS_LINUX)
+/*
+  Every file descriptor in the epoll set carries a key recording what
+  it is (one of our own descriptors or a pipe of a child) and, for
+  children, the child id.  Children are looked up by id when an event
+  arrives, so stale events for a child reaped earlier in the same batch
+  are simply dropped.
+ */
+
+enum EventSource {
+    ParentInput,
+    ParentOutput,
+    SignalPipe,
+    ChildInput,
+    ChildOutput,
+    ChildError,
+    ChildExit
+};
+
+static inline quint64 eventKey(EventSource source, int id = 0)
+{
+    return (quint64(quint32(id)) << 32) | quint32(source);
+}
+
+static inline EventSource eventSource(quint64 key)
+{
+    return EventSource(key & 0xffffffff);
+}
+
+static inline int eventId(quint64 key)
+{
+    return int(quint32(key >> 32));
+}
+
+static void addToEpoll(int epollfd, int fd, uint events, quint64 key)
+{
+    struct epoll_event ev;
+    ::memset(&ev, 0, sizeof(ev));
+    ev.events = events | EPOLLET;
+    ev.data.u64 = key;
+    if (::epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        qFatal("Unable to add fd %d to epoll: %s", fd, strerror(errno));
+}
+
+#endif
+
+/*
+  Read from a non-blocking descriptor until it is empty or buffer holds
+  at least limit bytes.  Edge-triggered descriptors must be drained this
+  way.  A short read means the pipe was emptied, and any later write will
+  raise a new edge.  Return true if we stopped at the limit with data
+  possibly left in the pipe.
+ */
+
+static bool drainToBuffer(int fd, QByteArray& buffer, int limit = INT_MAX)
+{
+    bool full = true;
+    while (full && buffer.size() < limit && readToBuffer(fd, buffer, &full) > 0)
+        ;
+    return full && buffer.size() >= limit;
+}
+
+const int kTimeoutInterval = 100;  // Milliseconds between SIGKILL checks
+const int kDrainInterval   = 10;   // Milliseconds between checks for remaining descendants
+const int kDrainLimit      = 5000; // How long descendants may survive SIGKILL
+
+/*
+  Flow control.  Output read from a child is held in the launcher until
+  it can be sent.  Once a child holds kChildHighWater bytes we stop reading
+  from it, so the child blocks in write(), and send a "paused" event; we
+  resume when its held output has been sent.  Held output only moves to
+  the send buffer while that is below kSendHighWater, so a slow manager
+  eventually pauses every busy child.  In the other direction, once data
+  queued for a child's stdin reaches kChildHighWater we stop reading
+  commands from the manager until it drops below kChildLowWater.
+ */
+
+const int kChildHighWater = 256 * 1024;
+const int kChildLowWater  = 64 * 1024;
+const int kSendHighWater  = 1024 * 1024;
+
 /**************************************************************************/
 
 // ### TODO:  Should we watch for 'startOutputPattern'???
@@ -303,22 +472,45 @@ public:
     ChildProcess(int id);
     ~ChildProcess();
 
+#if defined(Q_OS_LINUX)
+    void registerFds(int epollfd);
+    bool trackExit(int epollfd);
+    void handleEvent(QByteArray& outgoing, EventSource source);
+    void readOutput(QByteArray& outgoing);
+#else
     int  updateFdSet(int n, fd_set& rfds, fd_set& wfds);
     void processFdSet(QByteArray& outgoing, fd_set& rfds, fd_set& wfds);
+#endif
+    bool flushOutput(QByteArray& outgoing, bool force, bool canSend = true);
+    int  flushRemaining() const;
+    void readRemaining(QByteArray& outgoing);
     void stop(int timeout);
+    bool checkTimeout();
+    bool drain();
+    void releaseCgroup();
     void setPriority(int priority);
     void setOomAdjustment(int oomAdjustment);
-    bool doFork();
+    bool doFork(const QProcessInfo& info);
 
-    void  write(const QByteArray& buf) { m_inbuf.append(buf); }
+    void  write(const QByteArray& buf);
+    void  writeInput();
+    bool  checkInputFull();
+    int   heldBytes() const { return m_outbuf.size() + m_errbuf.size(); }
     pid_t pid() const { return m_pid; }
     int   id() const { return m_id; }
+    bool  tracksExit() const { return m_pidfd != -1; }
     bool needTimeout() const { return m_state == SentSigTerm; }
+    int   exitStatus() const { return m_exitStatus; }
+    void  setExitStatus(int status) { m_state = Finished; m_exitStatus = status; }
+    const QString& journal() const { return m_journal; }
+    void  setUsage(const struct rusage& usage);
+    QProcessJournal::Record record(int exitCode, QProcess::ExitStatus exitStatus) const;
 
     void sendStateChanged(QByteArray& outgoing, QProcess::ProcessState state);
     void sendStarted(QByteArray& outgoing);
     void sendFinished(QByteArray& outgoing, int exitCode, QProcess::ExitStatus);
     void sendError(QByteArray& outgoing, QProcess::ProcessError err, const QString& errString);
+    void sendPaused(QByteArray& outgoing, bool paused);
 
     enum ProcessState {
         NotRunning,
@@ -333,19 +525,42 @@ private:
     int   m_id;  // Unique id for this process
     QElapsedTimer m_timer;
     int m_timeout;
+    QProcessTree m_tree; // Descendants signalled by stop()
+    QString m_cgroup;    // The cgroup the child was placed in, if any
+    bool m_ownsCgroup;   // The cgroup is ours alone and is removed on exit
+    int m_exitStatus;    // Wait status held while the tree drains
     int m_stdin, m_stdout, m_stderr;
+    int m_pidfd;         // Readable when the child exits (Linux only)
     QByteArray m_inbuf;  // Data being written
     QByteArray m_outbuf; // Data being read
     QByteArray m_errbuf; // Data being read
+    int m_flushInterval; // Longest time output is held back (milliseconds)
+    int m_flushSize;     // Output is sent early once this much is held
+    QElapsedTimer m_flushTimer;  // Started when held output was first read
+    bool m_paused;       // We have stopped reading the child's output
+    bool m_inputFull;    // m_inbuf has passed the high water mark
+    QElapsedTimer m_runTimer;        // Started just before the fork
+    QString m_journal;               // Accounting journal, if any
+    QProcessJournal::Record m_record; // Filled in at fork and reap time
+
+    void setPaused(QByteArray& outgoing, bool paused);
 };
 
 ChildProcess::ChildProcess(int id)
     : m_state(NotRunning)
     , m_pid(-1)
     , m_id(id)
+    , m_timeout(0)
+    , m_ownsCgroup(false)
+    , m_exitStatus(0)
     , m_stdin(-1)
     , m_stdout(-1)
     , m_stderr(-1)
+    , m_pidfd(-1)
+    , m_flushInterval(0)
+    , m_flushSize(0)
+    , m_paused(false)
+    , m_inputFull(false)
 {
 }
 
@@ -354,14 +569,82 @@ ChildProcess::~ChildProcess()
     if (m_stdin > 0)  close(m_stdin);
     if (m_stdout > 0) close(m_stdout);
     if (m_stderr > 0) close(m_stderr);
+    if (m_pidfd > 0)  close(m_pidfd);
+}
+
+#if defined(Q_OS_LINUX)
+void ChildProcess::registerFds(int epollfd)
+{
+    addToEpoll(epollfd, m_stdin, EPOLLOUT, eventKey(ChildInput, m_id));
+    if (m_stdout != -1)
+        addToEpoll(epollfd, m_stdout, EPOLLIN, eventKey(ChildOutput, m_id));
+    if (m_stderr != -1)
+        addToEpoll(epollfd, m_stderr, EPOLLIN, eventKey(ChildError, m_id));
+}
+
+/*
+  Watch for the exit of this child through a pidfd.  Return false if
+  the kernel can't give us one.
+ */
+
+bool ChildProcess::trackExit(int epollfd)
+{
+    m_pidfd = QProcUtils::openPidFd(m_pid);
+    if (m_pidfd == -1)
+        return false;
+    addToEpoll(epollfd, m_pidfd, EPOLLIN, eventKey(ChildExit, m_id));
+    return true;
+}
+
+void ChildProcess::handleEvent(QByteArray& outgoing, EventSource source)
+{
+    switch (source) {
+    case ChildInput:
+        writeInput();
+        break;
+    case ChildOutput:
+    case ChildError:
+        if (!m_paused)   // Otherwise the data waits in the pipe
+            readOutput(outgoing);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+  Read everything the child has written, stopping once kChildHighWater
+  bytes are held.  Anything beyond that stays in the pipe until the held
+  output has been sent.
+ */
+
+void ChildProcess::readOutput(QByteArray& outgoing)
+{
+    bool wasEmpty = !heldBytes();
+    bool more = false;
+    if (m_stdout != -1)
+        more |= drainToBuffer(m_stdout, m_outbuf, kChildHighWater);
+    if (m_stderr != -1)
+        more |= drainToBuffer(m_stderr, m_errbuf, kChildHighWater);
+    if (wasEmpty && heldBytes())
+        m_flushTimer.start();
+    if (more)
+        setPaused(outgoing, true);
 }
 
+#else
+
 int ChildProcess::updateFdSet(int n, fd_set& rfds, fd_set& wfds)
 {
-    FD_SET(m_stdout, &rfds);
-    int n2 = qMax(n, m_stdout);
-    FD_SET(m_stderr, &rfds);
-    n2 = qMax(n2, m_stderr);
+    int n2 = n;
+    if (m_stdout != -1 && !m_paused) {
+        FD_SET(m_stdout, &rfds);
+        n2 = qMax(n2, m_stdout);
+    }
+    if (m_stderr != -1 && !m_paused) {
+        FD_SET(m_stderr, &rfds);
+        n2 = qMax(n2, m_stderr);
+    }
     if (m_inbuf.size()) {
         FD_SET(m_stdin, &wfds);
         n2 = qMax(n2, m_stdin);
@@ -371,23 +654,118 @@ int ChildProcess::updateFdSet(int n, fd_set& rfds, fd_set& wfds)
 
 void ChildProcess::processFdSet(QByteArray& outgoing, fd_set& rfds, fd_set& wfds)
 {
-    if (FD_ISSET(m_stdin, &wfds)) {   // Data to write
-        writeFromBuffer(m_stdin, m_inbuf);
-    }
-    if (FD_ISSET(m_stdout, &rfds)) {  // Data to read
+    bool wasEmpty = !heldBytes();
+    if (FD_ISSET(m_stdin, &wfds))   // Data to write
+        writeInput();
+    if (m_stdout != -1 && FD_ISSET(m_stdout, &rfds))  // Data to read
         readToBuffer(m_stdout, m_outbuf);
-        if (m_outbuf.size())
-            copyToOutgoing(outgoing, QRemoteProtocol::standardout(), m_outbuf, m_id);
-    }
-    if (FD_ISSET(m_stderr, &rfds)) {  // Data to read
+    if (m_stderr != -1 && FD_ISSET(m_stderr, &rfds))  // Data to read
         readToBuffer(m_stderr, m_errbuf);
-        if (m_errbuf.size())
-            copyToOutgoing(outgoing, QRemoteProtocol::standarderror(), m_errbuf, m_id);
+    if (wasEmpty && heldBytes())
+        m_flushTimer.start();
+    if (heldBytes() >= kChildHighWater)
+        setPaused(outgoing, true);
+}
+#endif
+
+void ChildProcess::write(const QByteArray& buf)
+{
+    m_inbuf.append(buf);
+#if defined(Q_OS_LINUX)
+    // Edge-triggered:  write what we can now and wait for EPOLLOUT for the rest
+    writeInput();
+#endif
+}
+
+/*
+  Write pending data to the child's stdin.  If the child has closed its
+  stdin (or died) the data is thrown away.
+ */
+
+void ChildProcess::writeInput()
+{
+    if (m_inbuf.size() && !writeFromBuffer(m_stdin, m_inbuf)) {
+        qWarning("Dropping %d bytes of input for pid=%d", m_inbuf.size(), m_pid);
+        m_inbuf.clear();
     }
-    if (m_state == SentSigTerm && m_timer.hasExpired(m_timeout)) {
-        m_state = SentSigKill;
-        QProcUtils::sendSignalToProcess(m_pid, SIGKILL);
+}
+
+/*
+  Return true if too much data is waiting to be written to the child.
+  Uses the high and low water marks so that the state doesn't flap.
+ */
+
+bool ChildProcess::checkInputFull()
+{
+    if (m_inbuf.size() >= kChildHighWater)
+        m_inputFull = true;
+    else if (m_inbuf.size() < kChildLowWater)
+        m_inputFull = false;
+    return m_inputFull;
+}
+
+void ChildProcess::setPaused(QByteArray& outgoing, bool paused)
+{
+    if (m_paused != paused) {
+        m_paused = paused;
+        sendPaused(outgoing, paused);
+    }
+}
+
+/*
+  Send buffered output as "output" events.  Unless force is set, output
+  is held back while canSend is false, or until it is older than the
+  flush interval or larger than the flush size.  Sending the output of a
+  paused child resumes it.  Return true if output is still being held.
+ */
+
+bool ChildProcess::flushOutput(QByteArray& outgoing, bool force, bool canSend)
+{
+    if (heldBytes() && !force) {
+        if (!canSend)
+            return true;
+        if (m_flushInterval > 0 && heldBytes() < kChildHighWater
+            && (m_flushSize <= 0 || heldBytes() < m_flushSize)
+            && !m_flushTimer.hasExpired(m_flushInterval))
+            return true;
     }
+
+    if (m_outbuf.size())
+        copyToOutgoing(outgoing, QRemoteProtocol::standardout(), m_outbuf, m_id);
+    if (m_errbuf.size())
+        copyToOutgoing(outgoing, QRemoteProtocol::standarderror(), m_errbuf, m_id);
+
+    if (m_paused) {
+        setPaused(outgoing, false);
+#if defined(Q_OS_LINUX)
+        readOutput(outgoing);   // No new edge will arrive for what is already in the pipe
+#endif
+        return heldBytes() > 0;
+    }
+    return false;
+}
+
+/*
+  Return the number of milliseconds until held output must be sent
+ */
+
+int ChildProcess::flushRemaining() const
+{
+    return qMax(0, int(m_flushInterval - m_flushTimer.elapsed()));
+}
+
+/*
+  Collect whatever the child wrote before it exited, so that its output
+  is always sent ahead of the "finished" event.
+ */
+
+void ChildProcess::readRemaining(QByteArray& outgoing)
+{
+    if (m_stdout != -1)
+        drainToBuffer(m_stdout, m_outbuf);
+    if (m_stderr != -1)
+        drainToBuffer(m_stderr, m_errbuf);
+    flushOutput(outgoing, true);
 }
 
 /*
@@ -397,20 +775,110 @@ void ChildProcess::processFdSet(QByteArray& outgoing, fd_set& rfds, fd_set& wfds
 void ChildProcess::stop(int timeout)
 {
     if (m_state == Running) {
-        // ### TODO:  Kill by progress group...
+        m_timeout = qMax(timeout, 0);
+        m_timer.start();
         if (timeout > 0) {
             m_state = SentSigTerm;
-            m_timeout = timeout;
-            m_timer.start();
-            QProcUtils::sendSignalToProcess(m_pid, SIGTERM);
+            m_tree.signal(m_pid, SIGTERM);
         }
         else {
             m_state = SentSigKill;
-            QProcUtils::sendSignalToProcess(m_pid, SIGKILL);
+            m_tree.signal(m_pid, SIGKILL);
+            if (m_ownsCgroup)
+                QCgroup::kill(m_cgroup);
         }
     }
 }
 
+/*
+  Escalate to SIGKILL if the SIGTERM timeout has expired.  Return true if
+  we are still waiting on the timeout.
+ */
+
+bool ChildProcess::checkTimeout()
+{
+    if (m_state == SentSigTerm && m_timer.hasExpired(m_timeout)) {
+        m_state = SentSigKill;
+        m_tree.signal(m_pid, SIGKILL);
+        if (m_ownsCgroup)
+            QCgroup::kill(m_cgroup);
+    }
+    return m_state == SentSigTerm;
+}
+
+/*
+  The child has been reaped.  Return true while descendants that
+  stop() signalled are still alive, or while the child's own cgroup
+  still holds a process.  They get what is left of the stop timeout
+  before they are killed (straight away if there was no stop), and we
+  give up on any that survive kDrainLimit past that.
+ */
+
+bool ChildProcess::drain()
+{
+    bool remaining = m_tree.remaining() > 0;
+    if (!remaining && !(m_ownsCgroup && QCgroup::isPopulated(m_cgroup)))
+        return false;
+    if (!m_timer.isValid()) {
+        m_timer.start();
+        m_timeout = 0;
+    }
+    if (!m_timer.hasExpired(m_timeout))
+        return true;
+    m_tree.signalDescendants(SIGKILL);
+    if (m_ownsCgroup)
+        QCgroup::kill(m_cgroup);
+    if (!m_timer.hasExpired(m_timeout + kDrainLimit))
+        return true;
+    qWarning("Giving up on %d descendants of pid=%d", m_tree.remaining(), m_pid);
+    m_tree.clear();
+    return false;
+}
+
+/*
+  Remove the child's cgroup if it was created for the child alone.
+  Only the launcher may do this; the destructor also runs in forked
+  children.
+ */
+
+void ChildProcess::releaseCgroup()
+{
+    if (m_ownsCgroup)
+        QCgroup::remove(m_cgroup);
+    m_ownsCgroup = false;
+}
+
+/*
+  Take the resource usage of the child from wait4() as it is reaped.
+  The wall time ends here even if the child's descendants hold back
+  the finished event.
+ */
+
+void ChildProcess::setUsage(const struct rusage& usage)
+{
+    m_record.finishedAt = QDateTime::currentMSecsSinceEpoch();
+    m_record.wallTime = m_runTimer.elapsed();
+    m_record.userTime = qint64(usage.ru_utime.tv_sec) * 1000000 + usage.ru_utime.tv_usec;
+    m_record.systemTime = qint64(usage.ru_stime.tv_sec) * 1000000 + usage.ru_stime.tv_usec;
+#if defined(Q_OS_MAC)
+    m_record.maxRss = usage.ru_maxrss;          // Already in bytes
+#else
+    m_record.maxRss = qint64(usage.ru_maxrss) * 1024;
+#endif
+    m_record.voluntarySwitches = usage.ru_nvcsw;
+    m_record.involuntarySwitches = usage.ru_nivcsw;
+    m_record.readBytes = qint64(usage.ru_inblock) * 512;
+    m_record.writtenBytes = qint64(usage.ru_oublock) * 512;
+}
+
+QProcessJournal::Record ChildProcess::record(int exitCode, QProcess::ExitStatus exitStatus) const
+{
+    QProcessJournal::Record result = m_record;
+    result.exitCode = exitCode;
+    result.exitStatus = exitStatus;
+    return result;
+}
+
 void ChildProcess::setPriority(int priority)
 {
     if (::setpriority(PRIO_PROCESS, m_pid, priority) == -1)
@@ -423,24 +891,50 @@ void ChildProcess::setOomAdjustment(int oomAdjustment)
         qWarning("Unable to set oom adjustment of pid=%d to %d", m_pid, oomAdjustment);
 }
 
+static void setNonBlocking(int fd)
+{
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+        qFatal("Unable to set nonblocking: %s", strerror(errno));
+}
+
 static void makePipe(int fd[])
 {
     if (::pipe(fd) == -1)
         qFatal("Unable to create pipe: %s", strerror(errno));
-    if (::fcntl(fd[0], F_SETFL, O_NONBLOCK) == -1)  // Set non-block on read end
-        qFatal("Unable to set nonblocking: %s", strerror(errno));
+    setNonBlocking(fd[0]);  // Set non-block on read end
 }
 
-bool ChildProcess::doFork()
+/*
+  Fork the child.  Standard output and standard error are connected to
+  pipes read by the launcher, unless the process info redirects them to
+  a file; in that case fixProcessState() opens the file in the child and
+  the launcher never sees the data.
+ */
+
+bool ChildProcess::doFork(const QProcessInfo& info)
 {
     m_state = Running;
+    m_runTimer.start();
+
+    bool pipeStdout = !info.contains(QProcessInfoConstants::StandardOutputFile);
+    bool pipeStderr = !info.contains(QProcessInfoConstants::StandardErrorFile);
 
     int fd1[2];  // Stdin of the child
-    int fd2[2];  // Stdout of the child
-    int fd3[2];  // Stderr of the child
+    int fd2[2] = { -1, -1 };  // Stdout of the child
+    int fd3[2] = { -1, -1 };  // Stderr of the child
     makePipe(fd1);
-    makePipe(fd2);
-    makePipe(fd3);
+    if (pipeStdout)
+        makePipe(fd2);
+    if (pipeStderr)
+        makePipe(fd3);
+
+    // The cgroup is set up here so the child only has to join it
+    QByteArray cgroup;
+    if (QCgroup::needsCgroup(info)) {
+        m_cgroup = QCgroup::create(info, &m_ownsCgroup);
+        cgroup = QFile::encodeName(m_cgroup);
+    }
 
     m_pid = fork();
     if (m_pid < 0)  // failed to fork
@@ -448,33 +942,53 @@ bool ChildProcess::doFork()
 
     if (m_pid == 0) {  // child
         dup2(fd1[0], STDIN_FILENO);   // Duplicate input side of pipe to stdin
-        dup2(fd2[1], STDOUT_FILENO);  // Duplicate output side of the pipe to stdout
-        dup2(fd3[1], STDERR_FILENO);  // Duplicate output side of the pipe to stderr
-        // Close all of the original pipes
         close(fd1[0]);
         close(fd1[1]);
-        close(fd2[0]);
-        close(fd2[1]);
-        close(fd3[0]);
-        close(fd3[1]);
+        if (pipeStdout) {
+            dup2(fd2[1], STDOUT_FILENO);  // Duplicate output side of the pipe to stdout
+            close(fd2[0]);
+            close(fd2[1]);
+        }
+        if (pipeStderr) {
+            dup2(fd3[1], STDERR_FILENO);  // Duplicate output side of the pipe to stderr
+            close(fd3[0]);
+            close(fd3[1]);
+        }
 #if defined(Q_OS_LINUX)
             ::prctl(PR_SET_PDEATHSIG, SIGTERM);  // Ask to be killed when parent dies
 #endif
+        if (!cgroup.isEmpty() && !QCgroup::attach(cgroup.constData(), 0))
+            qWarning("Unable to join cgroup %s: %s", cgroup.constData(), strerror(errno));
         return true;
     }
 
     // Execute parent code here....
+    m_journal = info.accountingJournal();
+    m_record.pid = m_pid;
+    m_record.name = info.contains(QProcessInfoConstants::Identifier) ? info.identifier() : info.program();
+    m_record.startupTime = m_runTimer.elapsed();
+    m_flushInterval = info.outputFlushInterval();
+    m_flushSize = info.outputFlushSize();
     m_stdin = fd1[1];
     m_stdout = fd2[0];
     m_stderr = fd3[0];
     close(fd1[0]);
-    close(fd2[1]);
-    close(fd3[1]);
+    if (pipeStdout)
+        close(fd2[1]);
+    if (pipeStderr)
+        close(fd3[1]);
+#if defined(Q_OS_LINUX)
+    setNonBlocking(m_stdin);  // Writes are edge-triggered as well
+#endif
     return false;   // Parent returns false
 }
 
 void ChildProcess::sendStateChanged(QByteArray& outgoing, QProcess::ProcessState state)
 {
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QRemoteWireFormat::append(outgoing, QRemoteWireFormat::StateChanged, m_id, state);
+        return;
+    }
     QJsonObject msg;
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::stateChanged());
     msg.insert(QRemoteProtocol::id(), m_id);
@@ -484,6 +998,10 @@ void ChildProcess::sendStateChanged(QByteArray& outgoing, QProcess::ProcessState
 
 void ChildProcess::sendStarted(QByteArray& outgoing)
 {
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QRemoteWireFormat::append(outgoing, QRemoteWireFormat::Started, m_id, m_pid);
+        return;
+    }
     QJsonObject msg;
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::started());
     msg.insert(QRemoteProtocol::id(), m_id);
@@ -493,6 +1011,10 @@ void ChildProcess::sendStarted(QByteArray& outgoing)
 
 void ChildProcess::sendFinished(QByteArray& outgoing, int exitCode, QProcess::ExitStatus exitStatus)
 {
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QRemoteWireFormat::append(outgoing, QRemoteWireFormat::Finished, m_id, exitCode, exitStatus);
+        return;
+    }
     QJsonObject msg;
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::finished());
     msg.insert(QRemoteProtocol::id(), m_id);
@@ -503,6 +1025,12 @@ void ChildProcess::sendFinished(QByteArray& outgoing, int exitCode, QProcess::Ex
 
 void ChildProcess::sendError(QByteArray& outgoing, QProcess::ProcessError err, const QString& errString)
 {
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QByteArray text = errString.toUtf8();
+        QRemoteWireFormat::append(outgoing, QRemoteWireFormat::Error, m_id, err, 0,
+                                  text.constData(), text.size());
+        return;
+    }
     QJsonObject msg;
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::error());
     msg.insert(QRemoteProtocol::id(), m_id);
@@ -511,9 +1039,24 @@ void ChildProcess::sendError(QByteArray& outgoing, QProcess::ProcessError err, c
     outgoing.append(QJsonDocument(msg).toBinaryData());
 }
 
+void ChildProcess::sendPaused(QByteArray& outgoing, bool paused)
+{
+    if (wire_version >= QRemoteWireFormat::CompactVersion) {
+        QRemoteWireFormat::append(outgoing, QRemoteWireFormat::Paused, m_id, paused);
+        return;
+    }
+    QJsonObject msg;
+    msg.insert(QRemoteProtocol::event(), QRemoteProtocol::paused());
+    msg.insert(QRemoteProtocol::id(), m_id);
+    msg.insert(QRemoteProtocol::paused(), paused);
+    outgoing.append(QJsonDocument(msg).toBinaryData());
+}
+
 
 /**************************************************************************/
 
+typedef QList< QPair<ChildProcess *, int> > ReapedList;  // Child and wait status
+
 class ParentProcess {
 public:
     ParentProcess(int *argc, char ***argv);
@@ -521,32 +1064,97 @@ public:
 
     ChildProcess *childFromPid(pid_t pid);
 
+#if defined(Q_OS_LINUX)
+    int  epollFd() const { return m_epollfd; }
+    bool processEvents(struct epoll_event *events, int count);
+#else
     int  updateFdSet(fd_set& rfds, fd_set& wfds);
     bool processFdSet(fd_set& rfds, fd_set& wfds);
+#endif
+    void installSignalPipe();
     void waitForChildren();
+    void finishChildren(const ReapedList& reaped);
+    void finishChild(ChildProcess *child, int status);
+    void writeJournal(ChildProcess *child, int exitCode, QProcess::ExitStatus exitStatus);
+    bool readInput(bool canRead);
     bool handleMessage(QJsonObject& message);
-    bool needTimeout() const;
+    void handleFrame(const QRemoteWireFormat::Frame& frame);
+    bool startChild(int id, const QVariantMap& map);
+    void stopChild(int id, int timeout);
+    void writeChild(int id, const QByteArray& data);
+    void halt();
+    void checkTimeouts();
+    void checkDraining();
+    void checkFlushes();
+    void updateInputFull(ChildProcess *child);
+    bool canSend() const { return m_sendbuf.size() < kSendHighWater; }
+    void writeOutput();
+    int  nextTimeout() const;
 
 private:
     int *m_argc_ptr;
     char ***m_argv_ptr;
-    QMap<int, ChildProcess *> m_children;
+#if defined(Q_OS_LINUX)
+    int m_epollfd;
+#endif
+    bool m_signalPipe;  // Children are reaped from a SIGCHLD handler
+    QHash<int, ChildProcess *>   m_children;    // Indexed by id
+    QHash<pid_t, ChildProcess *> m_pidIndex;    // The same children, indexed by pid
+    QSet<int> m_stopping;   // Children waiting for their SIGTERM timeout
+    QSet<int> m_draining;   // Reaped children waiting for their descendants to exit
+    QSet<int> m_holding;    // Children holding back output to coalesce it
+    QSet<int> m_inputFull;  // Children with too much unwritten input
+    QHash<QString, QProcessJournal *> m_journals;  // Open accounting journals by file name
+    bool m_inputPending;    // Commands may be waiting on stdin or in m_reader
     QByteArray m_sendbuf;
-    QByteArray m_recvbuf;
+    QRemoteFrameReader m_reader;
+    struct sigaction m_oldSigPipe;
 };
 
 
+/*
+  On Linux each child is normally tracked through its own pidfd, which
+  tells us exactly which child exited without a signal handler or a
+  waitpid(-1) sweep.  On older kernels and other platforms we fall back
+  to a SIGCHLD handler that writes into a self-pipe.  As a subreaper we
+  install that handler anyway, but its sweep only reaps orphaned
+  descendants and children without a pidfd.
+ */
+
 ParentProcess::ParentProcess(int *argc, char ***argv)
-  : m_argc_ptr(argc), m_argv_ptr(argv)
+  : m_argc_ptr(argc), m_argv_ptr(argv), m_signalPipe(false), m_inputPending(false)
 {
-    // Set up a signal handler for child events
-    makePipe(sig_child_pipe);
-
+    // A child that closes its stdin must not take the launcher down with it
     struct sigaction action;
     memset(&action, 0, sizeof(action));
-    action.sa_handler = sig_child_handler;
-    action.sa_flags = SA_NOCLDSTOP;
-    ::sigaction(SIGCHLD, &action, &old_sig_child_handler);
+    action.sa_handler = SIG_IGN;
+    ::sigaction(SIGPIPE, &action, &m_oldSigPipe);
+
+#if defined(Q_OS_LINUX)
+    m_epollfd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollfd == -1)
+        qFatal("Unable to create epoll instance: %s", strerror(errno));
+    setNonBlocking(STDIN_FILENO);
+    setNonBlocking(STDOUT_FILENO);
+    addToEpoll(m_epollfd, STDIN_FILENO, EPOLLIN, eventKey(ParentInput));
+    addToEpoll(m_epollfd, STDOUT_FILENO, EPOLLOUT, eventKey(ParentOutput));
+
+    int pidfd = QProcUtils::openPidFd(::getpid());
+    if (pidfd != -1)
+        ::close(pidfd);
+    else
+        installSignalPipe();
+
+    // Descendants orphaned by a child are reparented to us rather than to
+    // init, so a stop can wait for them.  Only SIGCHLD tells us when to
+    // reap them; our own children are still reaped through their pidfds.
+    if (::prctl(PR_SET_CHILD_SUBREAPER, 1) == 0)
+        installSignalPipe();
+    else
+        qWarning("Unable to become a subreaper: %s", strerror(errno));
+#else
+    installSignalPipe();
+#endif
 }
 
 ParentProcess::~ParentProcess()
@@ -555,15 +1163,46 @@ ParentProcess::~ParentProcess()
     // we do is close down the extra file descriptors
     foreach (ChildProcess *child, m_children)
         delete child;   // This closes the file descriptors included in the child processes
+    qDeleteAll(m_journals);
+
+#if defined(Q_OS_LINUX)
+    ::close(m_epollfd);
+#endif
+    if (m_signalPipe) {
+        ::sigaction(SIGCHLD, &old_sig_child_handler, 0);
+        ::close(sig_child_pipe[0]);
+        ::close(sig_child_pipe[1]);
+    }
+    ::sigaction(SIGPIPE, &m_oldSigPipe, 0);
+}
+
+/*
+  Set up a signal handler for child events
+ */
+
+void ParentProcess::installSignalPipe()
+{
+    if (m_signalPipe)
+        return;
+    m_signalPipe = true;
+    makePipe(sig_child_pipe);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sig_child_handler;
+    action.sa_flags = SA_NOCLDSTOP;
+    ::sigaction(SIGCHLD, &action, &old_sig_child_handler);
 
-    ::sigaction(SIGCHLD, &old_sig_child_handler, 0);
-    ::close(sig_child_pipe[0]);
-    ::close(sig_child_pipe[1]);
+#if defined(Q_OS_LINUX)
+    addToEpoll(m_epollfd, sig_child_pipe[0], EPOLLIN, eventKey(SignalPipe));
+#endif
 }
 
+#if !defined(Q_OS_LINUX)
 int ParentProcess::updateFdSet(fd_set& rfds, fd_set& wfds)
 {
-    FD_SET(0, &rfds);  // Always read from stdin
+    if (m_inputFull.isEmpty())
+        FD_SET(0, &rfds);  // Read from stdin unless a child's input is backed up
     FD_SET(sig_child_pipe[0], &rfds);  // Watch for signals
     if (m_sendbuf.size() > 0)
         FD_SET(1, &wfds);
@@ -573,45 +1212,209 @@ int ParentProcess::updateFdSet(fd_set& rfds, fd_set& wfds)
         n = child->updateFdSet(n, rfds, wfds);
     return n;
 }
+#endif
 
 ChildProcess *ParentProcess::childFromPid(pid_t pid)
 {
-    foreach (ChildProcess *child, m_children)
-        if (child->pid() == pid)
-            return child;
-    return NULL;
+    return m_pidIndex.value(pid);
 }
 
+/*
+  Reap every child that has exited.  All of the exits are collected first
+  and their events are then appended to the send buffer in one pass, so a
+  burst of exits (for example, a mass stop) goes out as a single write.
+
+  A child tracked through a pidfd is left for its ChildExit event.  The
+  kernel always offers the same exited child first, so the sweep stops
+  there and is run again once that child has been reaped.
+ */
+
 void ParentProcess::waitForChildren()
 {
+    ReapedList reaped;
     int status;
+    struct rusage usage;
     while (1) {
-        pid_t pid = ::waitpid(-1, &status, WNOHANG);
+#if defined(Q_OS_LINUX)
+        siginfo_t info;
+        info.si_pid = 0;
+        if (::waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ECHILD)
+                break;
+            qFatal("Error in waitid %s", strerror(errno));
+        }
+        if (info.si_pid == 0)
+            break;
+        ChildProcess *managed = m_pidIndex.value(info.si_pid);
+        if (managed && managed->tracksExit())
+            break;
+        pid_t pid = ::wait4(info.si_pid, &status, WNOHANG, &usage);
+#else
+        pid_t pid = ::wait4(-1, &status, WNOHANG, &usage);
+#endif
         if (pid == 0 || (pid == -1 && errno == ECHILD))
-            return;
+            break;
+        if (pid == -1 && errno == EINTR)
+            continue;
         if (pid < 0)
             qFatal("Error in wait %s", strerror(errno));
-        bool crashed = !WIFEXITED(status);
-        int exitCode = WEXITSTATUS(status);
-        ChildProcess *child = childFromPid(pid);
+        ChildProcess *child = m_pidIndex.take(pid);
         if (child) {
-            m_children.take(child->id());
-            if (crashed)
-                child->sendError(m_sendbuf, QProcess::Crashed, QStringLiteral("Process crashed"));
-            child->sendStateChanged(m_sendbuf, QProcess::NotRunning);
-            child->sendFinished(m_sendbuf, exitCode,
-                                (crashed ? QProcess::CrashExit : QProcess::NormalExit));
-            delete child;
+            child->setUsage(usage);
+            reaped << qMakePair(child, status);
         }
     }
+    finishChildren(reaped);
 }
 
+/*
+  Send the final events for each of the \a reaped children and delete
+  them.  A child whose stop left descendants behind is held back until
+  they have exited as well.
+ */
+
+void ParentProcess::finishChildren(const ReapedList& reaped)
+{
+    for (int i = 0 ; i < reaped.size() ; i++) {
+        ChildProcess *child = reaped.at(i).first;
+        int status = reaped.at(i).second;
+        if (child->drain()) {
+            child->setExitStatus(status);
+            m_stopping.remove(child->id());
+            m_draining.insert(child->id());
+        }
+        else
+            finishChild(child, status);
+    }
+}
+
+void ParentProcess::finishChild(ChildProcess *child, int status)
+{
+    bool crashed = !WIFEXITED(status);
+    int exitCode = WEXITSTATUS(status);
+    m_children.remove(child->id());
+    m_stopping.remove(child->id());
+    m_draining.remove(child->id());
+    m_holding.remove(child->id());
+    m_inputFull.remove(child->id());
+    child->readRemaining(m_sendbuf);
+    if (crashed)
+        child->sendError(m_sendbuf, QProcess::Crashed, QStringLiteral("Process crashed"));
+    child->sendStateChanged(m_sendbuf, QProcess::NotRunning);
+    child->sendFinished(m_sendbuf, exitCode,
+                        (crashed ? QProcess::CrashExit : QProcess::NormalExit));
+    writeJournal(child, exitCode, (crashed ? QProcess::CrashExit : QProcess::NormalExit));
+    child->releaseCgroup();
+    delete child;
+}
+
+/*
+  Append the accounting record of a finished \a child to its journal.
+  Journals stay open for the life of the launcher, and are closed in
+  forked children by the destructor.
+ */
+
+void ParentProcess::writeJournal(ChildProcess *child, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (child->journal().isEmpty())
+        return;
+    QProcessJournal *journal = m_journals.value(child->journal());
+    if (!journal) {
+        journal = new QProcessJournal(child->journal());
+        m_journals.insert(child->journal(), journal);
+    }
+    journal->append(child->record(exitCode, exitStatus));
+}
+
+#if defined(Q_OS_LINUX)
+// Return 'true' if we're a new child process
+bool ParentProcess::processEvents(struct epoll_event *events, int count)
+{
+    bool childDied = false;
+    bool inputReady = false;
+    QList<int> exited;
+
+    // Handle the children first because other messages may change the child list
+    for (int i = 0 ; i < count ; i++) {
+        quint64 key = events[i].data.u64;
+        switch (eventSource(key)) {
+        case ParentInput:
+            inputReady = true;
+            break;
+        case ParentOutput:   // Pending output is flushed below
+            break;
+        case SignalPipe:
+            childDied = true;
+            break;
+        case ChildExit:
+            exited << eventId(key);
+            break;
+        default: {
+            ChildProcess *child = m_children.value(eventId(key));
+            if (child) {
+                child->handleEvent(m_sendbuf, eventSource(key));
+                if (eventSource(key) == ChildInput)
+                    updateInputFull(child);
+                if (child->flushOutput(m_sendbuf, false, canSend()))
+                    m_holding.insert(child->id());
+            }
+        }
+            break;
+        }
+    }
+    checkTimeouts();
+
+    if (!exited.isEmpty()) {
+        ReapedList reaped;
+        foreach (int id, exited) {
+            ChildProcess *child = m_children.value(id);
+            int status;
+            struct rusage usage;
+            if (child && ::wait4(child->pid(), &status, WNOHANG, &usage) == child->pid()) {
+                child->setUsage(usage);
+                m_pidIndex.remove(child->pid());
+                reaped << qMakePair(child, status);
+            }
+        }
+        finishChildren(reaped);
+    }
+    if (childDied) {
+        char buf[64];
+        while (::read(sig_child_pipe[0], buf, sizeof(buf)) > 0)
+            ;
+    }
+    // A sweep may have stopped at one of the children just reaped
+    if (childDied || (m_signalPipe && !exited.isEmpty()))
+        waitForChildren();
+    // Edge-triggered:  input left unread while blocked raises no new event
+    if (inputReady)
+        m_inputPending = true;
+    if (m_inputPending && m_inputFull.isEmpty() && readInput(true))
+        return true;
+
+    writeOutput();
+    if (canSend()) {   // Release held output into the space we just made
+        checkFlushes();
+        writeOutput();
+    }
+    return false;
+}
+
+#else
+
 // Return 'true' if we're a new child process
 bool ParentProcess::processFdSet(fd_set& rfds, fd_set& wfds)
 {
     // Handle the children first because other messages may change the child list
-    foreach (ChildProcess *child, m_children)
+    foreach (ChildProcess *child, m_children) {
         child->processFdSet(m_sendbuf, rfds, wfds);
+        updateInputFull(child);
+        if (child->flushOutput(m_sendbuf, false, canSend()))
+            m_holding.insert(child->id());
+    }
+    checkTimeouts();
 
     if (FD_ISSET(sig_child_pipe[0], &rfds)) {  // A child process died
         char c;
@@ -620,43 +1423,87 @@ bool ParentProcess::processFdSet(fd_set& rfds, fd_set& wfds)
         else
             qDebug() << "############################ READ SIG PROBLEM";
     }
-    if (FD_ISSET(0, &rfds)) {  // Data available on stdin
-        readToBuffer(0, m_recvbuf);
-        // Process messages here
-        while (m_recvbuf.size() >= 12) {
-            qint32 message_size = qFromLittleEndian(((qint32 *)m_recvbuf.data())[2]) + 8;
-            if (m_recvbuf.size() < message_size)
-                break;
-            QByteArray msg = m_recvbuf.left(message_size);
-            m_recvbuf = m_recvbuf.mid(message_size);
-            QJsonObject object = QJsonDocument::fromBinaryData(msg).object();
+    bool inputReady = FD_ISSET(0, &rfds);   // Data available on stdin
+    if ((inputReady || m_inputPending) && m_inputFull.isEmpty() && readInput(inputReady))
+        return true;
+    if (FD_ISSET(1, &wfds))
+        writeOutput();
+    if (canSend())
+        checkFlushes();
+    return false;
+}
+#endif
+
+/*
+  Read and handle commands from the manager.  If a child's stdin backs
+  up we stop, leaving the rest of the commands on stdin (and so in the
+  manager's socket buffer) until the child catches up.  A blocking stdin
+  is only read when \a canRead is set.
+
+  Return 'true' if a message turned us into a new child process
+ */
+
+bool ParentProcess::readInput(bool canRead)
+{
+    m_inputPending = false;
+    bool more = canRead;
+    do {
+        if (more) {
+            bool full = false;
+            readToBuffer(0, m_reader.buffer(), &full);
+#if defined(Q_OS_LINUX)
+            more = full;   // Keep going until stdin is drained
+#else
+            more = false;  // select() tells us when there is more
+#endif
+        }
+        while (m_reader.hasFrame()) {
+            if (!m_inputFull.isEmpty()) {
+                m_inputPending = true;
+                return false;
+            }
+            QRemoteWireFormat::Frame frame;
+            if (m_reader.takeFrame(frame)) {
+                handleFrame(frame);
+                continue;
+            }
+            QJsonObject object = m_reader.takeMessage();
             if (handleMessage(object))
                 return true;
         }
-    }
-    if (m_sendbuf.size() && FD_ISSET(1, &wfds))   // Write to stdout
-        writeFromBuffer(1, m_sendbuf);
+        if (!m_reader.isValid())
+            qFatal("Invalid data on stdin");
+    } while (more && m_inputFull.isEmpty());
+    m_inputPending = more;
     return false;
 }
 
 // Return 'true' if this is a child process
 bool ParentProcess::handleMessage(QJsonObject& message)
 {
-    if (message.value(QRemoteProtocol::remote()).toString() == QRemoteProtocol::halt()) {
-        // Force all children to stop
-        foreach (ChildProcess *child, m_children)
-            child->stop(0);
-        exit(0);
+    QString remote = message.value(QRemoteProtocol::remote()).toString();
+    if (remote == QRemoteProtocol::halt())
+        halt();
+    else if (remote == QRemoteProtocol::wireformat()) {
+        // Reply in JSON; everything after the reply uses the agreed version
+        int version = message.value(QRemoteProtocol::version()).toDouble();
+        wire_version = qBound((int) QRemoteWireFormat::JsonVersion, version,
+                              (int) QRemoteWireFormat::CurrentVersion);
+        QJsonObject reply;
+        reply.insert(QRemoteProtocol::remote(), QRemoteProtocol::wireformat());
+        reply.insert(QRemoteProtocol::version(), wire_version);
+        reply.insert(QRemoteProtocol::batch(), true);   // We accept startMany and stopMany
+        m_sendbuf.append(QJsonDocument(reply).toBinaryData());
     }
     else {
         QString command = message.value(QRemoteProtocol::command()).toString();
         int id = message.value(QRemoteProtocol::id()).toDouble();
         if (command == QRemoteProtocol::stop()) {
-            ChildProcess *child = m_children.value(id);
-            if (child) {
-                int timeout = message.value(QRemoteProtocol::timeout()).toDouble();
-                child->stop(timeout);
-            }
+            stopChild(id, message.value(QRemoteProtocol::timeout()).toDouble());
+        } else if (command == QRemoteProtocol::stopMany()) {
+            int timeout = message.value(QRemoteProtocol::timeout()).toDouble();
+            foreach (const QJsonValue& value, message.value(QRemoteProtocol::ids()).toArray())
+                stopChild(value.toDouble(), timeout);
         } else if (command == QRemoteProtocol::set()) {
             ChildProcess *child = m_children.value(id);
             if (child) {
@@ -668,42 +1515,228 @@ bool ParentProcess::handleMessage(QJsonObject& message)
                     child->setOomAdjustment(value);
             }
         } else if (command == QRemoteProtocol::start()) {
-            QProcessInfo info(message.value(QRemoteProtocol::info()).toObject().toVariantMap());
-            ChildProcess *child = new ChildProcess(id);
-            if (child->doFork()) {
-                delete child;
-                fixProcessState(info, m_argc_ptr, m_argv_ptr);
-                return true;
-            }
-            else {
-                m_children.insert(id, child);
-                child->sendStateChanged(m_sendbuf, QProcess::Starting);
-                child->sendStateChanged(m_sendbuf, QProcess::Running);
-                child->sendStarted(m_sendbuf);
+            return startChild(id, message.value(QRemoteProtocol::info()).toObject().toVariantMap());
+        } else if (command == QRemoteProtocol::startMany()) {
+            // Each process's own values are laid over the shared ones
+            QVariantMap common = message.value(QRemoteProtocol::info()).toObject().toVariantMap();
+            foreach (const QJsonValue& value, message.value(QRemoteProtocol::processes()).toArray()) {
+                QJsonObject entry = value.toObject();
+                QVariantMap map = common;
+                QMapIterator<QString, QVariant> iter(entry.value(QRemoteProtocol::info()).toObject().toVariantMap());
+                while (iter.hasNext()) {
+                    iter.next();
+                    map.insert(iter.key(), iter.value());
+                }
+                if (startChild(entry.value(QRemoteProtocol::id()).toDouble(), map))
+                    return true;
             }
         } else if (command == QRemoteProtocol::write()) {
-            ChildProcess *child = m_children.value(id);
-            if (child)
-                child->write(QByteArray::fromBase64(message.value(QRemoteProtocol::data()).toString().toLatin1()));
+            writeChild(id, QByteArray::fromBase64(message.value(QRemoteProtocol::data()).toString().toLatin1()));
         }
     }
     return false;
 }
 
+/*
+  Fork a new child \a id described by \a map.  The events for all of
+  the children started by one command go out in a single write.
+  Return 'true' if this is the child process.
+ */
+
+bool ParentProcess::startChild(int id, const QVariantMap& map)
+{
+    QProcessInfo info(map);
+    ChildProcess *child = new ChildProcess(id);
+    if (child->doFork(info)) {
+        delete child;
+        fixProcessState(info, m_argc_ptr, m_argv_ptr);
+        return true;
+    }
+
+    m_children.insert(id, child);
+    m_pidIndex.insert(child->pid(), child);
+#if defined(Q_OS_LINUX)
+    child->registerFds(m_epollfd);
+#endif
+    child->sendStateChanged(m_sendbuf, QProcess::Starting);
+    child->sendStateChanged(m_sendbuf, QProcess::Running);
+    child->sendStarted(m_sendbuf);
+#if defined(Q_OS_LINUX)
+    if (!child->trackExit(m_epollfd) && !m_signalPipe) {
+        qWarning("Unable to open pidfd: %s; falling back to SIGCHLD", strerror(errno));
+        installSignalPipe();
+        waitForChildren();   // Catch anything that exited before the handler was set
+    }
+#endif
+    return false;
+}
+
+/*
+  Handle a compact command frame.  Only the commands that have a compact
+  form can arrive here; see QRemoteWireFormat::encode().
+ */
+
+void ParentProcess::handleFrame(const QRemoteWireFormat::Frame& frame)
+{
+    switch (frame.opcode) {
+    case QRemoteWireFormat::Stop:
+        stopChild(frame.id, frame.arg1);
+        break;
+    case QRemoteWireFormat::Write:
+        writeChild(frame.id, frame.payload);
+        break;
+    default:
+        qWarning("Unexpected frame opcode %d", frame.opcode);
+        break;
+    }
+}
+
+void ParentProcess::stopChild(int id, int timeout)
+{
+    ChildProcess *child = m_children.value(id);
+    if (child) {
+        child->stop(timeout);
+        if (child->needTimeout())
+            m_stopping.insert(id);
+    }
+}
+
+void ParentProcess::writeChild(int id, const QByteArray& data)
+{
+    ChildProcess *child = m_children.value(id);
+    if (child) {
+        child->write(data);
+        updateInputFull(child);
+    }
+}
+
 /*!
-  Return true if some child is in a "needs a timeout" phase
+  Force all children to stop and exit
  */
 
-bool ParentProcess::needTimeout() const
+void ParentProcess::halt()
 {
     foreach (ChildProcess *child, m_children)
-        if (child->needTimeout())
-            return true;
-    return false;
+        child->stop(0);
+    exit(0);
+}
+
+/*!
+  Send SIGKILL to any stopping child whose timeout has expired
+ */
+
+void ParentProcess::checkTimeouts()
+{
+    QMutableSetIterator<int> iter(m_stopping);
+    while (iter.hasNext()) {
+        ChildProcess *child = m_children.value(iter.next());
+        if (!child || !child->checkTimeout())
+            iter.remove();
+    }
+    checkDraining();
+}
+
+/*!
+  Send the final events of any reaped child whose descendants have all exited
+ */
+
+void ParentProcess::checkDraining()
+{
+    foreach (int id, m_draining) {
+        ChildProcess *child = m_children.value(id);
+        if (!child)
+            m_draining.remove(id);
+        else if (!child->drain())
+            finishChild(child, child->exitStatus());
+    }
+}
+
+/*!
+  Send held output of any child whose flush window has closed
+ */
+
+void ParentProcess::checkFlushes()
+{
+    QMutableSetIterator<int> iter(m_holding);
+    while (iter.hasNext()) {
+        ChildProcess *child = m_children.value(iter.next());
+        if (!child || !child->flushOutput(m_sendbuf, false, canSend()))
+            iter.remove();
+    }
+}
+
+/*!
+  Track whether \a child has too much unwritten input for us to keep
+  reading commands
+ */
+
+void ParentProcess::updateInputFull(ChildProcess *child)
+{
+    if (child->checkInputFull())
+        m_inputFull.insert(child->id());
+    else
+        m_inputFull.remove(child->id());
+}
+
+/*!
+  Write what we can to the manager.  If the manager has gone away
+  there is no one left to report to, so shut down.
+ */
+
+void ParentProcess::writeOutput()
+{
+    if (m_sendbuf.size() && !writeFromBuffer(STDOUT_FILENO, m_sendbuf))
+        halt();
+}
+
+/*!
+  Return how long we may sleep in milliseconds, or -1 if no child
+  needs a timeout
+ */
+
+int ParentProcess::nextTimeout() const
+{
+    if (m_inputPending && m_inputFull.isEmpty())
+        return 0;   // Commands were left unread; pick them up right away
+    int timeout = (m_stopping.isEmpty() ? -1 : kTimeoutInterval);
+    if (!m_draining.isEmpty())
+        timeout = kDrainInterval;
+    if (!canSend())
+        return timeout;   // Held output waits for stdout
+
+    foreach (int id, m_holding) {
+        ChildProcess *child = m_children.value(id);
+        if (child && (timeout == -1 || child->flushRemaining() < timeout))
+            timeout = child->flushRemaining();
+    }
+    return timeout;
 }
 
 /**************************************************************************/
 
+#if defined(Q_OS_LINUX)
+const int kMaxEvents = 64;
+
+void qForkLauncher(int *argc, char ***argv )
+{
+    ParentProcess parent(argc, argv);
+    struct epoll_event events[kMaxEvents];
+
+    while (1) {
+        int timeout = parent.nextTimeout();
+        int count = ::epoll_wait(parent.epollFd(), events, kMaxEvents, timeout);
+        if (count == -1 && errno == EINTR)
+            continue;
+        if (count < 0)
+            qFatal("epoll_wait: %s", strerror(errno));
+
+        if (parent.processEvents(events, count))
+            return;
+    }
+}
+
+#else
+
 void qForkLauncher(int *argc, char ***argv )
 {
     ParentProcess parent(argc, argv);
@@ -714,10 +1747,11 @@ void qForkLauncher(int *argc, char ***argv )
         FD_ZERO(&wfds);
         int n = parent.updateFdSet(rfds, wfds);
 
+        int msecs = parent.nextTimeout();
         struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 100000;
-        struct timeval *tptr = (parent.needTimeout() ? &timeout : NULL);
+        timeout.tv_sec = msecs / 1000;
+        timeout.tv_usec = (msecs % 1000) * 1000;
+        struct timeval *tptr = (msecs >= 0 ? &timeout : NULL);
 
         // Select on the inputs
         int retval = ::select(n+1, &rfds, &wfds, NULL, tptr);
@@ -730,6 +1764,7 @@ void qForkLauncher(int *argc, char ***argv )
             return;
     }
 }
+#endif
 
 void displayFileDescriptors(int argc, char **argv)
 {
@@ -88,6 +88,7 @@ void QInfoMatchDelegate::setInfo(const QProcessInfo& info)
 {
     m_info = info;
     emit infoChanged();
+    emit indexChanged();
 }
 
 /*!
@@ -123,6 +124,27 @@ bool QInfoMatchDelegate::matches(const QProcessInfo& info)
     return true;
 }
 
+/*!
+    Every entry of the info record must match exactly, so any of them
+    can serve as the index \a key and \a value.  The identifier is
+    preferred, followed by the program; the environment is never used.
+*/
+
+bool QInfoMatchDelegate::indexEntry(QString *key, QVariant *value) const
+{
+    QVariantMap map = m_info.toMap();
+    QStringList keys;
+    keys << QProcessInfoConstants::Identifier << QProcessInfoConstants::Program << map.keys();
+    foreach (const QString& k, keys) {
+        if (k != QProcessInfoConstants::Environment && map.contains(k)) {
+            *key = k;
+            *value = map.value(k);
+            return true;
+        }
+    }
+    return false;
+}
+
 /*!
   \fn void QInfoMatchDelegate::infoChanged()
   Signal emitted when the ProcessInfo object on this delegate has been changed.
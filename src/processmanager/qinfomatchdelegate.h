@@ -54,6 +54,7 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QInfoMatchDelegate : public QMatchDelegate
 public:
     explicit QInfoMatchDelegate(QObject *parent = 0);
     virtual bool matches(const QProcessInfo& info);
+    virtual bool indexEntry(QString *key, QVariant *value) const;
 
     QProcessInfo info() const;
     void        setInfo(const QProcessInfo& info);
@@ -91,6 +91,7 @@ void QKeyMatchDelegate::setKey(const QString& key)
 {
     m_key = key;
     emit keyChanged();
+    emit indexChanged();
 }
 
 /*!
@@ -110,6 +111,7 @@ void QKeyMatchDelegate::setValue(const QVariant& value)
 {
     m_value = value;
     emit valueChanged();
+    emit indexChanged();
 }
 
 /*!
@@ -122,6 +124,20 @@ bool QKeyMatchDelegate::matches(const QProcessInfo& info)
     return (info.contains(m_key) && (m_value.isNull() || info.value(m_key) == m_value));
 }
 
+/*!
+    A key match delegate with a value set can be indexed by its
+    \a key and \a value.
+*/
+
+bool QKeyMatchDelegate::indexEntry(QString *key, QVariant *value) const
+{
+    if (m_key.isEmpty() || m_value.isNull())
+        return false;
+    *key = m_key;
+    *value = m_value;
+    return true;
+}
+
 /*!
   \fn void QKeyMatchDelegate::keyChanged()
   Signal emitted when the key on this delegate has been changed.
@@ -57,6 +57,7 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QKeyMatchDelegate : public QMatchDelegate
 public:
     explicit QKeyMatchDelegate(QObject *parent = 0);
     virtual bool matches(const QProcessInfo& key);
+    virtual bool indexEntry(QString *key, QVariant *value) const;
 
     QString  key() const;
     void     setKey(const QString& key);
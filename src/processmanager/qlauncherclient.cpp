@@ -45,6 +45,8 @@
 #include "qremoteprotocol.h"
 #include "qprocessbackend.h"
 #include "qprocessbackendmanager.h"
+#include "qprocessinfo.h"
+#include "qremotewireformat.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -61,6 +63,7 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 QLauncherClient::QLauncherClient(QProcessBackendManager *manager)
     : QObject(manager)
     , m_manager(manager)
+    , m_batchEvents(false)
 {
 }
 
@@ -71,33 +74,42 @@ QLauncherClient::QLauncherClient(QProcessBackendManager *manager)
 void QLauncherClient::receive(const QJsonObject& message)
 {
     // qDebug() << Q_FUNC_INFO << message;
+    if (message.value(QRemoteProtocol::remote()).toString() == QRemoteProtocol::wireformat()) {
+        // We can't send compact frames, but we do take batches and send them
+        QJsonObject reply;
+        reply.insert(QRemoteProtocol::remote(), QRemoteProtocol::wireformat());
+        reply.insert(QRemoteProtocol::version(), QRemoteWireFormat::JsonVersion);
+        reply.insert(QRemoteProtocol::batch(), true);
+        emit send(reply);
+        m_batchEvents = true;
+        return;
+    }
+
     QString cmd = message.value(QRemoteProtocol::command()).toString();
     int id = message.value(QRemoteProtocol::id()).toDouble();
     if ( cmd == QRemoteProtocol::start() ) {
-        QProcessInfo info(message.value(QRemoteProtocol::info()).toObject().toVariantMap());
-        QProcessBackend *backend = m_manager->create(info, this);
-        if (backend) {
-            connect(backend, SIGNAL(started()), SLOT(started()));
-            connect(backend, SIGNAL(finished(int, QProcess::ExitStatus)),
-                    SLOT(finished(int, QProcess::ExitStatus)));
-            connect(backend, SIGNAL(error(QProcess::ProcessError)), SLOT(error(QProcess::ProcessError)));
-            connect(backend, SIGNAL(stateChanged(QProcess::ProcessState)),
-                    SLOT(stateChanged(QProcess::ProcessState)));
-            connect(backend, SIGNAL(standardOutput(const QByteArray&)),
-                    SLOT(standardOutput(const QByteArray&)));
-            connect(backend, SIGNAL(standardError(const QByteArray&)),
-                    SLOT(standardError(const QByteArray&)));
-            m_idToBackend.insert(id, backend);
-            m_backendToId.insert(backend, id);
-            backend->start();
+        startBackend(id, QProcessInfo(message.value(QRemoteProtocol::info()).toObject().toVariantMap()));
+    }
+    else if ( cmd == QRemoteProtocol::startMany() ) {
+        QVariantMap common = message.value(QRemoteProtocol::info()).toObject().toVariantMap();
+        foreach (const QJsonValue& value, message.value(QRemoteProtocol::processes()).toArray()) {
+            QJsonObject entry = value.toObject();
+            QVariantMap map = common;
+            QMapIterator<QString, QVariant> iter(entry.value(QRemoteProtocol::info()).toObject().toVariantMap());
+            while (iter.hasNext()) {
+                iter.next();
+                map.insert(iter.key(), iter.value());
+            }
+            startBackend(entry.value(QRemoteProtocol::id()).toDouble(), QProcessInfo(map));
         }
     }
     else if ( cmd == QRemoteProtocol::stop() ) {
-        QProcessBackend *backend = m_idToBackend.value(id);
-        if (backend) {
-            int timeout = message.value(QRemoteProtocol::timeout()).toDouble();
-            backend->stop(timeout);
-        }
+        stopBackend(id, message.value(QRemoteProtocol::timeout()).toDouble());
+    }
+    else if ( cmd == QRemoteProtocol::stopMany() ) {
+        int timeout = message.value(QRemoteProtocol::timeout()).toDouble();
+        foreach (const QJsonValue& value, message.value(QRemoteProtocol::ids()).toArray())
+            stopBackend(value.toDouble(), timeout);
     }
     else if ( cmd == QRemoteProtocol::set() ) {
         QProcessBackend *backend = m_idToBackend.value(id);
@@ -118,6 +130,77 @@ void QLauncherClient::receive(const QJsonObject& message)
     }
 }
 
+/*!
+  \internal
+ */
+
+void QLauncherClient::startBackend(int id, const QProcessInfo& info)
+{
+    QProcessBackend *backend = m_manager->create(info, this);
+    if (backend) {
+        connect(backend, SIGNAL(started()), SLOT(started()));
+        connect(backend, SIGNAL(finished(int, QProcess::ExitStatus)),
+                SLOT(finished(int, QProcess::ExitStatus)));
+        connect(backend, SIGNAL(error(QProcess::ProcessError)), SLOT(error(QProcess::ProcessError)));
+        connect(backend, SIGNAL(stateChanged(QProcess::ProcessState)),
+                SLOT(stateChanged(QProcess::ProcessState)));
+        connect(backend, SIGNAL(standardOutput(const QByteArray&)),
+                SLOT(standardOutput(const QByteArray&)));
+        connect(backend, SIGNAL(standardError(const QByteArray&)),
+                SLOT(standardError(const QByteArray&)));
+        m_idToBackend.insert(id, backend);
+        m_backendToId.insert(backend, id);
+        backend->start();
+    }
+}
+
+/*!
+  \internal
+ */
+
+void QLauncherClient::stopBackend(int id, int timeout)
+{
+    QProcessBackend *backend = m_idToBackend.value(id);
+    if (backend)
+        backend->stop(timeout);
+}
+
+/*!
+  \internal
+
+  Send an event to the controller.  Once the controller has said it
+  accepts batches, the events raised during one pass of the event loop
+  are sent together as a single "batch" event.
+ */
+
+void QLauncherClient::post(const QJsonObject& message)
+{
+    if (!m_batchEvents) {
+        emit send(message);
+        return;
+    }
+    m_pendingEvents.append(message);
+    if (m_pendingEvents.size() == 1)
+        QMetaObject::invokeMethod(this, "flushEvents", Qt::QueuedConnection);
+}
+
+/*!
+  \internal
+ */
+
+void QLauncherClient::flushEvents()
+{
+    if (m_pendingEvents.size() == 1)
+        emit send(m_pendingEvents.first().toObject());
+    else if (m_pendingEvents.size() > 1) {
+        QJsonObject batch;
+        batch.insert(QRemoteProtocol::event(), QRemoteProtocol::batch());
+        batch.insert(QRemoteProtocol::events(), m_pendingEvents);
+        emit send(batch);
+    }
+    m_pendingEvents = QJsonArray();
+}
+
 /*!
   \internal
  */
@@ -129,7 +212,7 @@ void QLauncherClient::started()
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::started());
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::pid(), (double) backend->pid());
-    emit send(msg);
+    post(msg);
 }
 
 /*!
@@ -144,7 +227,7 @@ void QLauncherClient::finished(int exitCode, QProcess::ExitStatus exitStatus)
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::exitCode(), exitCode);
     msg.insert(QRemoteProtocol::exitStatus(), exitStatus);
-    emit send(msg);
+    post(msg);
 }
 
 /*!
@@ -159,7 +242,7 @@ void QLauncherClient::error(QProcess::ProcessError err)
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::error(), err);
     msg.insert(QRemoteProtocol::errorString(), backend->errorString());
-    emit send(msg);
+    post(msg);
 }
 
 /*!
@@ -173,7 +256,7 @@ void QLauncherClient::stateChanged(QProcess::ProcessState state)
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::stateChanged());
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::stateChanged(), state);
-    emit send(msg);
+    post(msg);
 }
 
 /*!
@@ -187,7 +270,7 @@ void QLauncherClient::standardOutput(const QByteArray& data)
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::output());
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::standardout(), QString::fromLocal8Bit(data.data(), data.size()));
-    emit send(msg);
+    post(msg);
 }
 
 /*!
@@ -201,7 +284,7 @@ void QLauncherClient::standardError(const QByteArray& data)
     msg.insert(QRemoteProtocol::event(), QRemoteProtocol::output());
     msg.insert(QRemoteProtocol::id(), m_backendToId.value(backend));
     msg.insert(QRemoteProtocol::standarderror(), QString::fromLocal8Bit(data.data(), data.size()));
-    emit send(msg);
+    post(msg);
 }
 
 /*!
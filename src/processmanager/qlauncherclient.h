@@ -44,6 +44,7 @@
 
 #include <QObject>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QProcess>
 #include <QMap>
 
@@ -53,6 +54,7 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 class QProcessBackend;
 class QProcessBackendManager;
+class QProcessInfo;
 
 class QLauncherClient : public QObject {
     Q_OBJECT
@@ -70,11 +72,19 @@ private slots:
     void stateChanged(QProcess::ProcessState);
     void standardOutput(const QByteArray&);
     void standardError(const QByteArray&);
+    void flushEvents();
+
+private:
+    void startBackend(int id, const QProcessInfo& info);
+    void stopBackend(int id, int timeout);
+    void post(const QJsonObject& message);
 
 private:
     QProcessBackendManager      *m_manager;
     QMap<int, QProcessBackend *> m_idToBackend;
     QMap<QProcessBackend *, int> m_backendToId;
+    bool                         m_batchEvents;
+    QJsonArray                   m_pendingEvents;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,415 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QStringList>
+#include <qmath.h>
+
+#include "qlaunchpredictor.h"
+#include "qprocessinfo.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*
+  Each day the launch history is multiplied by this factor, so that
+  recent habits outweigh old ones.
+ */
+static const qreal kDailyDecay = 0.8;
+
+const qint64 kDefaultInstanceCost = 32 * 1024 * 1024;
+const int kDefaultUpdateInterval = 5 * 60 * 1000;
+
+/*!
+  \class QLaunchPredictor
+  \brief The QLaunchPredictor class decides which processes are worth prelaunching.
+  \inmodule QtProcessManager
+
+  The QLaunchPredictor records every process created by a
+  QProcessBackendManager, keyed by the QProcessInfo identifier and the
+  hour of the day the process was launched.  Older launches are gradually
+  forgotten, so the predictor follows changes in how the device is used.
+
+  From this history the predictor estimates how many launches of each
+  identifier to expect in the current and the next hour.  The
+  \l{prewarmPlan()} function turns these estimates into a number of
+  prelaunched instances for each identifier.  Every instance must be
+  expected to be used with at least \l{threshold} probability, and the
+  instances together must fit in the \l{memoryBudget}, assuming each one
+  costs \l{instanceCost}.  When the budget is too small, the instances
+  most likely to be used win.
+
+  Assign the predictor to a QProcessBackendManager with
+  \l{QProcessBackendManager::setLaunchPredictor()}.  The manager then
+  records its launches and passes the plan on to its factories as a
+  prelaunch demand.
+
+  The \l{history()} function returns the recorded history as a variant
+  map, which may be saved and restored with \l{setHistory()} across
+  restarts.
+*/
+
+/*!
+  \property QLaunchPredictor::memoryBudget
+  \brief Memory in bytes available for prelaunched instances.
+
+  The unit matches QPrelaunchProcessBackendFactory::memoryBudget.
+  A value of 0 (the default) does not limit the number of instances.
+ */
+
+/*!
+  \property QLaunchPredictor::instanceCost
+  \brief Estimated memory in bytes used by a single prelaunched instance.
+ */
+
+/*!
+  \property QLaunchPredictor::threshold
+  \brief The lowest expected use of an instance that is worth prelaunching.
+
+  An instance is only planned if it is expected to be used with at least
+  this probability within the hour.  The default value is 0.5.
+ */
+
+/*!
+  \property QLaunchPredictor::updateInterval
+  \brief Time in milliseconds between periodic predictionChanged() signals.
+
+  The prediction depends on the time of day, so it is refreshed
+  periodically even if nothing is launched.
+ */
+
+/*!
+    Construct a QLaunchPredictor with an optional \a parent.
+*/
+
+QLaunchPredictor::QLaunchPredictor(QObject *parent)
+    : QObject(parent)
+    , m_memoryBudget(0)
+    , m_instanceCost(kDefaultInstanceCost)
+    , m_threshold(0.5)
+{
+    connect(&m_timer, SIGNAL(timeout()), SIGNAL(predictionChanged()));
+    m_timer.setInterval(kDefaultUpdateInterval);
+    m_timer.start();
+}
+
+/*!
+  Return the memory budget in bytes
+ */
+
+qint64 QLaunchPredictor::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+/*!
+  Set the memory budget to \a budget bytes
+ */
+
+void QLaunchPredictor::setMemoryBudget(qint64 budget)
+{
+    if (m_memoryBudget != budget) {
+        m_memoryBudget = budget;
+        emit memoryBudgetChanged();
+        emit predictionChanged();
+    }
+}
+
+/*!
+  Return the estimated cost of a prelaunched instance in bytes
+ */
+
+qint64 QLaunchPredictor::instanceCost() const
+{
+    return m_instanceCost;
+}
+
+/*!
+  Set the estimated cost of a prelaunched instance to \a cost bytes
+ */
+
+void QLaunchPredictor::setInstanceCost(qint64 cost)
+{
+    if (m_instanceCost != cost) {
+        m_instanceCost = cost;
+        emit instanceCostChanged();
+        emit predictionChanged();
+    }
+}
+
+/*!
+  Return the threshold for prelaunching an instance
+ */
+
+qreal QLaunchPredictor::threshold() const
+{
+    return m_threshold;
+}
+
+/*!
+  Set the threshold for prelaunching an instance to \a threshold
+ */
+
+void QLaunchPredictor::setThreshold(qreal threshold)
+{
+    if (m_threshold != threshold) {
+        m_threshold = threshold;
+        emit thresholdChanged();
+        emit predictionChanged();
+    }
+}
+
+/*!
+  Return the update interval in milliseconds
+ */
+
+int QLaunchPredictor::updateInterval() const
+{
+    return m_timer.interval();
+}
+
+/*!
+  Set the update interval to \a interval milliseconds
+ */
+
+void QLaunchPredictor::setUpdateInterval(int interval)
+{
+    if (m_timer.interval() != interval) {
+        m_timer.setInterval(interval);
+        emit updateIntervalChanged();
+    }
+}
+
+/*!
+  Record that the process described by \a info was launched at time \a when.
+  Processes without an identifier are ignored.
+
+  Recording a launch does not emit predictionChanged(), so a burst of
+  launches does not recompute the plan for each one.  The caller decides
+  when the new history is worth a new plan.
+ */
+
+void QLaunchPredictor::recordLaunch(const QProcessInfo& info, const QDateTime& when)
+{
+    QString identifier = info.identifier();
+    if (identifier.isEmpty())
+        return;
+
+    LaunchHistory& history = m_history[identifier];
+    QDate day = when.date();
+    if (!history.day.isValid()) {
+        history.weight = 1;
+        history.day = day;
+    } else if (history.day < day) {
+        // Days without any launch count as observed days with zero launches
+        qreal factor = qPow(kDailyDecay, history.day.daysTo(day));
+        for (int i = 0 ; i < history.hours.size() ; i++)
+            history.hours[i] *= factor;
+        history.weight = history.weight * factor + (1 - factor) / (1 - kDailyDecay);
+        history.day = day;
+    }
+    history.hours[when.time().hour()] += 1;
+    history.info = info.toMap();
+}
+
+/*
+  Return the expected number of launches per day in the hour of \a when,
+  decayed up to the day of \a when.
+ */
+
+qreal QLaunchPredictor::expected(const LaunchHistory& history, const QDateTime& when)
+{
+    if (!history.day.isValid())
+        return 0;
+
+    int days = qMax(0, history.day.daysTo(when.date()));
+    qreal factor = qPow(kDailyDecay, days);
+    qreal weight = history.weight * factor + (1 - factor) / (1 - kDailyDecay);
+    return history.hours.at(when.time().hour()) * factor / weight;
+}
+
+/*!
+  Return the number of launches of \a identifier expected in the
+  hour of \a when.
+ */
+
+qreal QLaunchPredictor::expectedLaunches(const QString& identifier, const QDateTime& when) const
+{
+    QHash<QString, LaunchHistory>::const_iterator it = m_history.constFind(identifier);
+    if (it == m_history.constEnd())
+        return 0;
+    return expected(it.value(), when);
+}
+
+/*!
+  Return the number of instances worth prelaunching for each identifier
+  at time \a when.  Identifiers that are not worth prelaunching are
+  left out.
+
+  The demand for an identifier is the larger of the launches expected in
+  the current hour and in the next hour, so that instances are ready
+  before a habitual launch.  The k-th instance of an identifier is
+  expected to be used with probability min(1, demand - k + 1).
+ */
+
+QHash<QString, int> QLaunchPredictor::prewarmPlan(const QDateTime& when) const
+{
+    QList< QPair<qreal, QString> > candidates;
+    QDateTime next = when.addSecs(3600);
+
+    QHash<QString, LaunchHistory>::const_iterator it;
+    for (it = m_history.constBegin() ; it != m_history.constEnd() ; ++it) {
+        qreal demand = qMax(expected(it.value(), when), expected(it.value(), next));
+        for (int k = 0 ; demand - k > 0 && demand - k >= m_threshold ; k++)
+            candidates << qMakePair(qMin(qreal(1), demand - k), it.key());
+    }
+    qSort(candidates.begin(), candidates.end(), qGreater< QPair<qreal, QString> >());
+
+    int limit = candidates.size();
+    if (m_memoryBudget > 0 && m_instanceCost > 0)
+        limit = int(qMin<qint64>(limit, m_memoryBudget / m_instanceCost));
+
+    QHash<QString, int> plan;
+    for (int i = 0 ; i < limit ; i++)
+        plan[candidates.at(i).second]++;
+    return plan;
+}
+
+/*!
+  Return the list of identifiers with a recorded launch history.
+ */
+
+QStringList QLaunchPredictor::identifiers() const
+{
+    return m_history.keys();
+}
+
+/*!
+  Return the QProcessInfo map of the most recent launch of \a identifier.
+ */
+
+QVariantMap QLaunchPredictor::launchInfo(const QString& identifier) const
+{
+    return m_history.value(identifier).info;
+}
+
+/*!
+  Return the launch history as a variant map, suitable for storage.
+ */
+
+QVariantMap QLaunchPredictor::history() const
+{
+    QVariantMap map;
+    QHash<QString, LaunchHistory>::const_iterator it;
+    for (it = m_history.constBegin() ; it != m_history.constEnd() ; ++it) {
+        QVariantList hours;
+        foreach (qreal value, it.value().hours)
+            hours << value;
+        QVariantMap entry;
+        entry.insert(QStringLiteral("hours"), hours);
+        entry.insert(QStringLiteral("weight"), it.value().weight);
+        entry.insert(QStringLiteral("day"), it.value().day);
+        entry.insert(QStringLiteral("info"), it.value().info);
+        map.insert(it.key(), entry);
+    }
+    return map;
+}
+
+/*!
+  Replace the launch history with \a history, as previously returned
+  by history().
+ */
+
+void QLaunchPredictor::setHistory(const QVariantMap& history)
+{
+    m_history.clear();
+    QVariantMap::const_iterator it;
+    for (it = history.constBegin() ; it != history.constEnd() ; ++it) {
+        QVariantMap entry = it.value().toMap();
+        QVariantList hours = entry.value(QStringLiteral("hours")).toList();
+        if (hours.size() != 24) {
+            qWarning("Ignoring malformed launch history for '%s'", qPrintable(it.key()));
+            continue;
+        }
+        LaunchHistory& h = m_history[it.key()];
+        for (int i = 0 ; i < 24 ; i++)
+            h.hours[i] = hours.at(i).toDouble();
+        h.weight = entry.value(QStringLiteral("weight")).toDouble();
+        h.day = entry.value(QStringLiteral("day")).toDate();
+        h.info = entry.value(QStringLiteral("info")).toMap();
+    }
+    emit predictionChanged();
+}
+
+/*!
+  Forget all recorded launches.
+ */
+
+void QLaunchPredictor::clear()
+{
+    m_history.clear();
+    emit predictionChanged();
+}
+
+/*!
+  \fn void QLaunchPredictor::memoryBudgetChanged()
+  This signal is emitted when the memoryBudget is changed.
+ */
+/*!
+  \fn void QLaunchPredictor::instanceCostChanged()
+  This signal is emitted when the instanceCost is changed.
+ */
+/*!
+  \fn void QLaunchPredictor::thresholdChanged()
+  This signal is emitted when the threshold is changed.
+ */
+/*!
+  \fn void QLaunchPredictor::updateIntervalChanged()
+  This signal is emitted when the updateInterval is changed.
+ */
+/*!
+  \fn void QLaunchPredictor::predictionChanged()
+  This signal is emitted when a setting changes, when the history is
+  replaced or cleared, and periodically as time passes.  Recording a
+  launch does not emit it.
+ */
+
+#include "moc_qlaunchpredictor.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LAUNCH_PREDICTOR_H
+#define LAUNCH_PREDICTOR_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+#include "qprocessmanager-global.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class QProcessInfo;
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QLaunchPredictor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged)
+    Q_PROPERTY(qint64 instanceCost READ instanceCost WRITE setInstanceCost NOTIFY instanceCostChanged)
+    Q_PROPERTY(qreal threshold READ threshold WRITE setThreshold NOTIFY thresholdChanged)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+
+public:
+    explicit QLaunchPredictor(QObject *parent = 0);
+
+    qint64 memoryBudget() const;
+    void   setMemoryBudget(qint64 budget);
+    qint64 instanceCost() const;
+    void   setInstanceCost(qint64 cost);
+    qreal threshold() const;
+    void  setThreshold(qreal threshold);
+    int   updateInterval() const;
+    void  setUpdateInterval(int interval);
+
+    void  recordLaunch(const QProcessInfo& info, const QDateTime& when = QDateTime::currentDateTime());
+    qreal expectedLaunches(const QString& identifier, const QDateTime& when) const;
+    QHash<QString, int> prewarmPlan(const QDateTime& when = QDateTime::currentDateTime()) const;
+
+    QStringList identifiers() const;
+    QVariantMap launchInfo(const QString& identifier) const;
+
+    QVariantMap history() const;
+    void        setHistory(const QVariantMap& history);
+    Q_INVOKABLE void clear();
+
+signals:
+    void memoryBudgetChanged();
+    void instanceCostChanged();
+    void thresholdChanged();
+    void updateIntervalChanged();
+    void predictionChanged();
+
+private:
+    struct LaunchHistory {
+        LaunchHistory() : hours(24, 0), weight(0) {}
+        QVector<qreal> hours;
+        qreal          weight;
+        QDate          day;
+        QVariantMap    info;
+    };
+    static qreal expected(const LaunchHistory& history, const QDateTime& when);
+
+private:
+    Q_DISABLE_COPY(QLaunchPredictor)
+    QHash<QString, LaunchHistory> m_history;
+    QTimer m_timer;
+    qint64 m_memoryBudget;
+    qint64 m_instanceCost;
+    qreal  m_threshold;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // LAUNCH_PREDICTOR_H
@@ -49,6 +49,12 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   \inmodule QtProcessManager
 
   You must subclass this class to do anything useful.
+
+  A subclass whose matches() function requires one key of the
+  QProcessInfo record to hold one value should say so by overriding
+  indexEntry().  The QProcessBackendManager uses this to look up the
+  factory for a record directly instead of asking every factory's
+  delegate in turn.
 */
 
 /*!
@@ -67,6 +73,26 @@ QMatchDelegate::QMatchDelegate(QObject *parent)
     You must override this function.
 */
 
+/*!
+    Return true if matches() can only succeed for records where the entry
+    \a key is equal to \a value, and fill in both.  The default
+    implementation returns false, which means that the delegate must be
+    asked about every record.  Emit indexChanged() whenever the answer
+    changes.
+*/
+
+bool QMatchDelegate::indexEntry(QString *key, QVariant *value) const
+{
+    Q_UNUSED(key);
+    Q_UNUSED(value);
+    return false;
+}
+
+/*!
+    \fn void QMatchDelegate::indexChanged()
+    Signal emitted when the result of indexEntry() changes.
+*/
+
 #include "moc_qmatchdelegate.cpp"
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -43,6 +43,7 @@
 #define PROCESS_MATCHDELEGATE_H
 
 #include <QObject>
+#include <QVariant>
 
 #include "qprocessmanager-global.h"
 
@@ -56,6 +57,10 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QMatchDelegate : public QObject
 public:
     explicit QMatchDelegate(QObject *parent = 0);
     virtual bool matches(const QProcessInfo& info) = 0;
+    virtual bool indexEntry(QString *key, QVariant *value) const;
+
+signals:
+    void indexChanged();
 
 private:
     Q_DISABLE_COPY(QMatchDelegate);
@@ -43,11 +43,11 @@
 #include "qremoteprocessbackend.h"
 #include "qremoteprotocol.h"
 #include "qprocessinfo.h"
+#include "qremotewireformat.h"
 
 #include <QDebug>
 #include <QJsonDocument>
 #include <QFileInfo>
-#include <QtEndian>
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -213,23 +213,35 @@ bool QPipeProcessBackendFactory::send(const QJsonObject& message)
 {
     // qDebug() << Q_FUNC_INFO << message;
     return (m_process->state() == QProcess::Running &&
-            m_process->write(QJsonDocument(message).toBinaryData()) != -1);
+            m_process->write(QRemoteWireFormat::encode(message, wireVersion())) != -1);
+}
+
+/*!
+  Send an encoded compact \a frame to a pipe process.
+ */
+bool QPipeProcessBackendFactory::sendFrame(const QByteArray& frame)
+{
+    return (m_process->state() == QProcess::Running &&
+            m_process->write(frame) != -1);
+}
+
+/*!
+  Pipe processes may use compact frames; see QRemoteWireFormat.
+ */
+int QPipeProcessBackendFactory::maxWireVersion() const
+{
+    return QRemoteWireFormat::CurrentVersion;
 }
 
 
 void QPipeProcessBackendFactory::pipeReadyReadStandardOutput()
 {
-    m_buffer.append(m_process->readAllStandardOutput());
-    while (m_buffer.size() >= 12) {   // QJsonDocuments are at least this large
-        if (QJsonDocument::BinaryFormatTag != *((uint *) m_buffer.data()))
-            qFatal("ERROR in receive buffer: %s", m_buffer.data());
-        qint32 message_size = qFromLittleEndian(((qint32 *)m_buffer.data())[2]) + 8;
-        if (m_buffer.size() < message_size)
-            break;
-        QByteArray msg = m_buffer.left(message_size);
-        m_buffer = m_buffer.mid(message_size);
-        receive(QJsonDocument::fromBinaryData(msg).object());
-    }
+    m_reader.append(m_process->readAllStandardOutput());
+    if (!m_reader.isValid())
+        qFatal("ERROR in receive buffer");
+    receiveFrames(m_reader);
+    if (!m_reader.isValid())
+        qFatal("ERROR in receive buffer");
 }
 
 void QPipeProcessBackendFactory::pipeReadyReadStandardError()
@@ -244,6 +256,7 @@ void QPipeProcessBackendFactory::pipeReadyReadStandardError()
 
 void QPipeProcessBackendFactory::pipeStarted()
 {
+    m_reader.clear();
     handleConnected();
 }
 
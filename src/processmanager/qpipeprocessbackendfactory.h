@@ -43,6 +43,7 @@
 #define PIPE_PROCESS_BACKEND_FACTORY_H
 
 #include "qremoteprocessbackendfactory.h"
+#include "qremoteframereader.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -67,6 +68,8 @@ signals:
 protected:
     virtual QPidList localInternalProcesses() const;
     virtual bool send(const QJsonObject&);
+    virtual bool sendFrame(const QByteArray&);
+    virtual int  maxWireVersion() const;
 
 private slots:
     void pipeReadyReadStandardOutput();
@@ -82,7 +85,7 @@ private:
 private:
     QProcess    *m_process;
     QProcessInfo *m_info;
-    QByteArray   m_buffer;
+    QRemoteFrameReader m_reader;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -40,6 +40,7 @@
 ****************************************************************************/
 
 #include "qprefork.h"
+#include "qprocutils.h"
 
 #include <signal.h>
 #include <unistd.h>
@@ -48,11 +49,22 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <dlfcn.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 
 #if defined(Q_OS_LINUX)
 #include <sys/prctl.h>
 #endif
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
 #include <QtGlobal>
 #include <QDebug>
 #include <QFileInfo>
@@ -62,6 +74,8 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 static struct sigaction old_child_handler;
 
+const int kReleaseTimeout = 1000;  // How long a released child has to exit on SIGTERM
+
 static void prefork_child_handler(int sig, siginfo_t* info, void *)
 {
     if (sig == SIGCHLD)
@@ -81,6 +95,94 @@ static void makePipe(int fd[])
         qFatal("Unable to set nonblocking: %s", strerror(errno));
 }
 
+static void closeChildFds(QPreforkChildData *data)
+{
+    if (data->in != -1)
+        ::close(data->in);
+    if (data->out != -1)
+        ::close(data->out);
+    if (data->pidfd != -1)
+        ::close(data->pidfd);
+    data->in = data->out = data->pidfd = -1;
+}
+
+/*
+  The zygote replies to each request with the pid of the new child (or
+  -1) and passes the child's stdin and stdout pipes as SCM_RIGHTS.
+ */
+
+static bool sendChild(int sock, const QPreforkChildData& data)
+{
+    qint32 pid = data.pid;
+    struct iovec iov;
+    iov.iov_base = &pid;
+    iov.iov_len  = sizeof(pid);
+
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (pid > 0) {
+        int fds[2] = { data.in, data.out };
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type  = SCM_RIGHTS;
+        cmsg->cmsg_len   = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    }
+
+    ssize_t n;
+    do {
+        n = ::sendmsg(sock, &msg, 0);
+    } while (n == -1 && errno == EINTR);
+    return n == sizeof(pid);
+}
+
+static bool receiveChild(int sock, QPreforkChildData *data)
+{
+    qint32 pid = -1;
+    struct iovec iov;
+    iov.iov_base = &pid;
+    iov.iov_len  = sizeof(pid);
+
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (n == -1 && errno == EINTR);
+    if (n != sizeof(pid) || pid <= 0)
+        return false;
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS
+        || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+        return false;
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    data->pid = pid;
+    data->in  = fds[0];
+    data->out = fds[1];
+    return true;
+}
+
 /**************************************************************************/
 
 /*!
@@ -137,6 +239,35 @@ static void makePipe(int fd[])
   The QPreforkProcessBackendFactory class is a wrapper around the
   QPrefork object to make it easy to write a program that uses
   preforking to launch child processes.
+
+  When the kernel supports process file descriptors, each child is
+  opened as a pidfd (see QPreforkChildData::pidfd) and no \c{SIGCHLD}
+  handler is installed; the QPreforkProcessBackendFactory watches the
+  pidfd in its event loop and calls checkChildDied() when the child
+  exits.  Otherwise a \c{SIGCHLD} handler is installed as before.
+
+  \section1 Zygote
+
+  The set of children above is fixed when execute() is called.  If
+  setZygoteEnabled() is called first, execute() also forks a "zygote"
+  once the children have been forked and before the master loads its
+  own program.  The zygote never runs a program itself.  It holds the
+  initialized state and waits on a control socket.  On request it
+  forks a new child that runs one of the programs from the command
+  line, and it passes the child's pipes back to the master.  The new
+  child shares the same copy-on-write state as the original children.
+
+  This lets the master grow the pool with spawn(), shrink it with
+  release(), and replace a child that has died with respawn().  The
+  QPreforkProcessBackendFactory calls respawn() itself when its child
+  exits.  Children forked by the zygote are not children of the master,
+  so only pidfd-based exit tracking sees them exit; setZygoteEnabled()
+  refuses to enable the zygote on kernels without pidfds.
+
+  The children forked by the zygote are killed along with it.  The
+  QPreforkProcessBackendFactory watches the zygote's control socket and
+  calls checkZygoteDied() when it hangs up, which shuts down the whole
+  set of processes as checkChildDied() does.
  */
 
 /*!
@@ -159,7 +290,13 @@ QPrefork::QPrefork()
   , m_argv(NULL)
   , m_argv_size(0)
   , m_count(0)
+  , m_capacity(0)
   , m_children(NULL)
+  , m_programs(NULL)
+  , m_programCount(0)
+  , m_useZygote(false)
+  , m_zygote(-1)
+  , m_zygotePid(-1)
 {
 }
 
@@ -217,36 +354,195 @@ int QPrefork::makeChild(int start)
 {
     int end = nextMarker(start);
     if (start < end) {
-        int fd1[2];  // Stdin of the child
-        int fd2[2];  // Stdout of the child
-        makePipe(fd1);
-        makePipe(fd2);
-        int pid = ::fork();
-        if (pid < 0)
+        int program = m_programCount++;
+        m_programs[2*program]   = start;
+        m_programs[2*program+1] = end;
+        QPreforkChildData *data = allocateChild();
+        forkChild(program, data);
+        if (data->pid <= 0)
             qFatal("Failed to fork: %s", strerror(errno));
-        if (pid == 0) {  // Child
-            ::dup2(fd1[0], STDIN_FILENO);
-            ::dup2(fd2[1], STDOUT_FILENO);
-            ::close(fd1[0]);
-            ::close(fd1[1]);
-            ::close(fd2[0]);
-            ::close(fd2[1]);
+        data->pidfd = QProcUtils::openPidFd(data->pid);
+    }
+    return end + 1;
+}
+
+/*!
+  \internal
+
+  Fork a child running \a program and fill in its pid and pipes in
+  \a data.  The pid is set to -1 if the fork fails.
+ */
+
+void QPrefork::forkChild(int program, QPreforkChildData *data)
+{
+    int fd1[2];  // Stdin of the child
+    int fd2[2];  // Stdout of the child
+    makePipe(fd1);
+    makePipe(fd2);
+    int pid = ::fork();
+    if (pid == 0) {  // Child
+        ::dup2(fd1[0], STDIN_FILENO);
+        ::dup2(fd2[1], STDOUT_FILENO);
+        ::close(fd1[0]);
+        ::close(fd1[1]);
+        ::close(fd2[0]);
+        ::close(fd2[1]);
+        // We never exec, so O_CLOEXEC won't close what the master holds
+        // for our siblings
+        for (int i = 0 ; i < m_count ; i++)
+            if (&m_children[i] != data)
+                closeChildFds(&m_children[i]);
+        if (m_zygote != -1)
+            ::close(m_zygote);   // We were forked by the zygote
+        ::signal(SIGCHLD, SIG_DFL);
 #if defined(Q_OS_LINUX)
-            ::prctl(PR_SET_PDEATHSIG, SIGTERM);  // Ask to be killed when parent dies
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);  // Ask to be killed when parent dies
 #endif
-            launch(start, end);  // This function never returns
-        }
-        else {
-            // Parent
-            m_children[m_count].in  = fd1[1]; // Stdin of the child (write to this)
-            m_children[m_count].out = fd2[0]; // Stdout of the child (read from this)
-            m_children[m_count].pid = pid;
-            m_count++;
-            ::close(fd1[0]);
-            ::close(fd2[1]);
+        launch(m_programs[2*program], m_programs[2*program+1]);  // This function never returns
+    }
+
+    ::close(fd1[0]);
+    ::close(fd2[1]);
+    if (pid < 0) {
+        ::close(fd1[1]);
+        ::close(fd2[0]);
+        data->pid = -1;
+        data->in = data->out = -1;
+    }
+    else {
+        data->in  = fd1[1]; // Stdin of the child (write to this)
+        data->out = fd2[0]; // Stdout of the child (read from this)
+        data->pid = pid;
+    }
+    data->pidfd = -1;
+    data->program = program;
+    data->forked = 1;
+}
+
+/*!
+  \internal
+
+  Return an unused child slot, growing the table if needed.  The table
+  is read from the SIGCHLD handler, so the signal is blocked while it
+  moves.
+ */
+
+QPreforkChildData *QPrefork::allocateChild()
+{
+    for (int i = 0 ; i < m_count ; i++)
+        if (m_children[i].pid == 0)
+            return &m_children[i];
+
+    if (m_count == m_capacity) {
+        int capacity = qMax(4, m_capacity * 2);
+        sigset_t mask, oldmask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGCHLD);
+        ::sigprocmask(SIG_BLOCK, &mask, &oldmask);
+        QPreforkChildData *children = (QPreforkChildData *) ::realloc(m_children, sizeof(QPreforkChildData) * capacity);
+        if (!children)
+            qFatal("Memory error");
+        memset(children + m_capacity, 0, sizeof(QPreforkChildData) * (capacity - m_capacity));
+        m_children = children;
+        m_capacity = capacity;
+        ::sigprocmask(SIG_SETMASK, &oldmask, 0);
+    }
+    QPreforkChildData *data = &m_children[m_count++];
+    data->in = data->out = data->pidfd = -1;
+    return data;
+}
+
+/*!
+  \internal
+
+  Fork the zygote and keep one end of a control socket to it
+ */
+
+void QPrefork::startZygote()
+{
+    int sv[2];
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) == -1)
+        qFatal("Unable to create zygote socket: %s", strerror(errno));
+    int pid = ::fork();
+    if (pid < 0)
+        qFatal("Failed to fork zygote: %s", strerror(errno));
+    if (pid == 0) {
+        ::close(sv[0]);
+        m_zygote = sv[1];
+        runZygote();  // This function never returns
+    }
+    ::close(sv[1]);
+    ::fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+    m_zygote = sv[0];
+    m_zygotePid = pid;
+}
+
+/*!
+  \internal
+
+  The zygote loop.  Each request names a program; we fork a child
+  running it and send back the pid and pipes.  We exit when the master
+  closes the control socket.
+ */
+
+void QPrefork::runZygote()
+{
+    // The master's pipes aren't ours to hold open
+    for (int i = 0 ; i < m_count ; i++)
+        closeChildFds(&m_children[i]);
+    m_count = 0;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_IGN;   // Our children are reaped automatically
+    ::sigaction(SIGCHLD, &action, 0);
+#if defined(Q_OS_LINUX)
+    ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+
+    while (1) {
+        qint32 program;
+        ssize_t n = ::recv(m_zygote, &program, sizeof(program), 0);
+        if (n == 0)
+            ::_exit(0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ::_exit(1);
         }
+        QPreforkChildData data;
+        data.pid = -1;
+        data.in = data.out = data.pidfd = -1;
+        if (n == sizeof(program) && program >= 0 && program < m_programCount)
+            forkChild(program, &data);
+        sendChild(m_zygote, data);
+        closeChildFds(&data);
     }
-    return end + 1;
+}
+
+/*!
+  \internal
+
+  Ask the zygote for a new child running \a program
+ */
+
+bool QPrefork::requestChild(int program, QPreforkChildData *data)
+{
+    if (m_zygote == -1 || program < 0 || program >= m_programCount)
+        return false;
+    qint32 request = program;
+    ssize_t n;
+    do {
+        n = ::send(m_zygote, &request, sizeof(request), MSG_NOSIGNAL);
+    } while (n == -1 && errno == EINTR);
+    if (n != sizeof(request) || !receiveChild(m_zygote, data)) {
+        qWarning("Prefork zygote did not start program %d", program);
+        return false;
+    }
+    data->pidfd = QProcUtils::openPidFd(data->pid);
+    data->program = program;
+    data->forked = 0;
+    return true;
 }
 
 /*!
@@ -272,8 +568,10 @@ void QPrefork::execute(int *argc_ptr, char ***argv_ptr)
     // This is excessive paranoia - I worry about a QList access in a signal handler
     int count = marker_count - 1;
     m_children  = (QPreforkChildData *) ::calloc(sizeof(QPreforkChildData), count);
-    if (!m_children)
+    m_programs  = (int *) ::calloc(sizeof(int), 2 * count);
+    if (!m_children || !m_programs)
         qFatal("Memory error");
+    m_capacity = count;
 
     int start = nextMarker(0) + 1;
     int end   = nextMarker(start);
@@ -284,21 +582,32 @@ void QPrefork::execute(int *argc_ptr, char ***argv_ptr)
         qFatal("no defined child application");
     while ((index = makeChild(index)) < m_argc)
         ;
-
-    // Set up a signal handler - we kill everyone if something goes wrong
-    struct sigaction action;
-    memset(&action, 0, sizeof(action));
-    action.sa_sigaction = prefork_child_handler;
-    action.sa_flags = SA_NOCLDSTOP | SA_SIGINFO;
-    ::sigaction(SIGCHLD, &action, &old_child_handler);
+    if (m_useZygote)
+        startZygote();
+
+    // Set up a signal handler - we kill everyone if something goes wrong.
+    // Children with a pidfd are watched from the event loop instead.
+    bool needHandler = false;
+    for (int i = 0 ; i < m_count ; i++)
+        if (m_children[i].pidfd == -1)
+            needHandler = true;
+
+    if (needHandler) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = prefork_child_handler;
+        action.sa_flags = SA_NOCLDSTOP | SA_SIGINFO;
+        ::sigaction(SIGCHLD, &action, &old_child_handler);
+    }
 
     launch(start, end);  // This function never returns
 }
 
 /*!
   Check to see if \a pid is one of our child processes.  This function
-  is called from the \c{SIGCHILD} signal handler.  When any of our
-  children die, the entire set of processes should shut down.
+  is called from the \c{SIGCHILD} signal handler, or when the pidfd of
+  a child becomes readable.  When any of our children die, the entire
+  set of processes should shut down.
  */
 
 void QPrefork::checkChildDied(pid_t pid)
@@ -313,8 +622,31 @@ void QPrefork::checkChildDied(pid_t pid)
 }
 
 /*!
-  Return how many child processes exist.  There is one new child
-  process for each \c{fork()} call in the main process.
+  Check whether the zygote has gone.  This function is called when the
+  zygote's control socket (see zygoteFd()) becomes readable, which only
+  happens when the zygote hangs up.  The children the zygote forked die
+  with it, so the entire set of processes shuts down.
+ */
+
+void QPrefork::checkZygoteDied()
+{
+    if (m_zygote == -1)
+        return;
+    char c;
+    ssize_t n = ::recv(m_zygote, &c, sizeof(c), MSG_PEEK | MSG_DONTWAIT);
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+    ::close(m_zygote);
+    m_zygote = -1;
+    ::waitpid(m_zygotePid, 0, WNOHANG);
+    qFatal("Prefork zygote died");
+}
+
+/*!
+  Return how many child slots exist.  There is one slot for each child
+  program on the command line, plus one for each extra child made by
+  spawn().  A slot freed by release() has a pid of 0 until spawn()
+  reuses it.
  */
 
 int QPrefork::size() const
@@ -332,6 +664,126 @@ const QPreforkChildData *QPrefork::at(int i) const
     return &m_children[i];
 }
 
+/*!
+  Keep a zygote process after forking if \a enabled is true.  This must
+  be called before execute().
+ */
+
+void QPrefork::setZygoteEnabled(bool enabled)
+{
+    if (enabled) {
+        // Zygote children aren't ours, so SIGCHLD never tells us they died
+        int pidfd = QProcUtils::openPidFd(::getpid());
+        if (pidfd == -1) {
+            qWarning("The prefork zygote needs pidfd support; not enabled");
+            return;
+        }
+        ::close(pidfd);
+    }
+    m_useZygote = enabled;
+}
+
+/*!
+  Return true if a zygote will be (or has been) started
+ */
+
+bool QPrefork::zygoteEnabled() const
+{
+    return m_useZygote;
+}
+
+/*!
+  Return the master's end of the zygote control socket, or -1 if there
+  is no zygote.  It only becomes readable when the zygote hangs up.
+ */
+
+int QPrefork::zygoteFd() const
+{
+    return m_zygote;
+}
+
+/*!
+  Return the number of child programs given on the command line.  These
+  are the values that may be passed to spawn().
+ */
+
+int QPrefork::programCount() const
+{
+    return m_programCount;
+}
+
+/*!
+  Ask the zygote to fork a new child running \a program, the index of a
+  child program on the command line.  Return the index of the new child
+  slot, or -1 if there is no zygote or the fork failed.
+ */
+
+int QPrefork::spawn(int program)
+{
+    QPreforkChildData data;
+    if (!requestChild(program, &data))
+        return -1;
+    QPreforkChildData *slot = allocateChild();
+    *slot = data;
+    return slot - m_children;
+}
+
+/*!
+  Replace the child at \a index, which has died, with a new child running
+  the same program.  The slot keeps its index but gets new pipes and a
+  new pid.  Return false if there is no zygote or the fork failed.
+
+  A child forked by the master itself is reaped here; no \c{SIGCHLD}
+  handler is installed to do it when children are tracked by pidfd.
+ */
+
+bool QPrefork::respawn(int index)
+{
+    if (index < 0 || index >= m_count || m_zygote == -1)
+        return false;
+    if (m_children[index].pid > 0 && m_children[index].forked)
+        ::waitpid(m_children[index].pid, 0, WNOHANG);
+    QPreforkChildData data;
+    if (!requestChild(m_children[index].program, &data))
+        return false;
+    closeChildFds(&m_children[index]);
+    m_children[index] = data;
+    return true;
+}
+
+/*!
+  Stop the child at \a index and free its slot.  Nothing may still be
+  using the child's file descriptors.
+
+  A child with a pidfd is waited for, for up to a second before it is
+  sent \c{SIGKILL}.  A child forked by the master is then reaped; the
+  zygote reaps its own children.
+ */
+
+void QPrefork::release(int index)
+{
+    if (index < 0 || index >= m_count || m_children[index].pid <= 0)
+        return;
+    pid_t pid = m_children[index].pid;
+    m_children[index].pid = 0;   // Before the kill, so checkChildDied() ignores it
+    ::kill(pid, SIGTERM);
+
+    if (m_children[index].pidfd != -1) {
+        // The pidfd stays readable after the exit, reaped or not, and
+        // can't signal a process that reused the pid
+        struct pollfd pfd;
+        pfd.fd = m_children[index].pidfd;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, kReleaseTimeout) == 0) {
+            QProcUtils::sendSignalToPidFd(pfd.fd, SIGKILL);
+            ::poll(&pfd, 1, kReleaseTimeout);
+        }
+        if (m_children[index].forked)
+            ::waitpid(pid, 0, WNOHANG);
+    }
+    closeChildFds(&m_children[index]);
+}
+
 /*!
   \class QPreforkChildData
   \brief The QPreforkChildData class provides information about a single preforked child
@@ -353,4 +805,24 @@ const QPreforkChildData *QPrefork::at(int i) const
   \brief The child's process id
 */
 
+/*!
+  \variable QPreforkChildData::pidfd
+  \brief A process file descriptor for the child, or -1 if not supported.
+
+  The descriptor becomes readable when the child exits.
+*/
+
+/*!
+  \variable QPreforkChildData::program
+  \brief The index of the child program on the command line that this child runs.
+*/
+
+/*!
+  \variable QPreforkChildData::forked
+  \brief Non-zero if the master forked the child itself.
+
+  Only these children can be reaped by the master.  Children made by
+  the zygote are reaped by the zygote.
+*/
+
 QT_END_NAMESPACE_PROCESSMANAGER
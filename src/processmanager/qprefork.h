@@ -50,6 +50,9 @@ struct Q_ADDON_PROCESSMANAGER_EXPORT QPreforkChildData {
     int in;      // Child stdin (write to this)
     int out;     // Child stdout (read from this)
     int pid;     // Child process ID
+    int pidfd;   // Readable when the child exits, or -1 (Linux only)
+    int program; // Which program from the command line the child runs
+    int forked;  // Non-zero if the master forked the child, not the zygote
 };
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QPrefork {
@@ -57,23 +60,43 @@ public:
     static QPrefork *instance();
     void execute(int *argc_ptr, char ***argv_ptr);
     void checkChildDied(pid_t pid);
+    void checkZygoteDied();
 
     int  size() const;
     const QPreforkChildData *at(int i) const;
 
+    void setZygoteEnabled(bool enabled);
+    bool zygoteEnabled() const;
+    int  zygoteFd() const;
+    int  programCount() const;
+    int  spawn(int program);
+    bool respawn(int index);
+    void release(int index);
+
 private:
     QPrefork();
 
     int  nextMarker(int index);
     void launch(int start, int end);
     int  makeChild(int start);
+    void forkChild(int program, QPreforkChildData *data);
+    QPreforkChildData *allocateChild();
+    void startZygote();
+    void runZygote();
+    bool requestChild(int program, QPreforkChildData *data);
 
 private:
     int    m_argc;       // Original number of arguments
     char **m_argv;       // Original pointer to argument
     size_t m_argv_size;  // Length of vector allocated to original list
-    int    m_count;      // Number of child processes forked
+    int    m_count;      // Number of child slots in use
+    int    m_capacity;   // Number of child slots allocated
     QPreforkChildData *m_children;
+    int   *m_programs;   // Start and end argument indices of each child program
+    int    m_programCount;
+    bool   m_useZygote;
+    int    m_zygote;     // Control socket to the zygote, or -1
+    int    m_zygotePid;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -45,11 +45,16 @@
 
 #include <QDebug>
 #include <QJsonDocument>
+#include <QPointer>
+#include <QSocketNotifier>
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 const int kPreforkTimerInterval = 1000;
 
+// One watch on the zygote's control socket, shared by every factory
+static QPointer<QSocketNotifier> s_zygoteNotifier;
+
 /*!
   \class QPreforkProcessBackendFactory
   \brief The QPreforkProcessBackendFactory class connects to a preforked client
@@ -65,6 +70,13 @@ const int kPreforkTimerInterval = 1000;
   The QPreforkProcessBackendFactory communicates with the child process
   using the same protocol as the \l{QPipeProcessBackendFactory} (simple
   JSON-formatted messages).
+
+  If the QPrefork zygote is enabled and the child process dies, the
+  factory asks the zygote for a replacement running the same program
+  and reconnects to it.  Processes that were running in the old child
+  are reported as crashed.  Without a zygote the whole program shuts
+  down, as QPrefork::checkChildDied() describes.  So does losing the
+  zygote itself, which takes the children it forked with it.
 */
 
 /*!
@@ -80,6 +92,7 @@ const int kPreforkTimerInterval = 1000;
 QPreforkProcessBackendFactory::QPreforkProcessBackendFactory(QObject *parent)
     : QRemoteProcessBackendFactory(parent)
     , m_index(-1)
+    , m_exitNotifier(0)
 {
     m_pipe   = new QtAddOn::QtJsonStream::QJsonPipe(this);
     connect(m_pipe, SIGNAL(messageReceived(const QJsonObject&)),
@@ -126,6 +139,17 @@ void QPreforkProcessBackendFactory::setIndex(int index)
         m_index = index;
         const QPreforkChildData *data = prefork->at(index);
         m_pipe->setFds(data->out, data->in);
+        if (m_exitNotifier)
+            m_exitNotifier->deleteLater();  // We may be inside its activated() signal
+        m_exitNotifier = 0;
+        if (data->pidfd != -1) {
+            m_exitNotifier = new QSocketNotifier(data->pidfd, QSocketNotifier::Read, this);
+            connect(m_exitNotifier, SIGNAL(activated(int)), SLOT(childExited()));
+        }
+        if (prefork->zygoteFd() != -1 && !s_zygoteNotifier) {
+            s_zygoteNotifier = new QSocketNotifier(prefork->zygoteFd(), QSocketNotifier::Read, this);
+            connect(s_zygoteNotifier, SIGNAL(activated(int)), SLOT(zygoteActivated()));
+        }
         emit indexChanged();
     }
     else
@@ -158,6 +182,51 @@ bool QPreforkProcessBackendFactory::send(const QJsonObject& message)
     return m_pipe->send(message);
 }
 
+/*!
+  \internal
+  Called when the pidfd of our preforked child becomes readable
+ */
+
+void QPreforkProcessBackendFactory::childExited()
+{
+    m_exitNotifier->setEnabled(false);
+    QPrefork *prefork = QPrefork::instance();
+    if (!prefork->respawn(m_index)) {
+        prefork->checkChildDied(prefork->at(m_index)->pid);
+        return;
+    }
+
+    qWarning("Prefork child %d died; started pid %d to replace it", m_index, prefork->at(m_index)->pid);
+    // Whatever the old child was running went with it
+    foreach (int id, m_backendMap.keys()) {
+        QJsonObject msg;
+        msg.insert(QRemoteProtocol::id(), id);
+        msg.insert(QRemoteProtocol::event(), QRemoteProtocol::error());
+        msg.insert(QRemoteProtocol::error(), QProcess::Crashed);
+        msg.insert(QRemoteProtocol::errorString(), QStringLiteral("Prefork child died"));
+        receive(msg);
+        msg.insert(QRemoteProtocol::event(), QRemoteProtocol::stateChanged());
+        msg.insert(QRemoteProtocol::stateChanged(), QProcess::NotRunning);
+        receive(msg);
+        msg.insert(QRemoteProtocol::event(), QRemoteProtocol::finished());
+        msg.insert(QRemoteProtocol::exitCode(), 0);
+        msg.insert(QRemoteProtocol::exitStatus(), QProcess::CrashExit);
+        receive(msg);
+    }
+    setIndex(m_index);
+    handleConnected();
+}
+
+/*!
+  \internal
+  Called when the zygote's control socket becomes readable
+ */
+
+void QPreforkProcessBackendFactory::zygoteActivated()
+{
+    QPrefork::instance()->checkZygoteDied();
+}
+
 /*!
   \fn QPreforkProcessBackendFactory::indexChanged()
   This signal is emitted when the index is changed.
@@ -45,6 +45,8 @@
 #include "qjsonpipe.h"
 #include "qremoteprocessbackendfactory.h"
 
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QPreforkProcessBackendFactory : public QRemoteProcessBackendFactory
@@ -66,9 +68,14 @@ protected:
     virtual QPidList localInternalProcesses() const;
     virtual bool send(const QJsonObject&);
 
+private slots:
+    void childExited();
+    void zygoteActivated();
+
 private:
     int m_index;
     QtAddOn::QtJsonStream::QJsonPipe *m_pipe;
+    QSocketNotifier *m_exitNotifier;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
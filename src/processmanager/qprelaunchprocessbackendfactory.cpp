@@ -40,10 +40,12 @@
 ****************************************************************************/
 
 #include <QDebug>
+#include <QTimer>
 
 #include "qprelaunchprocessbackendfactory.h"
 #include "qprelaunchprocessbackend.h"
 #include "qprocessinfo.h"
+#include "qprocutils.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -54,6 +56,35 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
   The QPrelaunchProcessBackendFactory starts up a QPrelaunchProcessBackend using
   information passed in the constructor.
+
+  The factory keeps a pool of prelaunched processes.  The pool is never
+  allowed to grow past \l{maximumPoolSize} entries.  Whenever idle CPU is
+  available the factory prelaunches one more process, until the pool is full.
+  When a prelaunched process is consumed and the pool drops below
+  \l{minimumPoolSize}, the factory refills it right away without waiting for
+  the idle delegate.
+
+  The refill policy is burst-aware: if several processes are created in quick
+  succession, the factory assumes that more are coming and immediately refills
+  the pool up to the number of processes created in the current burst (but
+  never more than \l{maximumPoolSize}).
+
+  When the QProcessBackendManager has a QLaunchPredictor, the predicted
+  prelaunch demand replaces \l{maximumPoolSize} as the limit for idle
+  refills, clamped between \l{minimumPoolSize} and \l{maximumPoolSize}.
+  Prelaunched processes in excess of a lower demand are terminated.
+
+  Setting a \l{memoryBudget} makes the factory charge every prelaunched
+  process its proportional set size, measured periodically from \c{/proc}.
+  When the pool costs more than the budget, prelaunched processes are
+  evicted until it fits again: first those the pool could do without
+  (above \l{minimumPoolSize} and the current burst), and among those the
+  most expensive and the least likely to be consumed next.  The pool is
+  only refilled while the average measured process still fits in the
+  budget.  Memory restriction still terminates every prelaunched process.
+
+  The \l{hitCount} and \l{missCount} properties record how many processes were
+  served from the pool and how many had to be started cold.
 */
 
 /*!
@@ -70,6 +101,56 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   prelaunched process exists, that process will be terminated.
  */
 
+/*!
+  \property QPrelaunchProcessBackendFactory::minimumPoolSize
+  \brief The number of prelaunched processes refilled without waiting for idle CPU.
+
+  The default value is 0, which means that all prelaunching is driven by
+  the idle delegate.
+ */
+
+/*!
+  \property QPrelaunchProcessBackendFactory::maximumPoolSize
+  \brief The maximum number of prelaunched processes kept by the factory.
+
+  The default value is 1.
+ */
+
+/*!
+  \property QPrelaunchProcessBackendFactory::memoryBudget
+  \brief The memory in bytes that prelaunched processes may use.
+
+  A value of 0 (the default) does not limit the memory use.
+ */
+
+/*!
+  \property QPrelaunchProcessBackendFactory::prelaunchMemory
+  \brief The measured memory in bytes used by prelaunched processes.
+
+  This is only measured while a memoryBudget is set.
+ */
+
+/*!
+  \property QPrelaunchProcessBackendFactory::hitCount
+  \brief The number of processes created from a prelaunched process.
+ */
+
+/*!
+  \property QPrelaunchProcessBackendFactory::missCount
+  \brief The number of processes created without a prelaunched process available.
+ */
+
+/*
+  Two calls to create() closer together than this (in milliseconds)
+  belong to the same burst.
+ */
+static const int kBurstInterval = 2000;
+
+/*
+  Time in milliseconds between measurements of prelaunched process memory
+ */
+static const int kMemorySampleInterval = 5000;
+
 /*!
   Construct a QPrelaunchProcessBackendFactory with optional \a parent.
   To be able to use the QPrelaunchProcessBackendFactory, you also need to set
@@ -77,10 +158,20 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 */
 QPrelaunchProcessBackendFactory::QPrelaunchProcessBackendFactory(QObject *parent)
     : QProcessBackendFactory(parent)
-    , m_prelaunch(NULL)
     , m_info(NULL)
     , m_prelaunchEnabled(true)
+    , m_refillQueued(false)
+    , m_minimum(0)
+    , m_maximum(1)
+    , m_hits(0)
+    , m_misses(0)
+    , m_burstCount(0)
+    , m_memoryBudget(0)
+    , m_prelaunchMemory(0)
+    , m_averagePss(0)
 {
+    connect(&m_memoryTimer, SIGNAL(timeout()), SLOT(sampleMemory()));
+    m_memoryTimer.setInterval(kMemorySampleInterval);
 }
 
 /*!
@@ -114,21 +205,38 @@ bool QPrelaunchProcessBackendFactory::canCreate(const QProcessInfo &info) const
 QProcessBackend * QPrelaunchProcessBackendFactory::create(const QProcessInfo &info, QObject *parent)
 {
     Q_ASSERT(m_info);
-    QPrelaunchProcessBackend *prelaunch = m_prelaunch;
+    QPrelaunchProcessBackend *prelaunch = NULL;
 
-    if (hasPrelaunchedProcess()) {
+    foreach (QPrelaunchProcessBackend *backend, m_pool) {
+        if (backend->isReady()) {
+            prelaunch = takeFromPool(backend);
+            break;
+        }
+    }
+
+    if (!m_lastCreate.isValid() || m_lastCreate.elapsed() > kBurstInterval)
+        m_burstCount = 0;
+    m_burstCount++;
+    m_lastCreate.start();
+
+    if (prelaunch) {
         // qDebug() << "Using existing prelaunch";
-        m_prelaunch = NULL;
+        m_hits++;
         prelaunch->setInfo(info);
         prelaunch->setParent(parent);
         prelaunch->disconnect(this);
-        updateState();
     } else {
         // qDebug() << "Creating prelaunch from scratch";
+        m_misses++;
         prelaunch = new QPrelaunchProcessBackend(*m_info, parent);
         prelaunch->prestart();
         prelaunch->setInfo(info);
     }
+
+    if (m_pool.size() < refillTarget())
+        queueRefill();
+    updateState();
+    emit statisticsChanged();
     return prelaunch;
 }
 
@@ -153,39 +261,174 @@ void QPrelaunchProcessBackendFactory::setPrelaunchEnabled(bool value)
 {
     if (m_prelaunchEnabled != value) {
         m_prelaunchEnabled = value;
+        if (m_prelaunchEnabled)
+            queueRefill();
         updateState();
         emit prelaunchEnabledChanged();
     }
 }
 
+/*!
+    Returns the number of prelaunched processes that are refilled
+    as soon as they are consumed.
+*/
+int QPrelaunchProcessBackendFactory::minimumPoolSize() const
+{
+    return m_minimum;
+}
+
+/*!
+    Set the minimum pool \a size.  If \a size is larger than the
+    current maximumPoolSize, the maximum is raised to match.
+*/
+void QPrelaunchProcessBackendFactory::setMinimumPoolSize(int size)
+{
+    size = qMax(0, size);
+    if (m_minimum != size) {
+        m_minimum = size;
+        if (m_maximum < size)
+            setMaximumPoolSize(size);
+        queueRefill();
+        updateState();
+        emit minimumPoolSizeChanged();
+    }
+}
+
+/*!
+    Returns the maximum number of prelaunched processes.
+*/
+int QPrelaunchProcessBackendFactory::maximumPoolSize() const
+{
+    return m_maximum;
+}
+
+/*!
+    Set the maximum pool \a size.  Prelaunched processes in excess
+    of the new size are terminated.  If \a size is smaller than the
+    current minimumPoolSize, the minimum is lowered to match.
+*/
+void QPrelaunchProcessBackendFactory::setMaximumPoolSize(int size)
+{
+    size = qMax(0, size);
+    if (m_maximum != size) {
+        m_maximum = size;
+        if (m_minimum > size)
+            setMinimumPoolSize(size);
+        trimPool(size);
+        updateState();
+        emit maximumPoolSizeChanged();
+    }
+}
+
+/*!
+    Returns the memory budget in bytes.
+*/
+qint64 QPrelaunchProcessBackendFactory::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+/*!
+    Set the memory budget to \a budget bytes and evict prelaunched
+    processes that no longer fit.  A value of 0 removes the limit.
+*/
+void QPrelaunchProcessBackendFactory::setMemoryBudget(qint64 budget)
+{
+    budget = qMax(Q_INT64_C(0), budget);
+    if (m_memoryBudget != budget) {
+        m_memoryBudget = budget;
+        sampleMemory();
+        queueRefill();
+        emit memoryBudgetChanged();
+    }
+}
+
+/*!
+    Returns the measured memory use of the prelaunched processes in bytes.
+*/
+qint64 QPrelaunchProcessBackendFactory::prelaunchMemory() const
+{
+    return m_prelaunchMemory;
+}
+
 /*!
     Returns whether there is a prelaunched process which is ready to be consumed.
 */
 bool QPrelaunchProcessBackendFactory::hasPrelaunchedProcess() const
 {
-    return (m_prelaunch && m_prelaunch->isReady());
+    foreach (QPrelaunchProcessBackend *backend, m_pool)
+        if (backend->isReady())
+            return true;
+    return false;
 }
 
 /*!
-    Under memory restriction, terminate the prelaunch process.
+    Returns the number of prelaunched processes which are ready to be consumed.
 */
-void QPrelaunchProcessBackendFactory::handleMemoryRestrictionChange()
+int QPrelaunchProcessBackendFactory::prelaunchedCount() const
 {
-    if (m_memoryRestricted) {
-        if (m_prelaunch) {
-            delete m_prelaunch;   // This will kill the child process as well
-            m_prelaunch = NULL;
-        }
+    int count = 0;
+    foreach (QPrelaunchProcessBackend *backend, m_pool)
+        if (backend->isReady())
+            count++;
+    return count;
+}
+
+/*!
+    Returns the number of processes that were created from a prelaunched process.
+*/
+int QPrelaunchProcessBackendFactory::hitCount() const
+{
+    return m_hits;
+}
+
+/*!
+    Returns the number of processes that were created without a prelaunched process.
+*/
+int QPrelaunchProcessBackendFactory::missCount() const
+{
+    return m_misses;
+}
+
+/*!
+    Reset the hit and miss counters to zero.
+*/
+void QPrelaunchProcessBackendFactory::resetStatistics()
+{
+    if (m_hits || m_misses) {
+        m_hits = 0;
+        m_misses = 0;
+        emit statisticsChanged();
     }
+}
+
+/*!
+    Under memory restriction, terminate the prelaunch processes.
+*/
+void QPrelaunchProcessBackendFactory::handleMemoryRestrictionChange()
+{
+    if (m_memoryRestricted)
+        clearPool();
+    else
+        queueRefill();
     updateState();
 }
 
 /*!
-    Returns the prelaunched process backend, or null if none is created.
+    Adjust the pool to a new prelaunch demand.
+*/
+void QPrelaunchProcessBackendFactory::handlePrelaunchDemandChange()
+{
+    trimPool(qMax(poolLimit(), refillTarget()));
+    updateState();
+}
+
+/*!
+    Returns the first prelaunched process backend in the pool, or null if none is created.
  */
 QPrelaunchProcessBackend *QPrelaunchProcessBackendFactory::prelaunchProcessBackend() const
 {
-    return m_prelaunch;
+    return m_pool.isEmpty() ? NULL : m_pool.first();
 }
 
 /*!
@@ -195,47 +438,35 @@ QPrelaunchProcessBackend *QPrelaunchProcessBackendFactory::prelaunchProcessBacke
 void QPrelaunchProcessBackendFactory::idleCpuAvailable()
 {
     // qDebug() << Q_FUNC_INFO;
-    if (m_prelaunchEnabled && !m_prelaunch && !m_memoryRestricted && m_info) {
-        // qDebug() << Q_FUNC_INFO << "...launching";
-        m_prelaunch = new QPrelaunchProcessBackend(*m_info, this);
-        connect(m_prelaunch, SIGNAL(finished(int,QProcess::ExitStatus)),
-                SLOT(prelaunchFinished(int,QProcess::ExitStatus)));
-        connect(m_prelaunch, SIGNAL(error(QProcess::ProcessError)),
-                SLOT(prelaunchError(QProcess::ProcessError)));
-        connect(m_prelaunch, SIGNAL(stateChanged(QProcess::ProcessState)),
-                SLOT(updateState()));
-        m_prelaunch->prestart();
-        emit processPrelaunched();
-    }
+    if (canPrelaunch() && m_pool.size() < poolLimit() && fitsMemoryBudget())
+        prelaunch();
     updateState();
 }
 
 /*!
-  Handle a surprise termination condition - the prelaunched process died
+  Handle a surprise termination condition - a prelaunched process died
   unexpectedly.
  */
 
 void QPrelaunchProcessBackendFactory::prelaunchFinished(int exitCode, QProcess::ExitStatus status)
 {
     qWarning() << Q_FUNC_INFO << "died unexpectedly" << exitCode << status;
-    if (m_prelaunch) {
-        m_prelaunch->deleteLater();
-        m_prelaunch = NULL;
-    }
+    QPrelaunchProcessBackend *backend = takeFromPool(sender());
+    if (backend)
+        backend->deleteLater();
     updateState();
 }
 
 /*!
-  Handle surprise error conditions on the prelaunched process.
+  Handle surprise error conditions on a prelaunched process.
  */
 
 void QPrelaunchProcessBackendFactory::prelaunchError(QProcess::ProcessError err)
 {
     qWarning() << Q_FUNC_INFO << "unexpected error" << err;
-    if (m_prelaunch) {
-        m_prelaunch->deleteLater();
-        m_prelaunch = NULL;
-    }
+    QPrelaunchProcessBackend *backend = takeFromPool(sender());
+    if (backend)
+        backend->deleteLater();
 
     if (err == QProcess::FailedToStart) {
         qWarning() << Q_FUNC_INFO << "disabling prelaunch because of process errors";
@@ -252,16 +483,240 @@ void QPrelaunchProcessBackendFactory::prelaunchError(QProcess::ProcessError err)
 */
 void QPrelaunchProcessBackendFactory::updateState()
 {
-    Q_ASSERT(!m_prelaunch || !m_memoryRestricted);  // If memory is restricted, we must not have a prelaunch process
+    Q_ASSERT(m_pool.isEmpty() || !m_memoryRestricted);  // If memory is restricted, we must not have prelaunch processes
 
-    setIdleCpuRequest(!m_memoryRestricted && m_prelaunchEnabled && !m_prelaunch && m_info);
+    setIdleCpuRequest(canPrelaunch() && m_pool.size() < poolLimit() && fitsMemoryBudget());
+
+    if (m_memoryBudget > 0 && !m_pool.isEmpty()) {
+        if (!m_memoryTimer.isActive())
+            m_memoryTimer.start();
+    } else {
+        m_memoryTimer.stop();
+    }
 
     QPidList list;
-    if (m_prelaunch && m_prelaunch->isReady())
-        list << m_prelaunch->pid();
+    foreach (QPrelaunchProcessBackend *backend, m_pool)
+        if (backend->isReady())
+            list << backend->pid();
     setInternalProcesses(list);
 }
 
+/*
+  Bring the pool up to the refill target without waiting for idle CPU.
+ */
+
+void QPrelaunchProcessBackendFactory::refill()
+{
+    m_refillQueued = false;
+    int target = refillTarget();
+    while (m_pool.size() < target && fitsMemoryBudget())
+        prelaunch();
+    updateState();
+}
+
+/*
+  Measure the proportional set size of each ready prelaunched process
+  and evict processes until the pool fits in the memory budget.
+ */
+
+void QPrelaunchProcessBackendFactory::sampleMemory()
+{
+    m_pss.clear();
+    qint64 total = 0;
+    if (m_memoryBudget > 0) {
+        foreach (QPrelaunchProcessBackend *backend, m_pool) {
+            if (backend->isReady()) {
+                qint64 pss = QProcUtils::pssForPid(backend->pid());
+                if (pss >= 0) {
+                    m_pss.insert(backend, pss);
+                    total += pss;
+                }
+            }
+        }
+        if (!m_pss.isEmpty())
+            m_averagePss = total / m_pss.size();
+        if (total > m_memoryBudget)
+            evict(total);
+        total = 0;
+        foreach (qint64 pss, m_pss)
+            total += pss;
+    }
+
+    if (m_prelaunchMemory != total) {
+        m_prelaunchMemory = total;
+        emit prelaunchMemoryChanged();
+    }
+    updateState();
+}
+
+/*
+  Terminate prelaunched processes until their \a total measured memory
+  fits in the budget.  Processes needed for the refill target are kept
+  as long as possible.  Otherwise the most expensive process goes first;
+  among equally expensive ones, the process furthest back in the pool,
+  which create() would consume last.
+ */
+
+void QPrelaunchProcessBackendFactory::evict(qint64 total)
+{
+    int keep = refillTarget();
+    while (total > m_memoryBudget && !m_pss.isEmpty()) {
+        int victim = -1;
+        for (int i = 0 ; i < m_pool.size() ; i++) {
+            if (!m_pss.contains(m_pool.at(i)))
+                continue;
+            if (victim < 0) {
+                victim = i;
+                continue;
+            }
+            bool needed = i < keep;
+            bool victimNeeded = victim < keep;
+            qint64 pss = m_pss.value(m_pool.at(i));
+            qint64 victimPss = m_pss.value(m_pool.at(victim));
+            if (needed != victimNeeded) {
+                if (!needed)
+                    victim = i;
+            } else if (pss >= victimPss) {
+                victim = i;
+            }
+        }
+        QPrelaunchProcessBackend *backend = m_pool.takeAt(victim);
+        total -= m_pss.take(backend);
+        // qDebug() << Q_FUNC_INFO << "evicting" << backend->pid();
+        delete backend;   // This will kill the child process as well
+    }
+}
+
+/*
+  Return true if one more prelaunched process is expected to fit in the
+  memory budget.  Processes that have not been measured yet, including
+  the new one, are charged the most recently measured average.
+ */
+
+bool QPrelaunchProcessBackendFactory::fitsMemoryBudget() const
+{
+    if (m_memoryBudget <= 0)
+        return true;
+
+    qint64 total = 0;
+    foreach (qint64 pss, m_pss)
+        total += pss;
+    return total + m_averagePss * (m_pool.size() - m_pss.size() + 1) <= m_memoryBudget;
+}
+
+/*
+  Return true if the factory is currently allowed to prelaunch processes.
+ */
+
+bool QPrelaunchProcessBackendFactory::canPrelaunch() const
+{
+    return m_prelaunchEnabled && !m_memoryRestricted && m_info;
+}
+
+/*
+  Return the pool size that is refilled without waiting for idle CPU.
+  This is the minimum pool size, raised to the length of the current
+  burst of create() calls, and capped by the maximum pool size.
+ */
+
+int QPrelaunchProcessBackendFactory::refillTarget() const
+{
+    if (!canPrelaunch())
+        return 0;
+
+    int target = m_minimum;
+    if (m_burstCount > 1 && m_lastCreate.isValid() && m_lastCreate.elapsed() <= kBurstInterval)
+        target = qMax(target, m_burstCount);
+    return qMin(target, m_maximum);
+}
+
+/*
+  Return the pool size that is filled using idle CPU.  Without a
+  prelaunch demand this is the maximum pool size.
+ */
+
+int QPrelaunchProcessBackendFactory::poolLimit() const
+{
+    if (m_prelaunchDemand < 0)
+        return m_maximum;
+    return qBound(m_minimum, m_prelaunchDemand, m_maximum);
+}
+
+/*
+  Start one more prelaunched process and add it to the pool.
+ */
+
+void QPrelaunchProcessBackendFactory::prelaunch()
+{
+    // qDebug() << Q_FUNC_INFO << "...launching";
+    QPrelaunchProcessBackend *backend = new QPrelaunchProcessBackend(*m_info, this);
+    connect(backend, SIGNAL(finished(int,QProcess::ExitStatus)),
+            SLOT(prelaunchFinished(int,QProcess::ExitStatus)));
+    connect(backend, SIGNAL(error(QProcess::ProcessError)),
+            SLOT(prelaunchError(QProcess::ProcessError)));
+    connect(backend, SIGNAL(stateChanged(QProcess::ProcessState)),
+            SLOT(updateState()));
+    m_pool.append(backend);
+    backend->prestart();
+    emit processPrelaunched();
+}
+
+/*
+  Terminate all prelaunched processes.
+ */
+
+void QPrelaunchProcessBackendFactory::clearPool()
+{
+    trimPool(0);
+}
+
+/*
+  Terminate prelaunched processes until at most \a size remain.
+  Processes that are still starting up are dropped first.
+ */
+
+void QPrelaunchProcessBackendFactory::trimPool(int size)
+{
+    for (int i = m_pool.size() - 1 ; i >= 0 && m_pool.size() > size ; i--) {
+        if (!m_pool.at(i)->isReady()) {
+            m_pss.remove(m_pool.at(i));
+            delete m_pool.takeAt(i);   // This will kill the child process as well
+        }
+    }
+    while (m_pool.size() > size) {
+        m_pss.remove(m_pool.last());
+        delete m_pool.takeLast();
+    }
+}
+
+/*
+  Schedule a call to refill() from the event loop.
+ */
+
+void QPrelaunchProcessBackendFactory::queueRefill()
+{
+    if (!m_refillQueued) {
+        m_refillQueued = true;
+        QTimer::singleShot(0, this, SLOT(refill()));
+    }
+}
+
+/*
+  Remove \a backend from the pool and return it, or return NULL
+  if it is not a member of the pool.
+ */
+
+QPrelaunchProcessBackend *QPrelaunchProcessBackendFactory::takeFromPool(QObject *backend)
+{
+    for (int i = 0 ; i < m_pool.size() ; i++) {
+        if (m_pool.at(i) == backend) {
+            m_pss.remove(m_pool.at(i));
+            return m_pool.takeAt(i);
+        }
+    }
+    return NULL;
+}
+
 /*!
     Sets the QProcessInfo that is used to determine the prelaunched runtime to \a processInfo.
     An internal copy is made of the \a processInfo object.
@@ -277,10 +732,12 @@ void QPrelaunchProcessBackendFactory::setProcessInfo(QProcessInfo *processInfo)
         if (processInfo) {
             m_info = new QProcessInfo(*processInfo);
             m_info->setParent(this);
-            if (m_prelaunch) {
-                m_prelaunch->deleteLater();
-                m_prelaunch = NULL;
-            }
+            foreach (QPrelaunchProcessBackend *backend, m_pool)
+                backend->deleteLater();
+            m_pool.clear();
+            m_pss.clear();
+            m_averagePss = 0;
+            queueRefill();
         }
         updateState();
         emit processInfoChanged();
@@ -305,9 +762,29 @@ void QPrelaunchProcessBackendFactory::setProcessInfo(QProcessInfo& processInfo)
   \fn void QPrelaunchProcessBackendFactory::prelaunchEnabledChanged()
   This signal is emitted when the prelaunchEnabled property is changed.
  */
+/*!
+  \fn void QPrelaunchProcessBackendFactory::minimumPoolSizeChanged()
+  This signal is emitted when the minimumPoolSize property is changed.
+ */
+/*!
+  \fn void QPrelaunchProcessBackendFactory::maximumPoolSizeChanged()
+  This signal is emitted when the maximumPoolSize property is changed.
+ */
+/*!
+  \fn void QPrelaunchProcessBackendFactory::memoryBudgetChanged()
+  This signal is emitted when the memoryBudget property is changed.
+ */
+/*!
+  \fn void QPrelaunchProcessBackendFactory::prelaunchMemoryChanged()
+  This signal is emitted when the measured prelaunchMemory changes.
+ */
+/*!
+  \fn void QPrelaunchProcessBackendFactory::statisticsChanged()
+  This signal is emitted when the hitCount or missCount properties change.
+ */
 /*!
   \fn void QPrelaunchProcessBackendFactory::processPrelaunched()
-  This signal is emitted when the prelaunched process is first created.
+  This signal is emitted when a prelaunched process is first created.
  */
 
 #include "moc_qprelaunchprocessbackendfactory.cpp"
@@ -42,6 +42,10 @@
 #ifndef PRELAUNCH_PROCESS_BACKEND_FACTORY_H
 #define PRELAUNCH_PROCESS_BACKEND_FACTORY_H
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+
 #include "qprocessbackendfactory.h"
 #include "qprocessmanager-global.h"
 
@@ -55,6 +59,12 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QPrelaunchProcessBackendFactory : public QPr
     Q_OBJECT
     Q_PROPERTY(QProcessInfo* processInfo READ processInfo WRITE setProcessInfo NOTIFY processInfoChanged)
     Q_PROPERTY(bool prelaunchEnabled READ prelaunchEnabled WRITE setPrelaunchEnabled NOTIFY prelaunchEnabledChanged)
+    Q_PROPERTY(int minimumPoolSize READ minimumPoolSize WRITE setMinimumPoolSize NOTIFY minimumPoolSizeChanged)
+    Q_PROPERTY(int maximumPoolSize READ maximumPoolSize WRITE setMaximumPoolSize NOTIFY maximumPoolSizeChanged)
+    Q_PROPERTY(qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged)
+    Q_PROPERTY(qint64 prelaunchMemory READ prelaunchMemory NOTIFY prelaunchMemoryChanged)
+    Q_PROPERTY(int hitCount READ hitCount NOTIFY statisticsChanged)
+    Q_PROPERTY(int missCount READ missCount NOTIFY statisticsChanged)
 
 public:
     QPrelaunchProcessBackendFactory(QObject *parent = 0);
@@ -70,15 +80,35 @@ public:
     bool prelaunchEnabled() const;
     void setPrelaunchEnabled(bool value);
 
+    int  minimumPoolSize() const;
+    void setMinimumPoolSize(int size);
+    int  maximumPoolSize() const;
+    void setMaximumPoolSize(int size);
+
+    qint64 memoryBudget() const;
+    void   setMemoryBudget(qint64 budget);
+    qint64 prelaunchMemory() const;
+
     bool hasPrelaunchedProcess() const;
+    int  prelaunchedCount() const;
+
+    int  hitCount() const;
+    int  missCount() const;
+    Q_INVOKABLE void resetStatistics();
 
 signals:
     void processInfoChanged();
     void prelaunchEnabledChanged();
+    void minimumPoolSizeChanged();
+    void maximumPoolSizeChanged();
+    void memoryBudgetChanged();
+    void prelaunchMemoryChanged();
+    void statisticsChanged();
     void processPrelaunched();
 
 protected:
     virtual void handleMemoryRestrictionChange();
+    virtual void handlePrelaunchDemandChange();
     QPrelaunchProcessBackend *prelaunchProcessBackend() const;
 
 protected slots:
@@ -88,11 +118,37 @@ private slots:
     void prelaunchFinished(int, QProcess::ExitStatus);
     void prelaunchError(QProcess::ProcessError);
     void updateState();
+    void refill();
+    void sampleMemory();
+
+private:
+    bool canPrelaunch() const;
+    int  refillTarget() const;
+    int  poolLimit() const;
+    bool fitsMemoryBudget() const;
+    void evict(qint64 total);
+    void prelaunch();
+    void clearPool();
+    void trimPool(int size);
+    void queueRefill();
+    QPrelaunchProcessBackend *takeFromPool(QObject *backend);
 
 private:
-    QPrelaunchProcessBackend *m_prelaunch;
+    QList<QPrelaunchProcessBackend *> m_pool;
     QProcessInfo             *m_info;
     bool                     m_prelaunchEnabled;
+    bool                     m_refillQueued;
+    int                      m_minimum;
+    int                      m_maximum;
+    int                      m_hits;
+    int                      m_misses;
+    int                      m_burstCount;
+    QElapsedTimer            m_lastCreate;
+    qint64                   m_memoryBudget;
+    qint64                   m_prelaunchMemory;
+    qint64                   m_averagePss;
+    QHash<QPrelaunchProcessBackend *, qint64> m_pss;
+    QTimer                   m_memoryTimer;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -83,6 +83,7 @@ QProcessBackendFactory::QProcessBackendFactory(QObject *parent)
     , m_rewriteDelegate(NULL)
     , m_memoryRestricted(false)
     , m_idleCpuRequest(false)
+    , m_prelaunchDemand(-1)
 {
 }
 
@@ -107,6 +108,31 @@ void QProcessBackendFactory::setMemoryRestricted(bool memoryRestricted)
     }
 }
 
+/*!
+    Return the number of prelaunched processes requested from this
+    factory, or -1 if there is no request.
+*/
+
+int QProcessBackendFactory::prelaunchDemand() const
+{
+    return m_prelaunchDemand;
+}
+
+/*!
+    Set the number of prelaunched processes this factory should keep
+    ready to \a demand.  The QProcessBackendManager sets this from the
+    plan of its QLaunchPredictor.  A value of -1 means that there is no
+    prediction and the factory should use its own policy.
+*/
+
+void QProcessBackendFactory::setPrelaunchDemand(int demand)
+{
+    if (m_prelaunchDemand != demand) {
+        m_prelaunchDemand = demand;
+        handlePrelaunchDemandChange();
+    }
+}
+
 /*!
   Return a list of internal processes that are in use by this factory
  */
@@ -137,6 +163,14 @@ void QProcessBackendFactory::handleMemoryRestrictionChange()
 {
 }
 
+/*!
+   Override this in subclasses to handle prelaunch demand changes
+*/
+
+void QProcessBackendFactory::handlePrelaunchDemandChange()
+{
+}
+
 /*!
    Return the current QMatchDelegate object
  */
@@ -157,9 +191,12 @@ void QProcessBackendFactory::setMatchDelegate(QMatchDelegate *matchDelegate)
         if (m_matchDelegate)
             delete m_matchDelegate;
         m_matchDelegate = matchDelegate;
-        if (m_matchDelegate)
+        if (m_matchDelegate) {
             m_matchDelegate->setParent(this);
+            connect(m_matchDelegate, SIGNAL(indexChanged()), SIGNAL(indexChanged()));
+        }
         emit matchDelegateChanged();
+        emit indexChanged();
     }
 }
 
@@ -237,6 +274,24 @@ bool QProcessBackendFactory::canCreate(const QProcessInfo& info) const
     return true;
 }
 
+/*!
+  Return true if canCreate() can only succeed for QProcessInfo records
+  where the entry \a key is equal to \a value, and fill in both.  The
+  QProcessBackendManager uses this to skip factories that cannot match
+  without calling canCreate() on them.
+
+  The default implementation asks the QMatchDelegate.  Override this
+  function to return false if your canCreate() does not honour the
+  match delegate, and emit indexChanged() when the answer changes.
+*/
+
+bool QProcessBackendFactory::indexEntry(QString *key, QVariant *value) const
+{
+    if (m_matchDelegate)
+        return m_matchDelegate->indexEntry(key, value);
+    return false;
+}
+
 /*!
   \fn void QProcessBackendFactory::rewrite(QProcessInfo& info)
 
@@ -276,6 +331,12 @@ void QProcessBackendFactory::rewrite(QProcessInfo& info)
   Signal emitted whenever the idle CPU request is changed
 */
 
+/*!
+  \fn void QProcessBackendFactory::indexChanged()
+
+  Signal emitted whenever the result of indexEntry() is changed
+*/
+
 /*!
   \fn QProcessBackend * QProcessBackendFactory::create(const QProcessInfo& info, QObject *parent)
 
@@ -44,6 +44,7 @@
 
 #include <QObject>
 #include <QProcessEnvironment>
+#include <QVariant>
 
 #include "qprocessmanager-global.h"
 #include "qprocesslist.h"
@@ -67,11 +68,15 @@ public:
     QProcessBackendFactory(QObject *parent = 0);
     virtual ~QProcessBackendFactory();
     virtual bool            canCreate(const QProcessInfo& info) const;
+    virtual bool            indexEntry(QString *key, QVariant *value) const;
     virtual void            rewrite(QProcessInfo& info);
     virtual QProcessBackend *create(const QProcessInfo& info, QObject *parent) = 0;
 
     void              setMemoryRestricted(bool);
 
+    int               prelaunchDemand() const;
+    void              setPrelaunchDemand(int);
+
     QPidList           internalProcesses() const;
 
     QMatchDelegate *   matchDelegate() const;
@@ -89,11 +94,13 @@ signals:
     void matchDelegateChanged();
     void rewriteDelegateChanged();
     void idleCpuRequestChanged();
+    void indexChanged();
 
 protected:
     void         setIdleCpuRequest(bool);
     virtual void setInternalProcesses(const QPidList&);
     virtual void handleMemoryRestrictionChange();
+    virtual void handlePrelaunchDemandChange();
 
 protected:
     QPidList          m_internalProcesses;
@@ -101,6 +108,7 @@ protected:
     QRewriteDelegate *m_rewriteDelegate;
     bool             m_memoryRestricted;
     bool             m_idleCpuRequest;
+    int              m_prelaunchDemand;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
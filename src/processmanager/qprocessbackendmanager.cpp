@@ -45,6 +45,8 @@
 #include "qprocessbackendfactory.h"
 #include "qprocessbackend.h"
 #include "qcpuidledelegate.h"
+#include "qlaunchpredictor.h"
+#include "qprocessinfo.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -72,6 +74,14 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   QProcessBackend *backend = bm->create(i);
   \endcode
 
+  The factories are tried in the order they were added, and the first
+  one that can create the process is used.  To keep this cheap with many
+  factories, the backend manager indexes factories whose match delegate
+  requires a single key to hold a single value (see
+  QProcessBackendFactory::indexEntry()).  Only the factories indexed
+  under the values found in the QProcessInfo record, plus the factories
+  that cannot be indexed, are asked whether they can create the process.
+
   The backend manager does not get involved in starting or tracking
   the lifetime of a process.  In general, you should use the
   QProcessManager class for processes, which contains a backend manager object.
@@ -86,6 +96,13 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   If you do not assign a QIdleDelegate, the QCpuIdleDelegate will be
   used by default.
 
+  You may also assign a QLaunchPredictor.  The backend manager records
+  every launch with the predictor and hands its plan to the factories
+  with QProcessBackendFactory::setPrelaunchDemand(), so that prelaunched
+  processes are created for what is likely to be launched next rather
+  than for everything.  Each planned identifier is assigned to the first
+  factory that can create its most recently launched QProcessInfo.
+
   If you prefer to not use delegates, you can subclass QProcessBackendManager
   and override the \l{handleIdleCpuRequest()} function.  If you do this,
   you must shut off the default QIdleDelegate.  For example:
@@ -122,6 +139,11 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
     \brief The QIdleDelegate object assigned to this factory.
 */
 
+/*!
+    \property QProcessBackendManager::launchPredictor
+    \brief The QLaunchPredictor object assigned to this manager.
+*/
+
 /*!
   Construct a QProcessBackendManager with an optional \a parent
   By default, a CpuIdleDelegate is assigned to the idleDelegate.
@@ -129,8 +151,11 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 QProcessBackendManager::QProcessBackendManager(QObject *parent)
     : QObject(parent)
+    , m_indexValid(false)
+    , m_launchPredictor(NULL)
     , m_memoryRestricted(false)
     , m_idleCpuRequest(false)
+    , m_prelaunchDemandPending(false)
 {
     m_idleDelegate = new QCpuIdleDelegate(this);
     connect(m_idleDelegate, SIGNAL(idleCpuAvailable()), SLOT(idleCpuAvailable()));
@@ -150,16 +175,76 @@ QProcessBackendManager::~QProcessBackendManager()
 
 QProcessBackend *QProcessBackendManager::create(const QProcessInfo& info, QObject *parent)
 {
-    foreach (QProcessBackendFactory *factory, m_factories) {
-        if (factory->canCreate(info)) {
-            QProcessInfo i = info;
-            factory->rewrite(i);
-            return factory->create(i, parent);
-        }
+    QProcessBackendFactory *factory = factoryFor(info);
+    if (!factory)
+        return NULL;
+
+    QProcessInfo i = info;
+    factory->rewrite(i);
+    QProcessBackend *backend = factory->create(i, parent);
+    if (m_launchPredictor) {
+        m_launchPredictor->recordLaunch(info);
+        scheduleUpdatePrelaunchDemand();
+    }
+    return backend;
+}
+
+/*
+  Return the first factory that can create \a info, or NULL.  Only the
+  candidates from the dispatch index are asked.
+ */
+
+QProcessBackendFactory *QProcessBackendManager::factoryFor(const QProcessInfo& info)
+{
+    if (!m_indexValid)
+        buildIndex();
+
+    QList<int> candidates = m_unindexed;
+    QHash<QString, QHash<QString, QList<int> > >::const_iterator it;
+    for (it = m_index.constBegin() ; it != m_index.constEnd() ; ++it) {
+        QVariant value = info.value(it.key());
+        if (value.isValid())
+            candidates.append(it.value().value(value.toString()));
+    }
+    qSort(candidates);
+
+    foreach (int i, candidates) {
+        QProcessBackendFactory *factory = m_factories.at(i);
+        if (factory->canCreate(info))
+            return factory;
     }
     return NULL;
 }
 
+/*
+  Rebuild the dispatch index.  Factories are stored by position so that
+  the candidates can be tried in the order the factories were added.
+ */
+
+void QProcessBackendManager::buildIndex()
+{
+    m_index.clear();
+    m_unindexed.clear();
+    for (int i = 0 ; i < m_factories.size() ; i++) {
+        QString key;
+        QVariant value;
+        if (m_factories.at(i)->indexEntry(&key, &value) && value.canConvert<QString>())
+            m_index[key][value.toString()].append(i);
+        else
+            m_unindexed.append(i);
+    }
+    m_indexValid = true;
+}
+
+/*
+  Mark the dispatch index for rebuilding on the next lookup.
+ */
+
+void QProcessBackendManager::invalidateIndex()
+{
+    m_indexValid = false;
+}
+
 /*!
   Add a QProcessBackendFactory \a factory to the end of the Factory list.
   The factory becomes a child of the backend manager.
@@ -176,6 +261,10 @@ void QProcessBackendManager::addFactory(QProcessBackendFactory *factory)
     connect(factory, SIGNAL(internalProcessError(QProcess::ProcessError)),
             SLOT(handleInternalProcessError(QProcess::ProcessError)));
     connect(factory, SIGNAL(idleCpuRequestChanged()), SLOT(updateIdleCpuRequest()));
+    connect(factory, SIGNAL(indexChanged()), SLOT(invalidateIndex()));
+    m_indexValid = false;
+    if (m_launchPredictor)
+        scheduleUpdatePrelaunchDemand();
     updateIdleCpuRequest();
 }
 
@@ -242,6 +331,36 @@ void QProcessBackendManager::setIdleDelegate(QIdleDelegate *idleDelegate)
     }
 }
 
+/*!
+   Return the current QLaunchPredictor object
+ */
+
+QLaunchPredictor *QProcessBackendManager::launchPredictor() const
+{
+    return m_launchPredictor;
+}
+
+/*!
+   Set a new QLaunchPredictor object \a launchPredictor.
+   The QProcessBackendManager takes over parentage of the QLaunchPredictor.
+   Setting it to null returns the factories to their own prelaunch policy.
+ */
+
+void QProcessBackendManager::setLaunchPredictor(QLaunchPredictor *launchPredictor)
+{
+    if (launchPredictor != m_launchPredictor) {
+        if (m_launchPredictor)
+            delete m_launchPredictor;
+        m_launchPredictor = launchPredictor;
+        if (m_launchPredictor) {
+            m_launchPredictor->setParent(this);
+            connect(m_launchPredictor, SIGNAL(predictionChanged()), SLOT(scheduleUpdatePrelaunchDemand()));
+        }
+        updatePrelaunchDemand();
+        emit launchPredictorChanged();
+    }
+}
+
 /*!
    \fn bool QProcessBackendManager::idleCpuRequest() const
    Return \c{true} if we need idle CPU cycles.
@@ -298,6 +417,42 @@ void QProcessBackendManager::updateInternalProcesses()
     }
 }
 
+/*!
+  Schedule an update of the prelaunch demand from the event loop.
+  Several requests before the update runs are coalesced into one.
+ */
+
+void QProcessBackendManager::scheduleUpdatePrelaunchDemand()
+{
+    if (!m_prelaunchDemandPending) {
+        m_prelaunchDemandPending = true;
+        QMetaObject::invokeMethod(this, "updatePrelaunchDemand", Qt::QueuedConnection);
+    }
+}
+
+/*!
+  Distribute the plan of the launch predictor over the factories
+ */
+
+void QProcessBackendManager::updatePrelaunchDemand()
+{
+    m_prelaunchDemandPending = false;
+    QHash<QProcessBackendFactory *, int> demand;
+    if (m_launchPredictor) {
+        QHash<QString, int> plan = m_launchPredictor->prewarmPlan();
+        QHash<QString, int>::const_iterator it;
+        for (it = plan.constBegin() ; it != plan.constEnd() ; ++it) {
+            QProcessInfo info(m_launchPredictor->launchInfo(it.key()));
+            QProcessBackendFactory *factory = factoryFor(info);
+            if (factory)
+                demand[factory] += it.value();
+        }
+    }
+
+    foreach (QProcessBackendFactory *factory, m_factories)
+        factory->setPrelaunchDemand(m_launchPredictor ? demand.value(factory) : -1);
+}
+
 /*!
   Override this function to customize your handling of Idle CPU requests.
  */
@@ -335,6 +490,11 @@ void QProcessBackendManager::handleInternalProcessError(QProcess::ProcessError e
   Signal emitted whenever the IdleDelegate is changed.
 */
 
+/*!
+  \fn void QProcessBackendManager::launchPredictorChanged()
+  Signal emitted whenever the QLaunchPredictor is changed.
+*/
+
 /*!
   \fn void QProcessBackendManager::internalProcessError(QProcess::ProcessError error)
   Signal emitted when an internal process has an \a error.
@@ -56,11 +56,13 @@ class QProcessInfo;
 class QProcessBackendFactory;
 class QProcessBackend;
 class QIdleDelegate;
+class QLaunchPredictor;
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QProcessBackendManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QIdleDelegate* idleDelegate READ idleDelegate WRITE setIdleDelegate NOTIFY idleDelegateChanged)
+    Q_PROPERTY(QLaunchPredictor* launchPredictor READ launchPredictor WRITE setLaunchPredictor NOTIFY launchPredictorChanged)
 
 public:
     explicit QProcessBackendManager(QObject *parent = 0);
@@ -77,8 +79,12 @@ public:
     void           setIdleDelegate(QIdleDelegate *);
     bool           idleCpuRequest() const { return m_idleCpuRequest; }
 
+    QLaunchPredictor * launchPredictor() const;
+    void              setLaunchPredictor(QLaunchPredictor *);
+
 signals:
     void idleDelegateChanged();
+    void launchPredictorChanged();
     void internalProcessesChanged();
     void internalProcessError(QProcess::ProcessError);
 
@@ -93,13 +99,25 @@ protected slots:
 private slots:
     void updateIdleCpuRequest();
     void updateInternalProcesses();
+    void scheduleUpdatePrelaunchDemand();
+    void updatePrelaunchDemand();
+    void invalidateIndex();
+
+private:
+    QProcessBackendFactory *factoryFor(const QProcessInfo& info);
+    void                    buildIndex();
 
 private:
     QList<QProcessBackendFactory*> m_factories;
+    QHash<QString, QHash<QString, QList<int> > > m_index;
+    QList<int>                     m_unindexed;
+    bool                           m_indexValid;
     QPidList                       m_internalProcesses;
     QIdleDelegate                 *m_idleDelegate;
+    QLaunchPredictor              *m_launchPredictor;
     bool                          m_memoryRestricted;
     bool                          m_idleCpuRequest;
+    bool                          m_prelaunchDemandPending;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
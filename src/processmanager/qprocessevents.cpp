@@ -0,0 +1,542 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocessevents.h"
+#include "qprocesssnapshot.h"
+#include "qprocutils.h"
+
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(Q_OS_LINUX)
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#endif
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+const int kDefaultPollInterval = 1000;
+
+/*!
+  \class QProcessEvents
+  \brief The QProcessEvents class reports forks and exits within watched process trees
+  \inmodule QtProcessManager
+
+  QProcessEvents keeps a live tree of the descendants of every
+  watched process.  It emits forked() when a process in a tree starts
+  a child, execed() when one runs a new program and exited() when one
+  goes away.  Processes outside the watched trees are ignored.
+
+  When it can, QProcessEvents subscribes to the kernel proc connector
+  (a \c{NETLINK_CONNECTOR} socket listening for \c{PROC_EVENT_FORK},
+  \c{PROC_EVENT_EXEC} and \c{PROC_EVENT_EXIT}) and is told about each
+  event as it happens; \l{eventDriven} is then true.  The kernel only
+  allows this with \c{CAP_NET_ADMIN}.  Without it QProcessEvents falls
+  back to comparing a QProcessSnapshot of \c{/proc} every
+  \l{pollInterval} milliseconds.  Events then arrive late, a process
+  that comes and goes within one interval is missed, execed() is never
+  emitted and the exit status is reported as -1.
+
+  A watched process stays in the tree after it exits, so that its
+  remaining descendants are still attributed to it.  Call unwatch()
+  once it is no longer of interest.
+ */
+
+/*!
+  \property QProcessEvents::active
+  \brief True between start() and stop()
+ */
+
+/*!
+  \property QProcessEvents::eventDriven
+  \brief True if events come from the kernel proc connector rather than polling
+ */
+
+/*!
+  \property QProcessEvents::pollInterval
+  \brief Time in milliseconds between scans of /proc when the proc connector is not available
+ */
+
+/*!
+  Construct a QProcessEvents object with optional \a parent.  Call
+  start() to begin tracking.
+ */
+
+QProcessEvents::QProcessEvents(QObject *parent)
+    : QObject(parent)
+    , m_fd(-1)
+    , m_notifier(0)
+    , m_snapshot(0)
+    , m_pollInterval(kDefaultPollInterval)
+    , m_active(false)
+{
+}
+
+/*!
+  Destroy the object and close the proc connector socket.
+ */
+
+QProcessEvents::~QProcessEvents()
+{
+    closeSocket();
+}
+
+/*!
+  Return true if tracking has been started.
+ */
+
+bool QProcessEvents::isActive() const
+{
+    return m_active;
+}
+
+/*!
+  Return true if events come from the kernel proc connector.
+ */
+
+bool QProcessEvents::eventDriven() const
+{
+    return m_notifier != 0;
+}
+
+/*!
+  Return the poll interval in milliseconds.
+ */
+
+int QProcessEvents::pollInterval() const
+{
+    return m_pollInterval;
+}
+
+/*!
+  Set the poll interval to \a interval milliseconds.  This only
+  matters when the proc connector is not available.
+ */
+
+void QProcessEvents::setPollInterval(int interval)
+{
+    if (interval > 0 && interval != m_pollInterval) {
+        m_pollInterval = interval;
+        if (m_snapshot)
+            m_snapshot->setInterval(m_pollInterval);
+        emit pollIntervalChanged();
+    }
+}
+
+/*!
+  Start tracking the watched trees.
+ */
+
+void QProcessEvents::start()
+{
+    if (m_active)
+        return;
+    m_active = true;
+    if (openSocket())
+        emit eventDrivenChanged();
+    else
+        startPolling();
+    resync();
+    emit activeChanged();
+}
+
+/*!
+  Stop tracking.  The watched processes are remembered for the next start().
+ */
+
+void QProcessEvents::stop()
+{
+    if (!m_active)
+        return;
+    m_active = false;
+    bool wasEventDriven = eventDriven();
+    closeSocket();
+    delete m_snapshot;
+    m_snapshot = 0;
+    if (wasEventDriven)
+        emit eventDrivenChanged();
+    emit activeChanged();
+}
+
+/*!
+  Add \a pid to the watched trees.  A process that has just started
+  has no descendants yet, so \c{/proc} is only scanned for the ones it
+  already has if \a existing is true.
+ */
+
+void QProcessEvents::watch(Q_PID pid, bool existing)
+{
+    if (pid <= 0 || m_parents.contains(pid))
+        return;
+    m_parents.insert(pid, 0);
+    if (existing) {
+        foreach (pid_t child, QProcUtils::descendantsForPid(pid))
+            if (!m_parents.contains(child))
+                m_parents.insert(child, QProcUtils::ppidForPid(child));
+    }
+}
+
+/*!
+  Stop watching \a pid and forget its descendants.
+ */
+
+void QProcessEvents::unwatch(Q_PID pid)
+{
+    if (!m_parents.contains(pid))
+        return;
+    foreach (Q_PID child, descendants(pid))
+        m_parents.remove(child);
+    m_parents.remove(pid);
+}
+
+/*!
+  Return true if \a pid is watched or descends from a watched process.
+ */
+
+bool QProcessEvents::isWatched(Q_PID pid) const
+{
+    return m_parents.contains(pid);
+}
+
+/*!
+  Return the watched process that \a pid descends from, \a pid itself
+  if it is watched directly, or 0 if it is not in any tree.
+ */
+
+Q_PID QProcessEvents::rootOf(Q_PID pid) const
+{
+    int depth = m_parents.size();
+    QHash<Q_PID, Q_PID>::const_iterator it = m_parents.find(pid);
+    while (it != m_parents.constEnd() && it.value() != 0 && depth-- > 0) {
+        pid = it.value();
+        it = m_parents.find(pid);
+    }
+    return it == m_parents.constEnd() || it.value() != 0 ? 0 : pid;
+}
+
+/*!
+  Return the known descendants of \a pid.  Children come before
+  their own children.
+ */
+
+QPidList QProcessEvents::descendants(Q_PID pid) const
+{
+    QPidList result;
+    QHash<Q_PID, Q_PID>::const_iterator it;
+    for (it = m_parents.constBegin() ; it != m_parents.constEnd() ; ++it)
+        if (it.value() == pid)
+            result << it.key();
+    for (int i = 0 ; i < result.size() ; i++)
+        for (it = m_parents.constBegin() ; it != m_parents.constEnd() ; ++it)
+            if (it.value() == result.at(i))
+                result << it.key();
+    return result;
+}
+
+/*
+  Subscribe to the proc connector.  Returns false if the kernel
+  doesn't let us, which is the normal case without CAP_NET_ADMIN.
+ */
+
+bool QProcessEvents::openSocket()
+{
+#if defined(Q_OS_LINUX)
+    m_fd = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (m_fd == -1) {
+        qWarning("Unable to create proc connector socket: %s", strerror(errno));
+        return false;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    if (::bind(m_fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        if (errno != EPERM && errno != EACCES)
+            qWarning("Unable to bind proc connector socket: %s", strerror(errno));
+        closeSocket();
+        return false;
+    }
+
+    char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))]
+        __attribute__((aligned(NLMSG_ALIGNTO)));
+    memset(buf, 0, sizeof(buf));
+    struct nlmsghdr *nl = (struct nlmsghdr *) buf;
+    nl->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+    nl->nlmsg_type = NLMSG_DONE;
+    struct cn_msg *cn = (struct cn_msg *) NLMSG_DATA(nl);
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(enum proc_cn_mcast_op);
+    *(enum proc_cn_mcast_op *) cn->data = PROC_CN_MCAST_LISTEN;
+    if (::send(m_fd, buf, nl->nlmsg_len, 0) == -1) {
+        qWarning("Unable to subscribe to proc connector: %s", strerror(errno));
+        closeSocket();
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, SIGNAL(activated(int)), SLOT(socketActivated()));
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+  This may run from inside socketActivated(), so the notifier is
+  deleted later.
+ */
+
+void QProcessEvents::closeSocket()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = 0;
+    }
+    if (m_fd != -1) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void QProcessEvents::startPolling()
+{
+    m_snapshot = new QProcessSnapshot(this);
+    connect(m_snapshot, SIGNAL(spawned(const QPidList&)), SLOT(snapshotSpawned(const QPidList&)));
+    connect(m_snapshot, SIGNAL(exited(const QPidList&)), SLOT(snapshotExited(const QPidList&)));
+    connect(m_snapshot, SIGNAL(changed(const QPidList&)), SLOT(snapshotChanged(const QPidList&)));
+    m_snapshot->update();
+    m_snapshot->setInterval(m_pollInterval);
+}
+
+/*
+  Bring the trees up to date after events may have been lost: drop
+  processes that have gone and pick up children we haven't seen.
+ */
+
+void QProcessEvents::resync()
+{
+    foreach (Q_PID pid, m_parents.keys()) {
+        if (m_parents.value(pid) != 0 && ::kill(pid, 0) == -1 && errno == ESRCH)
+            processExited(pid, -1);
+    }
+    foreach (Q_PID pid, m_parents.keys()) {
+        if (m_parents.value(pid) == 0) {
+            foreach (pid_t child, QProcUtils::descendantsForPid(pid))
+                processForked(QProcUtils::ppidForPid(child), child);
+        }
+    }
+}
+
+/*
+  Read every pending proc connector message.  Thread forks and exits
+  are skipped; only whole processes are tracked.
+ */
+
+void QProcessEvents::socketActivated()
+{
+#if defined(Q_OS_LINUX)
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    forever {
+        ssize_t n = ::recv(m_fd, buf, sizeof(buf), 0);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS) {   // The kernel dropped events
+                resync();
+                continue;
+            }
+            break;
+        }
+        for (struct nlmsghdr *nl = (struct nlmsghdr *) buf ; NLMSG_OK(nl, n) ; nl = NLMSG_NEXT(nl, n)) {
+            struct cn_msg *cn = (struct cn_msg *) NLMSG_DATA(nl);
+            struct proc_event *event = (struct proc_event *) cn->data;
+            switch (event->what) {
+            case PROC_EVENT_NONE:
+                if (event->event_data.ack.err != 0) {
+                    qWarning("Proc connector refused: %s", strerror(event->event_data.ack.err));
+                    closeSocket();
+                    emit eventDrivenChanged();
+                    startPolling();
+                    resync();
+                    return;
+                }
+                break;
+            case PROC_EVENT_FORK:
+                if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid)
+                    processForked(event->event_data.fork.parent_tgid, event->event_data.fork.child_tgid);
+                break;
+            case PROC_EVENT_EXEC:
+                if (m_parents.contains(event->event_data.exec.process_tgid))
+                    emit execed(event->event_data.exec.process_tgid);
+                break;
+            case PROC_EVENT_EXIT:
+                if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                    processExited(event->event_data.exit.process_tgid, event->event_data.exit.exit_code);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+#endif
+}
+
+/*
+  New processes from a poll.  A child may be listed before its
+  parent, so keep going until nothing more is adopted.
+ */
+
+void QProcessEvents::snapshotSpawned(const QPidList& pids)
+{
+    QPidList pending = pids;
+    bool progress = true;
+    while (progress && !pending.isEmpty()) {
+        progress = false;
+        for (int i = 0 ; i < pending.size() ; ) {
+            int index = m_snapshot->indexOf(pending.at(i));
+            Q_PID parent = index >= 0 ? m_snapshot->ppid(index) : 0;
+            if (parent && m_parents.contains(parent)) {
+                processForked(parent, pending.takeAt(i));
+                progress = true;
+            }
+            else
+                i++;
+        }
+    }
+}
+
+void QProcessEvents::snapshotExited(const QPidList& pids)
+{
+    foreach (Q_PID pid, pids)
+        processExited(pid, -1);
+}
+
+/*
+  A zombie has exited, even if its parent hasn't reaped it yet
+ */
+
+void QProcessEvents::snapshotChanged(const QPidList& pids)
+{
+    foreach (Q_PID pid, pids) {
+        int index = m_snapshot->indexOf(pid);
+        if (index >= 0 && m_snapshot->state(index) == 'Z' && m_parents.value(pid) != 0)
+            processExited(pid, -1);
+    }
+}
+
+void QProcessEvents::processForked(Q_PID parent, Q_PID child)
+{
+    if (m_parents.contains(parent) && !m_parents.contains(child)) {
+        m_parents.insert(child, parent);
+        emit forked(parent, child);
+    }
+}
+
+/*
+  The exited() signal goes out while the process is still in its
+  tree, so receivers can still call rootOf().  Children of a process
+  that isn't a root are handed to its parent.
+ */
+
+void QProcessEvents::processExited(Q_PID pid, int status)
+{
+    QHash<Q_PID, Q_PID>::iterator it = m_parents.find(pid);
+    if (it == m_parents.end())
+        return;
+    emit exited(pid, status);
+
+    it = m_parents.find(pid);
+    if (it == m_parents.end() || it.value() == 0)
+        return;
+    Q_PID parent = it.value();
+    m_parents.erase(it);
+    for (it = m_parents.begin() ; it != m_parents.end() ; ++it)
+        if (it.value() == pid)
+            it.value() = parent;
+}
+
+/*!
+  \fn void QProcessEvents::activeChanged()
+  This signal is emitted when tracking starts or stops.
+ */
+
+/*!
+  \fn void QProcessEvents::eventDrivenChanged()
+  This signal is emitted when the proc connector is opened or closed.
+ */
+
+/*!
+  \fn void QProcessEvents::pollIntervalChanged()
+  This signal is emitted when the poll interval is changed.
+ */
+
+/*!
+  \fn void QProcessEvents::forked(Q_PID parent, Q_PID child)
+  This signal is emitted when \a parent, a process in a watched tree,
+  starts the process \a child.
+ */
+
+/*!
+  \fn void QProcessEvents::execed(Q_PID pid)
+  This signal is emitted when \a pid, a process in a watched tree,
+  runs a new program.  It is only emitted when eventDriven is true.
+ */
+
+/*!
+  \fn void QProcessEvents::exited(Q_PID pid, int status)
+  This signal is emitted when \a pid, a process in a watched tree,
+  exits.  The \a status is in the form returned by waitpid(), or -1
+  if it is not known.
+ */
+
+#include "moc_qprocessevents.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
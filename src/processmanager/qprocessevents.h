@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PROCESS_EVENTS_H
+#define PROCESS_EVENTS_H
+
+#include <QObject>
+#include <QHash>
+
+#include "qprocesslist.h"
+
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class QProcessSnapshot;
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QProcessEvents : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+    Q_PROPERTY(bool eventDriven READ eventDriven NOTIFY eventDrivenChanged)
+    Q_PROPERTY(int pollInterval READ pollInterval WRITE setPollInterval NOTIFY pollIntervalChanged)
+
+public:
+    explicit QProcessEvents(QObject *parent = 0);
+    virtual ~QProcessEvents();
+
+    bool     isActive() const;
+    bool     eventDriven() const;
+
+    int      pollInterval() const;
+    void     setPollInterval(int interval);
+
+    void     watch(Q_PID pid, bool existing = false);
+    void     unwatch(Q_PID pid);
+    bool     isWatched(Q_PID pid) const;
+    Q_PID    rootOf(Q_PID pid) const;
+    QPidList descendants(Q_PID pid) const;
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void activeChanged();
+    void eventDrivenChanged();
+    void pollIntervalChanged();
+    void forked(Q_PID parent, Q_PID child);
+    void execed(Q_PID pid);
+    void exited(Q_PID pid, int status);
+
+private slots:
+    void socketActivated();
+    void snapshotSpawned(const QPidList& pids);
+    void snapshotExited(const QPidList& pids);
+    void snapshotChanged(const QPidList& pids);
+
+private:
+    bool openSocket();
+    void closeSocket();
+    void startPolling();
+    void resync();
+    void processForked(Q_PID parent, Q_PID child);
+    void processExited(Q_PID pid, int status);
+
+private:
+    Q_DISABLE_COPY(QProcessEvents)
+    QHash<Q_PID, Q_PID> m_parents;   // Watched roots map to 0
+    int                 m_fd;
+    QSocketNotifier    *m_notifier;
+    QProcessSnapshot   *m_snapshot;
+    int                 m_pollInterval;
+    bool                m_active;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PROCESS_EVENTS_H
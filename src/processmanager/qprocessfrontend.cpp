@@ -41,6 +41,7 @@
 
 #include "qprocessfrontend.h"
 #include "qprocessbackend.h"
+#include "qcgroup.h"
 
 #include <QDateTime>
 
@@ -107,6 +108,53 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
     Returns 0 if process has not been started.
 */
 
+/*!
+    \property QProcessFrontend::stopDuration
+    \brief the time taken by the last stop(), in milliseconds.
+
+    The time runs from the first call to stop() until the process and
+    all of its descendants have exited.  Returns -1 if the process has
+    not been stopped.
+*/
+
+/*!
+    \property QProcessFrontend::rss
+    \brief the resident set size of the process in bytes.
+
+    This and the other memory and CPU figures are sampled by the
+    QProcessManager every QProcessManager::samplingInterval
+    milliseconds.  They are 0 until the first sample is taken, and
+    keep their last values after the process has finished.
+    \sa QProcessStatistics
+*/
+
+/*!
+    \property QProcessFrontend::pss
+    \brief the proportional set size of the process in bytes.
+*/
+
+/*!
+    \property QProcessFrontend::uss
+    \brief the unique set size of the process in bytes.
+
+    This is the memory that would be freed by killing the process.
+*/
+
+/*!
+    \property QProcessFrontend::swap
+    \brief the amount of the process that has been swapped out, in bytes.
+*/
+
+/*!
+    \property QProcessFrontend::majorFaults
+    \brief the number of page faults of the process that needed disk I/O.
+*/
+
+/*!
+    \property QProcessFrontend::cpuTime
+    \brief the user plus system CPU time of the process in milliseconds.
+*/
+
 /*!
     \property QProcessFrontend::priority
     \brief The Unix process priority (niceness).
@@ -142,6 +190,7 @@ QProcessFrontend::QProcessFrontend(QProcessBackend *backend, QObject *parent)
     : QObject(parent)
     , m_startTimeSinceEpoch(0)
     , m_backend(backend)
+    , m_stopDuration(-1)
 {
     Q_ASSERT(backend);
     backend->setParent(this);
@@ -325,6 +374,8 @@ void QProcessFrontend::stop(int timeout)
 {
     Q_ASSERT(m_backend);
     emit aboutToStop();
+    if (!m_stopTimer.isValid() && m_backend->state() != QProcess::NotRunning)
+        m_stopTimer.start();
     m_backend->stop(timeout);
 }
 
@@ -371,6 +422,100 @@ qint64 QProcessFrontend::startTime() const
     return m_startTimeSinceEpoch;
 }
 
+/*!
+    Returns the time in milliseconds that the last stop() took to
+    bring down the process and its descendants, or -1 if the process
+    has not been stopped.
+*/
+qint64 QProcessFrontend::stopDuration() const
+{
+    return m_stopDuration;
+}
+
+/*!
+    Returns the last statistics sampled for the process.
+*/
+QProcessStatistics QProcessFrontend::statistics() const
+{
+    return m_statistics;
+}
+
+/*!
+    Returns the last sampled resident set size in bytes.
+*/
+qint64 QProcessFrontend::rss() const
+{
+    return m_statistics.rss();
+}
+
+/*!
+    Returns the last sampled proportional set size in bytes.
+*/
+qint64 QProcessFrontend::pss() const
+{
+    return m_statistics.pss();
+}
+
+/*!
+    Returns the last sampled unique set size in bytes.
+*/
+qint64 QProcessFrontend::uss() const
+{
+    return m_statistics.uss();
+}
+
+/*!
+    Returns the last sampled swap usage in bytes.
+*/
+qint64 QProcessFrontend::swap() const
+{
+    return m_statistics.swap();
+}
+
+/*!
+    Returns the last sampled number of major page faults.
+*/
+qint64 QProcessFrontend::majorFaults() const
+{
+    return m_statistics.majorFaults();
+}
+
+/*!
+    Returns the last sampled CPU time in milliseconds.
+*/
+qint64 QProcessFrontend::cpuTime() const
+{
+    return m_statistics.cpuTime();
+}
+
+/*
+  Called by the QProcessManager sampler.  Finished processes keep
+  their last figures, so an invalid sample is ignored.
+ */
+void QProcessFrontend::setStatistics(const QProcessStatistics& statistics)
+{
+    if (statistics.isValid() && statistics != m_statistics) {
+        m_statistics = statistics;
+        emit statisticsChanged();
+    }
+}
+
+/*!
+    Returns the live resource usage of the cgroup the process was
+    placed in, as described for QCgroup::usage().  The map is empty if
+    the process is not running or its QProcessInfo did not ask for a
+    cgroup; a process without one shares the cgroup of its parent,
+    so the figures would not be its own.
+*/
+QVariantMap QProcessFrontend::resourceUsage() const
+{
+    Q_PID pid = m_backend->pid();
+    if (!pid || !QCgroup::needsCgroup(m_backend->processInfo()))
+        return QVariantMap();
+    QString path = QCgroup::cgroupForPid(pid);
+    return path.isEmpty() ? QVariantMap() : QCgroup::usage(path);
+}
+
 /*!
     Returns the ProcessInfo object as a QVariantMap.
 
@@ -406,6 +551,11 @@ void QProcessFrontend::handleError(QProcess::ProcessError processError)
  */
 void QProcessFrontend::handleFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    if (m_stopTimer.isValid()) {
+        m_stopDuration = m_stopTimer.elapsed();
+        m_stopTimer.invalidate();
+        emit stopDurationChanged();
+    }
     emit finished(exitCode, exitStatus);
 }
 
@@ -501,6 +651,18 @@ QProcessBackend *QProcessFrontend::backend() const
     Only applicable under Linux.
 */
 
+/*!
+    \fn void QProcessFrontend::stopDurationChanged()
+    This signal is emitted when a stopped process has finished and
+    stopDuration has been updated.
+*/
+
+/*!
+    \fn void QProcessFrontend::statisticsChanged()
+    This signal is emitted when a new sample of the memory and CPU
+    figures differs from the last one.
+*/
+
 /*!
     Returns a human-readable description of the last device error that
     occurred.
@@ -44,7 +44,9 @@
 #define PROCESS_FRONTEND_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include "qprocessinfo.h"
+#include "qprocessstatistics.h"
 
 #include "qprocessmanager-global.h"
 
@@ -65,6 +67,14 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QProcessFrontend : public QObject
 
     Q_PROPERTY(qint64 pid READ pid NOTIFY started)
     Q_PROPERTY(qint64 startTime READ startTime NOTIFY started)
+    Q_PROPERTY(qint64 stopDuration READ stopDuration NOTIFY stopDurationChanged)
+
+    Q_PROPERTY(qint64 rss READ rss NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 pss READ pss NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 uss READ uss NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 swap READ swap NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 majorFaults READ majorFaults NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 cpuTime READ cpuTime NOTIFY statisticsChanged)
 
     Q_PROPERTY(int priority READ priority WRITE setPriority NOTIFY priorityChanged)
     Q_PROPERTY(int oomAdjustment READ oomAdjustment WRITE setOomAdjustment NOTIFY oomAdjustmentChanged)
@@ -98,8 +108,18 @@ public:
     qint64 write(const QByteArray& byteArray);
 
     qint64 startTime() const;
+    qint64 stopDuration() const;
+
+    QProcessStatistics statistics() const;
+    qint64 rss() const;
+    qint64 pss() const;
+    qint64 uss() const;
+    qint64 swap() const;
+    qint64 majorFaults() const;
+    qint64 cpuTime() const;
 
     Q_INVOKABLE QVariantMap processInfo() const;
+    Q_INVOKABLE QVariantMap resourceUsage() const;
 
     QString errorString() const;
 
@@ -116,6 +136,8 @@ signals:
 
     void priorityChanged();
     void oomAdjustmentChanged();
+    void stopDurationChanged();
+    void statisticsChanged();
 
 protected slots:
     void handleStarted();
@@ -131,11 +153,17 @@ private slots:
     void handleStandardOutput(const QByteArray&);
     void handleStandardError(const QByteArray&);
 
+private:
+    void setStatistics(const QProcessStatistics&);
+
 protected:
     qint64          m_startTimeSinceEpoch;
 
 private:
     QProcessBackend *m_backend;
+    QElapsedTimer    m_stopTimer;
+    qint64           m_stopDuration;
+    QProcessStatistics m_statistics;
 
     friend class QProcessManager;
 };
@@ -0,0 +1,332 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocessgroup.h"
+#include "qprocessfrontend.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+  \class QProcessGroup
+  \brief The QProcessGroup class controls a set of processes as one unit.
+  \inmodule QtProcessManager
+
+  A QProcessGroup holds a list of QProcessFrontend objects, usually
+  created from one QProcessInfo template with
+  QProcessManager::createGroup().  The group starts, stops and adjusts
+  the priority or OOM adjustment of all its processes in one call, and
+  reports aggregated completion:
+
+  \list
+  \li started() is emitted once every process that start() launched has
+      either started or failed to start.
+  \li finished() is emitted once every launched process has stopped again.
+  \endlist
+
+  The processes remain children of the QProcessManager; the group
+  does not own them, and drops them as they are destroyed.
+
+  All commands are issued from a single call, so backends that batch
+  their work see them together.  Processes of a remote factory, such
+  as QPipeProcessBackendFactory or QSocketProcessBackendFactory, are
+  started and stopped with a single "startMany" or "stopMany" message.
+*/
+
+/*!
+  \property QProcessGroup::size
+  \brief The number of processes in the group.
+ */
+
+/*!
+  \property QProcessGroup::runningCount
+  \brief The number of processes in the group that are running.
+ */
+
+/*!
+  \property QProcessGroup::failedCount
+  \brief The number of processes that failed to start since the group was created.
+ */
+
+/*!
+  Construct an empty QProcessGroup with optional \a parent.
+*/
+
+QProcessGroup::QProcessGroup(QObject *parent)
+    : QObject(parent)
+    , m_failed(0)
+    , m_startPending(false)
+    , m_active(false)
+{
+}
+
+/*!
+  Destroy the group.  The processes are not affected.
+*/
+
+QProcessGroup::~QProcessGroup()
+{
+}
+
+/*!
+  Add \a frontend to the group.
+*/
+
+void QProcessGroup::add(QProcessFrontend *frontend)
+{
+    if (!frontend || m_processes.contains(frontend))
+        return;
+
+    m_processes.append(frontend);
+    connect(frontend, SIGNAL(started()), SLOT(processStarted()));
+    connect(frontend, SIGNAL(error(QProcess::ProcessError)), SLOT(processError(QProcess::ProcessError)));
+    connect(frontend, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(processFinished()));
+    connect(frontend, SIGNAL(destroyed(QObject*)), SLOT(processDestroyed(QObject*)));
+    if (frontend->state() == QProcess::Running) {
+        m_running.insert(frontend);
+        emit runningCountChanged();
+    }
+    emit sizeChanged();
+}
+
+/*!
+  Return the processes in the group, in the order they were added.
+*/
+
+QList<QProcessFrontend *> QProcessGroup::processes() const
+{
+    return m_processes;
+}
+
+/*!
+  Return the process at \a index, or null if \a index is out of range.
+*/
+
+QProcessFrontend *QProcessGroup::at(int index) const
+{
+    return m_processes.value(index);
+}
+
+/*!
+  Return the number of processes in the group.
+*/
+
+int QProcessGroup::size() const
+{
+    return m_processes.size();
+}
+
+/*!
+  Return the number of running processes in the group.
+*/
+
+int QProcessGroup::runningCount() const
+{
+    return m_running.size();
+}
+
+/*!
+  Return the number of processes that failed to start.
+*/
+
+int QProcessGroup::failedCount() const
+{
+    return m_failed;
+}
+
+/*!
+  Start every process in the group that is not running.
+*/
+
+void QProcessGroup::start()
+{
+    QList<QProcessFrontend *> list;
+    foreach (QProcessFrontend *frontend, m_processes) {
+        if (frontend->state() == QProcess::NotRunning) {
+            m_starting.insert(frontend);
+            list << frontend;
+        }
+    }
+    if (list.isEmpty())
+        return;
+
+    m_startPending = true;
+    m_active = true;
+    foreach (QProcessFrontend *frontend, list)
+        frontend->start();
+}
+
+/*!
+  Stop every running or starting process in the group.  Each process
+  is given \a timeout milliseconds to exit before it is killed.
+*/
+
+void QProcessGroup::stop(int timeout)
+{
+    foreach (QProcessFrontend *frontend, m_processes)
+        if (frontend->state() != QProcess::NotRunning)
+            frontend->stop(timeout);
+}
+
+/*!
+  Set the \a priority of every process in the group.
+*/
+
+void QProcessGroup::setPriority(qint32 priority)
+{
+    foreach (QProcessFrontend *frontend, m_processes)
+        frontend->setPriority(priority);
+}
+
+/*!
+  Set the \a oomAdjustment of every process in the group.
+*/
+
+void QProcessGroup::setOomAdjustment(qint32 oomAdjustment)
+{
+    foreach (QProcessFrontend *frontend, m_processes)
+        frontend->setOomAdjustment(oomAdjustment);
+}
+
+/*
+  A process in the group has started
+ */
+
+void QProcessGroup::processStarted()
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    m_starting.remove(frontend);
+    if (!m_running.contains(frontend)) {
+        m_running.insert(frontend);
+        emit runningCountChanged();
+    }
+    checkStarted();
+}
+
+/*
+  A process in the group reported an error.  Only failures to start
+  change the aggregated state; other errors are followed by finished().
+ */
+
+void QProcessGroup::processError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
+        return;
+
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    m_starting.remove(frontend);
+    m_failed++;
+    emit failedCountChanged();
+    checkStarted();
+    checkFinished();
+}
+
+/*
+  A process in the group has finished
+ */
+
+void QProcessGroup::processFinished()
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    m_starting.remove(frontend);
+    if (m_running.remove(frontend))
+        emit runningCountChanged();
+    checkStarted();
+    checkFinished();
+}
+
+/*
+  A process in the group was destroyed.  The \a object is only used
+  as a key, because it is already partially destroyed.
+ */
+
+void QProcessGroup::processDestroyed(QObject *object)
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(object);
+    m_processes.removeAll(frontend);
+    m_starting.remove(frontend);
+    if (m_running.remove(frontend))
+        emit runningCountChanged();
+    emit sizeChanged();
+    checkStarted();
+    checkFinished();
+}
+
+void QProcessGroup::checkStarted()
+{
+    if (m_startPending && m_starting.isEmpty()) {
+        m_startPending = false;
+        emit started();
+    }
+}
+
+void QProcessGroup::checkFinished()
+{
+    if (m_active && m_starting.isEmpty() && m_running.isEmpty()) {
+        m_active = false;
+        emit finished();
+    }
+}
+
+/*!
+  \fn void QProcessGroup::started()
+  This signal is emitted when every process launched by start() has
+  either started or failed to start.
+ */
+/*!
+  \fn void QProcessGroup::finished()
+  This signal is emitted when every launched process has stopped.
+ */
+/*!
+  \fn void QProcessGroup::sizeChanged()
+  This signal is emitted when a process is added to or removed from the group.
+ */
+/*!
+  \fn void QProcessGroup::runningCountChanged()
+  This signal is emitted when the number of running processes changes.
+ */
+/*!
+  \fn void QProcessGroup::failedCountChanged()
+  This signal is emitted when a process fails to start.
+ */
+
+#include "moc_qprocessgroup.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PROCESS_GROUP_H
+#define PROCESS_GROUP_H
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QProcess>
+
+#include "qprocessmanager-global.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class QProcessFrontend;
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QProcessGroup : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int size READ size NOTIFY sizeChanged)
+    Q_PROPERTY(int runningCount READ runningCount NOTIFY runningCountChanged)
+    Q_PROPERTY(int failedCount READ failedCount NOTIFY failedCountChanged)
+
+public:
+    explicit QProcessGroup(QObject *parent = 0);
+    virtual ~QProcessGroup();
+
+    void add(QProcessFrontend *frontend);
+    QList<QProcessFrontend *> processes() const;
+    Q_INVOKABLE QProcessFrontend *at(int index) const;
+
+    int size() const;
+    int runningCount() const;
+    int failedCount() const;
+
+    Q_INVOKABLE void start();
+    Q_INVOKABLE void stop(int timeout = 500);
+    Q_INVOKABLE void setPriority(qint32 priority);
+    Q_INVOKABLE void setOomAdjustment(qint32 oomAdjustment);
+
+signals:
+    void started();
+    void finished();
+    void sizeChanged();
+    void runningCountChanged();
+    void failedCountChanged();
+
+private slots:
+    void processStarted();
+    void processError(QProcess::ProcessError);
+    void processFinished();
+    void processDestroyed(QObject *);
+
+private:
+    void checkStarted();
+    void checkFinished();
+
+private:
+    Q_DISABLE_COPY(QProcessGroup)
+    QList<QProcessFrontend *> m_processes;
+    QSet<QProcessFrontend *>  m_starting;
+    QSet<QProcessFrontend *>  m_running;
+    int                       m_failed;
+    bool                      m_startPending;
+    bool                      m_active;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PROCESS_GROUP_H
@@ -70,7 +70,22 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
       \li GID
       \li Priority
       \li OomAdjustment
+      \li StandardOutputFile
+      \li StandardErrorFile
+      \li OutputFlushInterval
+      \li OutputFlushSize
+      \li Cgroup
+      \li MemoryMax
+      \li MemoryHigh
+      \li CpuMax
+      \li CpuWeight
+      \li IoWeight
+      \li PidsMax
+      \li AccountingJournal
     \endlist
+
+    The resource limits are applied through a cgroup v2 subtree, as
+    described for QCgroup.
 */
 
 /*!
@@ -128,11 +143,71 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
     \brief the start output pattern is QByteArray of a line to match.
 */
 
+/*!
+    \property QProcessInfo::standardOutputFile
+    \brief the file that the standard output of the process is appended to.
+*/
+
+/*!
+    \property QProcessInfo::standardErrorFile
+    \brief the file that the standard error of the process is appended to.
+*/
+
+/*!
+    \property QProcessInfo::outputFlushInterval
+    \brief the longest time in milliseconds that output may be held back to coalesce it.
+*/
+
+/*!
+    \property QProcessInfo::outputFlushSize
+    \brief the amount of held output in bytes that is sent without waiting for the flush interval.
+*/
+
 /*!
     \property QProcessInfo::dropCapabilities
     \brief the capabilities that the process will drop after startup.
 */
 
+/*!
+    \property QProcessInfo::cgroup
+    \brief the name of a shared cgroup, relative to QCgroup::root(), that the process joins.
+*/
+
+/*!
+    \property QProcessInfo::memoryMax
+    \brief the hard memory limit of the process cgroup in bytes (\c{memory.max}).
+*/
+
+/*!
+    \property QProcessInfo::memoryHigh
+    \brief the memory level in bytes above which the process cgroup is throttled (\c{memory.high}).
+*/
+
+/*!
+    \property QProcessInfo::cpuMax
+    \brief the CPU bandwidth limit of the process cgroup, in percent of one CPU (\c{cpu.max}).
+*/
+
+/*!
+    \property QProcessInfo::cpuWeight
+    \brief the relative CPU weight of the process cgroup, from 1 to 10000 (\c{cpu.weight}).
+*/
+
+/*!
+    \property QProcessInfo::ioWeight
+    \brief the relative I/O weight of the process cgroup, from 1 to 10000 (\c{io.weight}).
+*/
+
+/*!
+    \property QProcessInfo::pidsMax
+    \brief the maximum number of tasks in the process cgroup (\c{pids.max}).
+*/
+
+/*!
+    \property QProcessInfo::accountingJournal
+    \brief the file that receives a QProcessJournal record when the process exits.
+*/
+
 /*!
     Constructs a QProcessInfo instance with optional \a parent.
 */
@@ -441,6 +516,253 @@ void QProcessInfo::setStartOutputPattern(const QByteArray &outputPattern)
     setValue(QProcessInfoConstants::StartOutputPattern, outputPattern);
 }
 
+/*!
+    Returns the file that standard output is redirected to.
+
+    \sa setStandardOutputFile
+*/
+QString QProcessInfo::standardOutputFile() const
+{
+    return m_info.value(QProcessInfoConstants::StandardOutputFile).toString();
+}
+
+/*!
+    Redirect the standard output of the process to \a fileName.  The file
+    is created if needed and output is appended to it.
+
+    Redirected output never passes through the process manager, so the
+    standardOutput() signal of the process frontend is not emitted.  For
+    processes started by a fork launcher, the child writes directly into
+    the file and the launcher does not copy any of the data.
+*/
+void QProcessInfo::setStandardOutputFile(const QString &fileName)
+{
+    setValue(QProcessInfoConstants::StandardOutputFile, fileName);
+}
+
+/*!
+    Returns the file that standard error is redirected to.
+
+    \sa setStandardErrorFile
+*/
+QString QProcessInfo::standardErrorFile() const
+{
+    return m_info.value(QProcessInfoConstants::StandardErrorFile).toString();
+}
+
+/*!
+    Redirect the standard error of the process to \a fileName.  This
+    works in the same way as setStandardOutputFile().
+*/
+void QProcessInfo::setStandardErrorFile(const QString &fileName)
+{
+    setValue(QProcessInfoConstants::StandardErrorFile, fileName);
+}
+
+/*!
+    Returns the output flush interval in milliseconds.
+
+    \sa setOutputFlushInterval
+*/
+int QProcessInfo::outputFlushInterval() const
+{
+    return m_info.value(QProcessInfoConstants::OutputFlushInterval).toInt();
+}
+
+/*!
+    Set the output flush interval to \a interval milliseconds.
+
+    Processes started by a fork launcher normally forward each chunk of
+    output as soon as it is read.  With a flush interval set, output is
+    collected and sent as a single message once the oldest unsent byte
+    is \a interval milliseconds old (or once outputFlushSize bytes have
+    been collected).  This bounds the added latency while cutting the
+    number of messages for chatty processes.  A value of 0 (the default)
+    disables coalescing.
+*/
+void QProcessInfo::setOutputFlushInterval(int interval)
+{
+    setValue(QProcessInfoConstants::OutputFlushInterval, interval);
+}
+
+/*!
+    Returns the output flush size in bytes.
+
+    \sa setOutputFlushSize
+*/
+int QProcessInfo::outputFlushSize() const
+{
+    return m_info.value(QProcessInfoConstants::OutputFlushSize).toInt();
+}
+
+/*!
+    Set the output flush size to \a size bytes.  Coalesced output is
+    sent as soon as this much has been collected, without waiting for the
+    outputFlushInterval to expire.  A value of 0 means no size limit.
+*/
+void QProcessInfo::setOutputFlushSize(int size)
+{
+    setValue(QProcessInfoConstants::OutputFlushSize, size);
+}
+
+/*!
+    Returns the name of the shared cgroup the process joins.
+
+    \sa setCgroup
+*/
+QString QProcessInfo::cgroup() const
+{
+    return m_info.value(QProcessInfoConstants::Cgroup).toString();
+}
+
+/*!
+    Set the shared cgroup to \a cgroup, a path relative to QCgroup::root().
+    Every process with the same cgroup is placed in the same cgroup and
+    shares its resource limits; the cgroup is created if it does not
+    exist and is left in place when the processes exit.  Without a
+    cgroup, a process that has resource limits gets a cgroup of its own.
+*/
+void QProcessInfo::setCgroup(const QString &cgroup)
+{
+    setValue(QProcessInfoConstants::Cgroup, cgroup);
+}
+
+/*!
+    Returns the hard memory limit in bytes.
+
+    \sa setMemoryMax
+*/
+qint64 QProcessInfo::memoryMax() const
+{
+    return m_info.value(QProcessInfoConstants::MemoryMax).toLongLong();
+}
+
+/*!
+    Set the hard memory limit of the process cgroup to \a bytes.  The
+    kernel OOM-kills the process when it cannot reclaim memory below
+    this limit.  A negative value removes the limit.
+*/
+void QProcessInfo::setMemoryMax(qint64 bytes)
+{
+    setValue(QProcessInfoConstants::MemoryMax, bytes);
+}
+
+/*!
+    Returns the memory throttling level in bytes.
+
+    \sa setMemoryHigh
+*/
+qint64 QProcessInfo::memoryHigh() const
+{
+    return m_info.value(QProcessInfoConstants::MemoryHigh).toLongLong();
+}
+
+/*!
+    Set the memory throttling level of the process cgroup to \a bytes.
+    Above this level the process is slowed down and its memory is
+    reclaimed aggressively, but it is not killed.  A negative value
+    removes the limit.
+*/
+void QProcessInfo::setMemoryHigh(qint64 bytes)
+{
+    setValue(QProcessInfoConstants::MemoryHigh, bytes);
+}
+
+/*!
+    Returns the CPU bandwidth limit in percent of one CPU.
+
+    \sa setCpuMax
+*/
+int QProcessInfo::cpuMax() const
+{
+    return m_info.value(QProcessInfoConstants::CpuMax).toInt();
+}
+
+/*!
+    Set the CPU bandwidth limit of the process cgroup to \a percent of
+    one CPU; 200 allows two full CPUs.  A negative value removes the limit.
+*/
+void QProcessInfo::setCpuMax(int percent)
+{
+    setValue(QProcessInfoConstants::CpuMax, percent);
+}
+
+/*!
+    Returns the relative CPU weight.
+
+    \sa setCpuWeight
+*/
+int QProcessInfo::cpuWeight() const
+{
+    return m_info.value(QProcessInfoConstants::CpuWeight).toInt();
+}
+
+/*!
+    Set the relative CPU weight of the process cgroup to \a weight.
+    The kernel default is 100.
+*/
+void QProcessInfo::setCpuWeight(int weight)
+{
+    setValue(QProcessInfoConstants::CpuWeight, weight);
+}
+
+/*!
+    Returns the relative I/O weight.
+
+    \sa setIoWeight
+*/
+int QProcessInfo::ioWeight() const
+{
+    return m_info.value(QProcessInfoConstants::IoWeight).toInt();
+}
+
+/*!
+    Set the relative I/O weight of the process cgroup to \a weight.
+    The kernel default is 100.
+*/
+void QProcessInfo::setIoWeight(int weight)
+{
+    setValue(QProcessInfoConstants::IoWeight, weight);
+}
+
+/*!
+    Returns the maximum number of tasks.
+
+    \sa setPidsMax
+*/
+int QProcessInfo::pidsMax() const
+{
+    return m_info.value(QProcessInfoConstants::PidsMax).toInt();
+}
+
+/*!
+    Set the maximum number of processes and threads in the process
+    cgroup to \a count.  A negative value removes the limit.
+*/
+void QProcessInfo::setPidsMax(int count)
+{
+    setValue(QProcessInfoConstants::PidsMax, count);
+}
+
+/*!
+    Returns the name of the accounting journal file.
+
+    \sa setAccountingJournal
+*/
+QString QProcessInfo::accountingJournal() const
+{
+    return m_info.value(QProcessInfoConstants::AccountingJournal).toString();
+}
+
+/*!
+    Append a QProcessJournal record to \a fileName when the process
+    exits.  Processes may share a journal.
+*/
+void QProcessInfo::setAccountingJournal(const QString &fileName)
+{
+    setValue(QProcessInfoConstants::AccountingJournal, fileName);
+}
+
 /*!
     Returns the keys for which values have been set in this QProcessInfo object.
 */
@@ -483,6 +805,16 @@ void QProcessInfo::setValue(const QString &key, const QVariant &value)
     }
 }
 
+/*!
+    Remove \a key and emit appropriate change signals
+*/
+
+void QProcessInfo::remove(const QString &key)
+{
+    if (m_info.remove(key))
+        emitChangeSignal(key);
+}
+
 /*!
     Sets the data provided by this QProcessInfo object to \a data.
 
@@ -546,6 +878,30 @@ void QProcessInfo::emitChangeSignal(const QString &key)
         emit oomAdjustmentChanged();
     } else if (key == QProcessInfoConstants::StartOutputPattern) {
         emit startOutputPatternChanged();
+    } else if (key == QProcessInfoConstants::StandardOutputFile) {
+        emit standardOutputFileChanged();
+    } else if (key == QProcessInfoConstants::StandardErrorFile) {
+        emit standardErrorFileChanged();
+    } else if (key == QProcessInfoConstants::OutputFlushInterval) {
+        emit outputFlushIntervalChanged();
+    } else if (key == QProcessInfoConstants::OutputFlushSize) {
+        emit outputFlushSizeChanged();
+    } else if (key == QProcessInfoConstants::Cgroup) {
+        emit cgroupChanged();
+    } else if (key == QProcessInfoConstants::MemoryMax) {
+        emit memoryMaxChanged();
+    } else if (key == QProcessInfoConstants::MemoryHigh) {
+        emit memoryHighChanged();
+    } else if (key == QProcessInfoConstants::CpuMax) {
+        emit cpuMaxChanged();
+    } else if (key == QProcessInfoConstants::CpuWeight) {
+        emit cpuWeightChanged();
+    } else if (key == QProcessInfoConstants::IoWeight) {
+        emit ioWeightChanged();
+    } else if (key == QProcessInfoConstants::PidsMax) {
+        emit pidsMaxChanged();
+    } else if (key == QProcessInfoConstants::AccountingJournal) {
+        emit accountingJournalChanged();
     }
 }
 
@@ -604,6 +960,54 @@ void QProcessInfo::insertEnvironment(const QVariantMap &newEnvironment)
     \fn void QProcessInfo::startOutputPatternChanged()
     This signal is emitted when the startOutputPattern has been changed.
 */
+/*!
+    \fn void QProcessInfo::standardOutputFileChanged()
+    This signal is emitted when the standard output file has been changed
+*/
+/*!
+    \fn void QProcessInfo::standardErrorFileChanged()
+    This signal is emitted when the standard error file has been changed
+*/
+/*!
+    \fn void QProcessInfo::outputFlushIntervalChanged()
+    This signal is emitted when the output flush interval has been changed
+*/
+/*!
+    \fn void QProcessInfo::outputFlushSizeChanged()
+    This signal is emitted when the output flush size has been changed
+*/
+/*!
+    \fn void QProcessInfo::cgroupChanged()
+    This signal is emitted when the cgroup has been changed
+*/
+/*!
+    \fn void QProcessInfo::memoryMaxChanged()
+    This signal is emitted when the memory limit has been changed
+*/
+/*!
+    \fn void QProcessInfo::memoryHighChanged()
+    This signal is emitted when the memory throttling level has been changed
+*/
+/*!
+    \fn void QProcessInfo::cpuMaxChanged()
+    This signal is emitted when the CPU bandwidth limit has been changed
+*/
+/*!
+    \fn void QProcessInfo::cpuWeightChanged()
+    This signal is emitted when the CPU weight has been changed
+*/
+/*!
+    \fn void QProcessInfo::ioWeightChanged()
+    This signal is emitted when the I/O weight has been changed
+*/
+/*!
+    \fn void QProcessInfo::pidsMaxChanged()
+    This signal is emitted when the task limit has been changed
+*/
+/*!
+    \fn void QProcessInfo::accountingJournalChanged()
+    This signal is emitted when the accounting journal has been changed
+*/
 
 #include "moc_qprocessinfo.cpp"
 
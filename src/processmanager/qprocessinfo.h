@@ -64,6 +64,18 @@ const QLatin1String DropCapabilities = QLatin1String("dropCapabilities");
 const QLatin1String Priority = QLatin1String("priority");
 const QLatin1String OomAdjustment = QLatin1String("oomAdjustment");
 const QLatin1String StartOutputPattern = QLatin1String("startOutputPattern");
+const QLatin1String StandardOutputFile = QLatin1String("standardOutputFile");
+const QLatin1String StandardErrorFile = QLatin1String("standardErrorFile");
+const QLatin1String OutputFlushInterval = QLatin1String("outputFlushInterval");
+const QLatin1String OutputFlushSize = QLatin1String("outputFlushSize");
+const QLatin1String Cgroup = QLatin1String("cgroup");
+const QLatin1String MemoryMax = QLatin1String("memoryMax");
+const QLatin1String MemoryHigh = QLatin1String("memoryHigh");
+const QLatin1String CpuMax = QLatin1String("cpuMax");
+const QLatin1String CpuWeight = QLatin1String("cpuWeight");
+const QLatin1String IoWeight = QLatin1String("ioWeight");
+const QLatin1String PidsMax = QLatin1String("pidsMax");
+const QLatin1String AccountingJournal = QLatin1String("accountingJournal");
 }
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QProcessInfo : public QObject
@@ -81,6 +93,18 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QProcessInfo : public QObject
     Q_PROPERTY(int priority READ priority WRITE setPriority NOTIFY priorityChanged)
     Q_PROPERTY(int oomAdjustment READ oomAdjustment WRITE setOomAdjustment NOTIFY oomAdjustmentChanged)
     Q_PROPERTY(QByteArray startOutputPattern READ startOutputPattern WRITE setStartOutputPattern NOTIFY startOutputPatternChanged)
+    Q_PROPERTY(QString standardOutputFile READ standardOutputFile WRITE setStandardOutputFile NOTIFY standardOutputFileChanged)
+    Q_PROPERTY(QString standardErrorFile READ standardErrorFile WRITE setStandardErrorFile NOTIFY standardErrorFileChanged)
+    Q_PROPERTY(int outputFlushInterval READ outputFlushInterval WRITE setOutputFlushInterval NOTIFY outputFlushIntervalChanged)
+    Q_PROPERTY(int outputFlushSize READ outputFlushSize WRITE setOutputFlushSize NOTIFY outputFlushSizeChanged)
+    Q_PROPERTY(QString cgroup READ cgroup WRITE setCgroup NOTIFY cgroupChanged)
+    Q_PROPERTY(qint64 memoryMax READ memoryMax WRITE setMemoryMax NOTIFY memoryMaxChanged)
+    Q_PROPERTY(qint64 memoryHigh READ memoryHigh WRITE setMemoryHigh NOTIFY memoryHighChanged)
+    Q_PROPERTY(int cpuMax READ cpuMax WRITE setCpuMax NOTIFY cpuMaxChanged)
+    Q_PROPERTY(int cpuWeight READ cpuWeight WRITE setCpuWeight NOTIFY cpuWeightChanged)
+    Q_PROPERTY(int ioWeight READ ioWeight WRITE setIoWeight NOTIFY ioWeightChanged)
+    Q_PROPERTY(int pidsMax READ pidsMax WRITE setPidsMax NOTIFY pidsMaxChanged)
+    Q_PROPERTY(QString accountingJournal READ accountingJournal WRITE setAccountingJournal NOTIFY accountingJournalChanged)
 public:
     explicit QProcessInfo(QObject *parent = 0);
     QProcessInfo(const QProcessInfo &other);
@@ -125,10 +149,47 @@ public:
     QByteArray startOutputPattern() const;
     void setStartOutputPattern(const QByteArray &outputPattern);
 
+    QString standardOutputFile() const;
+    void setStandardOutputFile(const QString &fileName);
+
+    QString standardErrorFile() const;
+    void setStandardErrorFile(const QString &fileName);
+
+    int outputFlushInterval() const;
+    void setOutputFlushInterval(int interval);
+
+    int outputFlushSize() const;
+    void setOutputFlushSize(int size);
+
+    QString cgroup() const;
+    void setCgroup(const QString &cgroup);
+
+    qint64 memoryMax() const;
+    void setMemoryMax(qint64 bytes);
+
+    qint64 memoryHigh() const;
+    void setMemoryHigh(qint64 bytes);
+
+    int cpuMax() const;
+    void setCpuMax(int percent);
+
+    int cpuWeight() const;
+    void setCpuWeight(int weight);
+
+    int ioWeight() const;
+    void setIoWeight(int weight);
+
+    int pidsMax() const;
+    void setPidsMax(int count);
+
+    QString accountingJournal() const;
+    void setAccountingJournal(const QString &fileName);
+
     Q_INVOKABLE QStringList keys() const;
     Q_INVOKABLE bool contains(const QString &key) const;
     Q_INVOKABLE QVariant value(const QString &key) const;
     Q_INVOKABLE void setValue(const QString &key, const QVariant &value);
+    Q_INVOKABLE void remove(const QString &key);
     Q_INVOKABLE void setData(const QVariantMap &data);
     Q_INVOKABLE void insert(const QVariantMap &data);
     QVariantMap toMap() const;
@@ -146,6 +207,18 @@ signals:
     void priorityChanged();
     void oomAdjustmentChanged();
     void startOutputPatternChanged();
+    void standardOutputFileChanged();
+    void standardErrorFileChanged();
+    void outputFlushIntervalChanged();
+    void outputFlushSizeChanged();
+    void cgroupChanged();
+    void memoryMaxChanged();
+    void memoryHighChanged();
+    void cpuMaxChanged();
+    void cpuWeightChanged();
+    void ioWeightChanged();
+    void pidsMaxChanged();
+    void accountingJournalChanged();
 
 public slots:
 
@@ -0,0 +1,351 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocessjournal.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+  \class QProcessJournal
+  \brief The QProcessJournal class appends and reads process accounting records
+  \inmodule QtProcessManager
+
+  When a process that has a QProcessInfo::accountingJournal exits,
+  one QProcessJournal::Record is appended to the journal file.  The
+  record is filled in at the point the process is reaped:
+  QUnixProcessBackend and the qForkLauncher() parent process both
+  write to the journal directly, so no sampling is needed to collect
+  it.
+
+  Every record is kRecordSize bytes long, in little endian order, and
+  starts with kMagic and kVersion.  A record goes to the file in a
+  single write on a descriptor opened with \c{O_APPEND}, so several
+  processes (for example, a manager and its fork launchers) may share
+  one journal.  Because the records have a fixed size, a reader that
+  remembers count() can pick up new records later by passing it as
+  the first record to read().
+
+  \code
+  QList<QProcessJournal::Record> records = journal.read(m_seen);
+  m_seen += records.size();
+  foreach (const QProcessJournal::Record& record, records)
+      qDebug() << record.name << record.wallTime << record.maxRss;
+  \endcode
+
+  Values that could not be measured are -1.
+ */
+
+/*!
+  \class QProcessJournal::Record
+  \brief The accounting record of one process
+
+  \list
+  \li \c pid, \c exitCode and \c exitStatus describe how the process ended.
+  \li \c finishedAt is when the process was reaped, in milliseconds since the epoch.
+  \li \c wallTime is the time from the start request to exit, and
+      \c startupTime the time from the start request to the started()
+      signal, both in milliseconds.
+  \li \c userTime and \c systemTime are CPU time in microseconds.
+  \li \c maxRss is the peak resident set size in bytes.
+  \li \c voluntarySwitches and \c involuntarySwitches count context switches.
+  \li \c readBytes and \c writtenBytes count block device I/O.
+  \li \c name is the identifier or program of the process, truncated
+      to kNameSize bytes of UTF-8.
+  \endlist
+ */
+
+/*!
+  Construct an invalid record with every measurement set to -1
+ */
+
+QProcessJournal::Record::Record()
+    : pid(0)
+    , exitCode(0)
+    , exitStatus(0)
+    , finishedAt(-1)
+    , wallTime(-1)
+    , startupTime(-1)
+    , userTime(-1)
+    , systemTime(-1)
+    , maxRss(-1)
+    , voluntarySwitches(-1)
+    , involuntarySwitches(-1)
+    , readBytes(-1)
+    , writtenBytes(-1)
+{
+}
+
+/*!
+  \fn bool QProcessJournal::Record::isValid() const
+  Return true if the record belongs to a process
+ */
+
+/*!
+  Return the record as a QVariantMap keyed by the field names
+ */
+
+QVariantMap QProcessJournal::Record::toMap() const
+{
+    QVariantMap map;
+    map.insert(QStringLiteral("pid"), pid);
+    map.insert(QStringLiteral("name"), name);
+    map.insert(QStringLiteral("exitCode"), exitCode);
+    map.insert(QStringLiteral("exitStatus"), exitStatus);
+    map.insert(QStringLiteral("finishedAt"), finishedAt);
+    map.insert(QStringLiteral("wallTime"), wallTime);
+    map.insert(QStringLiteral("startupTime"), startupTime);
+    map.insert(QStringLiteral("userTime"), userTime);
+    map.insert(QStringLiteral("systemTime"), systemTime);
+    map.insert(QStringLiteral("maxRss"), maxRss);
+    map.insert(QStringLiteral("voluntarySwitches"), voluntarySwitches);
+    map.insert(QStringLiteral("involuntarySwitches"), involuntarySwitches);
+    map.insert(QStringLiteral("readBytes"), readBytes);
+    map.insert(QStringLiteral("writtenBytes"), writtenBytes);
+    return map;
+}
+
+/*!
+  Construct a QProcessJournal on \a fileName.  The file is not opened
+  until the first append().
+ */
+
+QProcessJournal::QProcessJournal(const QString& fileName)
+    : m_fileName(fileName)
+    , m_fd(-1)
+{
+}
+
+/*!
+  Close the journal
+ */
+
+QProcessJournal::~QProcessJournal()
+{
+    close();
+}
+
+/*!
+  Return the name of the journal file
+ */
+
+QString QProcessJournal::fileName() const
+{
+    return m_fileName;
+}
+
+/*!
+  Switch the journal to \a fileName
+ */
+
+void QProcessJournal::setFileName(const QString& fileName)
+{
+    if (fileName != m_fileName) {
+        close();
+        m_fileName = fileName;
+    }
+}
+
+void QProcessJournal::close()
+{
+    if (m_fd != -1)
+        ::close(m_fd);
+    m_fd = -1;
+}
+
+/*!
+  Append \a record to the end of the journal, creating the file if
+  needed.  Return false if the record could not be written.
+ */
+
+bool QProcessJournal::append(const Record& record)
+{
+    if (m_fd == -1) {
+        if (m_fileName.isEmpty())
+            return false;
+        m_fd = ::open(QFile::encodeName(m_fileName).constData(),
+                      O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd == -1) {
+            qWarning("Unable to open journal %s: %s", qPrintable(m_fileName), strerror(errno));
+            return false;
+        }
+    }
+
+    QByteArray data = encode(record);
+    ssize_t n;
+    do {
+        n = ::write(m_fd, data.constData(), data.size());
+    } while (n == -1 && errno == EINTR);
+    if (n != data.size()) {
+        qWarning("Unable to write journal %s: %s", qPrintable(m_fileName),
+                 n == -1 ? strerror(errno) : "short write");
+        return false;
+    }
+    return true;
+}
+
+/*!
+  Return the number of complete records in the journal
+ */
+
+int QProcessJournal::count() const
+{
+    QFile file(m_fileName);
+    return file.size() / kRecordSize;
+}
+
+/*!
+  Read up to \a count records, starting with record number \a first.
+  A negative \a count reads to the end of the journal.  A damaged
+  record is returned as an invalid Record, so the position of every
+  record in the list still matches its position in the journal.
+ */
+
+QList<QProcessJournal::Record> QProcessJournal::read(int first, int count) const
+{
+    QList<Record> result;
+    QFile file(m_fileName);
+    if (first < 0 || !file.open(QIODevice::ReadOnly))
+        return result;
+
+    qint64 available = file.size() / kRecordSize - first;
+    if (count < 0 || count > available)
+        count = available;
+    if (count <= 0 || !file.seek(qint64(first) * kRecordSize))
+        return result;
+
+    QByteArray data = file.read(qint64(count) * kRecordSize);
+    for (int offset = 0 ; offset + kRecordSize <= data.size() ; offset += kRecordSize) {
+        Record record;
+        if (!decode(data.constData() + offset, kRecordSize, record)) {
+            qWarning("Damaged record %d in journal %s",
+                     first + offset / kRecordSize, qPrintable(m_fileName));
+            record = Record();
+        }
+        result << record;
+    }
+    return result;
+}
+
+/*
+  Record layout:
+
+    0   magic             u32
+    4   version           u16
+    6   record size       u16
+    8   pid               i32
+   12   exit code         i32
+   16   exit status       i32
+   20   (reserved)        i32
+   24   finishedAt ... writtenBytes, ten i64 values
+  104   name              kNameSize bytes, zero padded
+ */
+
+static const int kNameOffset = 104;
+
+/*!
+  Return \a record in its kRecordSize byte form
+ */
+
+QByteArray QProcessJournal::encode(const Record& record)
+{
+    QByteArray data(kRecordSize, '\0');
+    uchar *p = reinterpret_cast<uchar *>(data.data());
+    qToLittleEndian<quint32>(kMagic, p);
+    qToLittleEndian<quint16>(kVersion, p + 4);
+    qToLittleEndian<quint16>(kRecordSize, p + 6);
+    qToLittleEndian<qint32>(record.pid, p + 8);
+    qToLittleEndian<qint32>(record.exitCode, p + 12);
+    qToLittleEndian<qint32>(record.exitStatus, p + 16);
+
+    const qint64 values[] = { record.finishedAt, record.wallTime, record.startupTime,
+                              record.userTime, record.systemTime, record.maxRss,
+                              record.voluntarySwitches, record.involuntarySwitches,
+                              record.readBytes, record.writtenBytes };
+    for (int i = 0 ; i < 10 ; i++)
+        qToLittleEndian<qint64>(values[i], p + 24 + i * 8);
+
+    // Don't cut a UTF-8 sequence in half
+    QByteArray name = record.name.toUtf8();
+    int size = qMin(name.size(), int(kNameSize));
+    if (size < name.size())
+        while (size > 0 && (uchar(name.at(size)) & 0xc0) == 0x80)
+            size--;
+    memcpy(p + kNameOffset, name.constData(), size);
+    return data;
+}
+
+/*!
+  Decode \a size bytes of \a data into \a record.  Return false if the
+  data doesn't hold a journal record.
+ */
+
+bool QProcessJournal::decode(const char *data, int size, Record& record)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    if (size < kRecordSize || qFromLittleEndian<quint32>(p) != kMagic
+        || qFromLittleEndian<quint16>(p + 6) != kRecordSize)
+        return false;
+
+    record.pid        = qFromLittleEndian<qint32>(p + 8);
+    record.exitCode   = qFromLittleEndian<qint32>(p + 12);
+    record.exitStatus = qFromLittleEndian<qint32>(p + 16);
+
+    qint64 *values[] = { &record.finishedAt, &record.wallTime, &record.startupTime,
+                         &record.userTime, &record.systemTime, &record.maxRss,
+                         &record.voluntarySwitches, &record.involuntarySwitches,
+                         &record.readBytes, &record.writtenBytes };
+    for (int i = 0 ; i < 10 ; i++)
+        *values[i] = qFromLittleEndian<qint64>(p + 24 + i * 8);
+
+    const char *name = data + kNameOffset;
+    record.name = QString::fromUtf8(name, qstrnlen(name, kNameSize));
+    return true;
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PROCESS_JOURNAL_H
+#define PROCESS_JOURNAL_H
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+#include "qprocessmanager-global.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QProcessJournal
+{
+public:
+    struct Record {
+        Record();
+        bool        isValid() const { return pid > 0; }
+        QVariantMap toMap() const;
+
+        qint32  pid;
+        qint32  exitCode;
+        qint32  exitStatus;           // QProcess::ExitStatus
+        qint64  finishedAt;           // Milliseconds since the epoch
+        qint64  wallTime;             // Milliseconds from start to exit
+        qint64  startupTime;          // Milliseconds from start to started
+        qint64  userTime;             // Microseconds
+        qint64  systemTime;           // Microseconds
+        qint64  maxRss;               // Bytes
+        qint64  voluntarySwitches;
+        qint64  involuntarySwitches;
+        qint64  readBytes;
+        qint64  writtenBytes;
+        QString name;
+    };
+
+    static const int     kRecordSize = 128;
+    static const int     kNameSize = 24;
+    static const quint32 kMagic = 0x4a4d5051;  // "QPMJ" in little endian order
+    static const quint16 kVersion = 1;
+
+    explicit QProcessJournal(const QString& fileName = QString());
+    ~QProcessJournal();
+
+    QString fileName() const;
+    void    setFileName(const QString& fileName);
+
+    bool append(const Record& record);
+    int  count() const;
+    QList<Record> read(int first = 0, int count = -1) const;
+
+    static QByteArray encode(const Record& record);
+    static bool       decode(const char *data, int size, Record& record);
+
+private:
+    Q_DISABLE_COPY(QProcessJournal)
+    void close();
+
+    QString m_fileName;
+    int     m_fd;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PROCESS_JOURNAL_H
@@ -44,6 +44,8 @@
 #include "qprocessbackendfactory.h"
 #include "qprocessbackendmanager.h"
 #include "qprocessbackend.h"
+#include "qprocessgroup.h"
+#include "qprocessevents.h"
 
 #include <QDebug>
 
@@ -53,6 +55,11 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
   \class QProcessManager
   \brief The QProcessManager class encapsulates ways of creating and tracking processes.
   \inmodule QtProcessManager
+
+  The process manager keeps hash indices of its processes by name, by
+  identifier and by the pid of running processes.  The indices are
+  updated as processes start, stop and are destroyed, so looking up a
+  process does not get slower as processes accumulate.
 */
 
 /*!
@@ -71,11 +78,13 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 QProcessManager::QProcessManager(QObject *parent)
     : QObject(parent)
+    , m_events(0)
 {
     m_backend = new QProcessBackendManager(this);
     connect(m_backend, SIGNAL(internalProcessesChanged()), SIGNAL(internalProcessesChanged()));
     connect(m_backend, SIGNAL(internalProcessError(QProcess::ProcessError)),
             SIGNAL(internalProcessError(QProcess::ProcessError)));
+    connect(&m_samplingTimer, SIGNAL(timeout()), SLOT(sampleStatistics()));
 }
 
 /*!
@@ -100,6 +109,17 @@ QProcessFrontend *QProcessManager::create(const QProcessInfo& info)
     QProcessFrontend *frontend = createFrontend(backend);
     frontend->setParent(this);
     m_processlist.append(frontend);
+
+    FrontendKeys& keys = m_frontendKeys[frontend];
+    keys.name = frontend->name();
+    keys.identifier = frontend->identifier();
+    m_nameIndex.insert(keys.name, frontend);
+    m_identifierIndex.insert(keys.identifier, frontend);
+    connect(frontend, SIGNAL(started()), SLOT(indexFrontendStarted()));
+    connect(frontend, SIGNAL(stateChanged(QProcess::ProcessState)),
+            SLOT(indexFrontendStateChanged(QProcess::ProcessState)));
+    connect(frontend, SIGNAL(destroyed(QObject*)), SLOT(indexFrontendDestroyed(QObject*)));
+
     connect(frontend, SIGNAL(aboutToStart()), SLOT(processFrontendAboutToStart()));
     connect(frontend, SIGNAL(aboutToStop()), SLOT(processFrontendAboutToStop()));
     connect(frontend, SIGNAL(started()), SLOT(processFrontendStarted()));
@@ -109,6 +129,7 @@ QProcessFrontend *QProcessManager::create(const QProcessInfo& info)
     connect(frontend, SIGNAL(stateChanged(QProcess::ProcessState)),
             SLOT(processFrontendStateChanged(QProcess::ProcessState)));
     connect(frontend, SIGNAL(destroyed()), SLOT(processFrontendDestroyed()));
+    connect(frontend, SIGNAL(statisticsChanged()), SLOT(processFrontendStatisticsChanged()));
     return frontend;
 }
 
@@ -122,6 +143,44 @@ QProcessFrontend *QProcessManager::create(const QVariantMap& info)
     return create(QProcessInfo(info));
 }
 
+/*!
+  Create a QProcessGroup of \a count processes, all based on the
+  template \a info.  The group is a child of the process manager and
+  can start, stop and adjust all of its processes in one operation.
+
+  Returns NULL if any of the processes could not be created; the
+  processes that were created are deleted again.
+*/
+
+QProcessGroup *QProcessManager::createGroup(const QProcessInfo& info, int count)
+{
+    if (count <= 0)
+        return NULL;
+
+    QProcessGroup *group = new QProcessGroup(this);
+    for (int i = 0 ; i < count ; i++) {
+        QProcessFrontend *frontend = create(info);
+        if (!frontend) {
+            qWarning("Unable to create process %d of %d for group", i + 1, count);
+            qDeleteAll(group->processes());
+            delete group;
+            return NULL;
+        }
+        group->add(frontend);
+    }
+    return group;
+}
+
+/*!
+  Create a QProcessGroup of \a count processes based on QVariantMap
+  \a info (which should look a lot like QProcessInfo).
+*/
+
+QProcessGroup *QProcessManager::createGroup(const QVariantMap& info, int count)
+{
+    return createGroup(QProcessInfo(info), count);
+}
+
 /*!
   Create a new QProcessFrontend for a \a backend.
   Override this function if you need to subclass QProcessFrontend to
@@ -142,27 +201,34 @@ QProcessFrontend *QProcessManager::createFrontend(QProcessBackend *backend)
 */
 QProcessFrontend *QProcessManager::processForName(const QString &name) const
 {
-    foreach (QProcessFrontend *frontend, m_processlist)
-    if (frontend->name() == name)
-        return frontend;
-    return NULL;
+    return m_nameIndex.value(name);
 }
 
 /*!
     Returns a process that matches the process id \a pid. Returns NULL if no such process was found.
     Returns NULL if \a pid is 0.
-    If more than one process matches the same ID, this method will return the first one find.
+    Only running processes are found.
 */
 
 QProcessFrontend *QProcessManager::processForPID(qint64 pid) const
 {
     if (!pid)
         return NULL;
+    return m_pidIndex.value(pid);
+}
 
-    foreach (QProcessFrontend *frontend, m_processlist)
-    if (frontend->pid() == pid)
-        return frontend;
-    return NULL;
+/*!
+    Returns the processes created with the identifier \a identifier, in
+    the order they were created.
+*/
+
+QList<QObject *> QProcessManager::processesForIdentifier(const QString &identifier) const
+{
+    QList<QObject *> result;
+    QList<QProcessFrontend *> frontends = m_identifierIndex.values(identifier);
+    for (int i = frontends.size() - 1 ; i >= 0 ; i--)   // QMultiHash returns the newest first
+        result << frontends.at(i);
+    return result;
 }
 
 /*!
@@ -190,8 +256,9 @@ void QProcessManager::addBackendFactory(QProcessBackendFactory *factory)
 QStringList QProcessManager::names() const
 {
     QStringList result;
+    result.reserve(m_processlist.size());
     foreach (QProcessFrontend *frontend, m_processlist)
-        result << frontend->name();
+        result << m_frontendKeys.value(frontend).name;
     return result;
 }
 
@@ -243,6 +310,73 @@ QIdleDelegate * QProcessManager::idleDelegate() const
     return m_backend->idleDelegate();
 }
 
+/*!
+  Return the process event source, if any.
+*/
+
+QProcessEvents *QProcessManager::processEvents() const
+{
+    return m_events;
+}
+
+/*!
+  Set the process event source to \a events and start it.  The
+  QProcessManager takes ownership and deletes any previous source.
+  Every running process is watched, and the descendantStarted() and
+  descendantFinished() signals report the helpers it forks.  The tree
+  of a process stays watched after the process finishes, until its
+  last descendant has exited or the frontend is destroyed.
+*/
+
+void QProcessManager::setProcessEvents(QProcessEvents *events)
+{
+    if (events == m_events)
+        return;
+    delete m_events;
+    m_events = events;
+    m_watchedRoots.clear();
+    if (m_events) {
+        m_events->setParent(this);
+        connect(m_events, SIGNAL(forked(Q_PID, Q_PID)), SLOT(eventsForked(Q_PID, Q_PID)));
+        connect(m_events, SIGNAL(exited(Q_PID, int)), SLOT(eventsExited(Q_PID, int)));
+        QHash<qint64, QProcessFrontend*>::const_iterator it;
+        for (it = m_pidIndex.constBegin() ; it != m_pidIndex.constEnd() ; ++it)
+            watchRoot(it.value(), it.key(), true);
+        m_events->start();
+    }
+    emit processEventsChanged();
+}
+
+/*!
+  Return the time in milliseconds between samples of the memory and
+  CPU statistics of the running processes, or 0 if they are not sampled.
+*/
+
+int QProcessManager::samplingInterval() const
+{
+    return m_samplingTimer.isActive() ? m_samplingTimer.interval() : 0;
+}
+
+/*!
+  Sample the statistics of every running process once every \a interval
+  milliseconds, and pass the results to each QProcessFrontend.  All of
+  the processes are read together on one timer.  An \a interval of 0
+  stops sampling, which is the default.
+
+  \sa QProcessStatistics, QProcessFrontend::rss
+*/
+
+void QProcessManager::setSamplingInterval(int interval)
+{
+    if (interval != samplingInterval()) {
+        if (interval > 0)
+            m_samplingTimer.start(interval);
+        else
+            m_samplingTimer.stop();
+        emit samplingIntervalChanged();
+    }
+}
+
 /*!
   Raise the processAboutToStart() signal.
 */
@@ -312,6 +446,152 @@ void QProcessManager::processFrontendDestroyed()
         m_processlist.removeAll(frontend);
 }
 
+/*!
+  Raise the processStatisticsChanged() signal.
+*/
+
+void QProcessManager::processFrontendStatisticsChanged()
+{
+}
+
+/*
+  Index the pid of a process that has started.
+ */
+
+void QProcessManager::indexFrontendStarted()
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    QHash<QProcessFrontend*, FrontendKeys>::iterator it = m_frontendKeys.find(frontend);
+    if (it == m_frontendKeys.end())
+        return;
+    unindexPid(frontend, it.value());
+    it.value().pid = frontend->pid();
+    if (it.value().pid) {
+        m_pidIndex.insert(it.value().pid, frontend);
+        if (m_events)
+            watchRoot(frontend, it.value().pid, false);
+    }
+}
+
+/*
+  Drop the pid of a process that is no longer running.  Its tree is
+  only unwatched if nothing is left in it; otherwise the last
+  descendant to exit does that.
+ */
+
+void QProcessManager::indexFrontendStateChanged(QProcess::ProcessState state)
+{
+    if (state != QProcess::NotRunning)
+        return;
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(sender());
+    QHash<QProcessFrontend*, FrontendKeys>::iterator it = m_frontendKeys.find(frontend);
+    if (it == m_frontendKeys.end())
+        return;
+    qint64 pid = it.value().pid;
+    unindexPid(frontend, it.value());
+    if (m_events && m_watchedRoots.value(pid) == frontend && m_events->descendants(pid).isEmpty())
+        unwatchRoot(pid);
+}
+
+/*
+  Remove a destroyed process from every index.  The \a object is
+  already partially destroyed, so it is only used as a key.
+ */
+
+void QProcessManager::indexFrontendDestroyed(QObject *object)
+{
+    QProcessFrontend *frontend = static_cast<QProcessFrontend *>(object);
+    QHash<QProcessFrontend*, FrontendKeys>::iterator it = m_frontendKeys.find(frontend);
+    if (it == m_frontendKeys.end())
+        return;
+    unindexPid(frontend, it.value());
+    foreach (qint64 pid, m_watchedRoots.keys(frontend))
+        unwatchRoot(pid);
+    if (m_nameIndex.value(it.value().name) == frontend)
+        m_nameIndex.remove(it.value().name);
+    m_identifierIndex.remove(it.value().identifier, frontend);
+    m_frontendKeys.erase(it);
+}
+
+/*
+  Remove the pid entry of \a frontend, unless the pid has already
+  been taken over by another process.
+ */
+
+void QProcessManager::unindexPid(QProcessFrontend *frontend, FrontendKeys& keys)
+{
+    if (keys.pid && m_pidIndex.value(keys.pid) == frontend)
+        m_pidIndex.remove(keys.pid);
+    keys.pid = 0;
+}
+
+/*
+  Watch the tree of \a pid on behalf of \a frontend.  A tree left
+  over from an earlier process with the same pid is dropped first.
+ */
+
+void QProcessManager::watchRoot(QProcessFrontend *frontend, qint64 pid, bool existing)
+{
+    if (m_watchedRoots.contains(pid))
+        unwatchRoot(pid);
+    m_watchedRoots.insert(pid, frontend);
+    m_events->watch(pid, existing);
+}
+
+void QProcessManager::unwatchRoot(qint64 pid)
+{
+    m_watchedRoots.remove(pid);
+    if (m_events)
+        m_events->unwatch(pid);
+}
+
+/*
+  Read the statistics of every running process in one pass.  A
+  receiver of statisticsChanged() may stop or delete processes, so
+  each one is looked up again before use.
+ */
+
+void QProcessManager::sampleStatistics()
+{
+    foreach (qint64 pid, m_pidIndex.keys()) {
+        QProcessFrontend *frontend = m_pidIndex.value(pid);
+        if (frontend)
+            frontend->setStatistics(QProcessStatistics::forPid(pid));
+    }
+}
+
+/*
+  A process forked somewhere below one of our frontends
+ */
+
+void QProcessManager::eventsForked(Q_PID parent, Q_PID child)
+{
+    Q_UNUSED(parent);
+    QProcessFrontend *frontend = m_watchedRoots.value(m_events->rootOf(child));
+    if (frontend)
+        emit descendantStarted(frontend, child);
+}
+
+/*
+  The frontend reports its own process finishing, so only descendants
+  are passed on.  The exiting process is still in its tree, so once the
+  frontend has finished it is the last one when the tree has a single
+  descendant.  A receiver may destroy the frontend, so it is looked up
+  again afterwards.
+ */
+
+void QProcessManager::eventsExited(Q_PID pid, int status)
+{
+    Q_PID root = m_events->rootOf(pid);
+    QProcessFrontend *frontend = m_watchedRoots.value(root);
+    if (!frontend || root == pid)
+        return;
+    emit descendantFinished(frontend, pid, status);
+    if (m_events && m_watchedRoots.value(root) == frontend
+            && m_pidIndex.value(root) != frontend && m_events->descendants(root).size() == 1)
+        unwatchRoot(root);
+}
+
 /*!
     \fn void QProcessManager::memoryRestrictedChanged()
     This signal is emitted when the memory restriction is changed
@@ -322,6 +602,30 @@ void QProcessManager::processFrontendDestroyed()
     This signal is emitted when the idle delegate is changed
 */
 
+/*!
+    \fn void QProcessManager::processEventsChanged()
+    This signal is emitted when the process event source is changed
+*/
+
+/*!
+    \fn void QProcessManager::samplingIntervalChanged()
+    This signal is emitted when the sampling interval is changed
+*/
+
+/*!
+  \fn void QProcessManager::descendantStarted(QProcessFrontend *frontend, qint64 pid)
+  This signal is emitted when the process of \a frontend, or one of its
+  descendants, forks the new process \a pid.
+*/
+
+/*!
+  \fn void QProcessManager::descendantFinished(QProcessFrontend *frontend, qint64 pid, int status)
+  This signal is emitted when \a pid, a descendant of the process of
+  \a frontend, exits with waitpid() style \a status, or -1 if that
+  is not known.  Descendants that outlive the process of \a frontend
+  are still reported.
+*/
+
 /*!
   \fn void QProcessManager::internalProcessesChanged()
   This signal is emitted when the list of internal processes changes.
@@ -44,6 +44,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QTimer>
 #include <QProcessEnvironment>
 
 #include "qprocessmanager-global.h"
@@ -58,6 +59,8 @@ class QProcessBackendFactory;
 class QProcessBackendManager;
 class QProcessBackend;
 class QIdleDelegate;
+class QProcessGroup;
+class QProcessEvents;
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QProcessManager : public QObject
 {
@@ -65,6 +68,8 @@ class Q_ADDON_PROCESSMANAGER_EXPORT QProcessManager : public QObject
     Q_PROPERTY(bool memoryRestricted READ memoryRestricted
                WRITE setMemoryRestricted NOTIFY memoryRestrictedChanged)
     Q_PROPERTY(QIdleDelegate* idleDelegate READ idleDelegate WRITE setIdleDelegate NOTIFY idleDelegateChanged);
+    Q_PROPERTY(QProcessEvents* processEvents READ processEvents WRITE setProcessEvents NOTIFY processEventsChanged)
+    Q_PROPERTY(int samplingInterval READ samplingInterval WRITE setSamplingInterval NOTIFY samplingIntervalChanged)
 
 public:
     explicit QProcessManager(QObject *parent = 0);
@@ -72,11 +77,14 @@ public:
 
     Q_INVOKABLE QProcessFrontend *create(const QProcessInfo& info);
     Q_INVOKABLE QProcessFrontend *create(const QVariantMap& info);
+    Q_INVOKABLE QProcessGroup    *createGroup(const QProcessInfo& info, int count);
+    Q_INVOKABLE QProcessGroup    *createGroup(const QVariantMap& info, int count);
 
     Q_INVOKABLE QStringList      names() const;
 
     Q_INVOKABLE QProcessFrontend *processForName(const QString &name) const;
     Q_INVOKABLE QProcessFrontend *processForPID(qint64 PID) const;
+    Q_INVOKABLE QList<QObject *> processesForIdentifier(const QString &identifier) const;
     Q_INVOKABLE int              size() const;
 
     Q_INVOKABLE void             addBackendFactory(QProcessBackendFactory *factory);
@@ -88,9 +96,19 @@ public:
     QIdleDelegate * idleDelegate() const;
     void           setIdleDelegate(QIdleDelegate *);
 
+    QProcessEvents *processEvents() const;
+    void            setProcessEvents(QProcessEvents *);
+
+    int  samplingInterval() const;
+    void setSamplingInterval(int interval);
+
 signals:
     void memoryRestrictedChanged();
     void idleDelegateChanged();
+    void processEventsChanged();
+    void samplingIntervalChanged();
+    void descendantStarted(QProcessFrontend *frontend, qint64 pid);
+    void descendantFinished(QProcessFrontend *frontend, qint64 pid, int status);
     void internalProcessesChanged();
     void internalProcessError(QProcess::ProcessError);
 
@@ -102,13 +120,42 @@ protected slots:
     virtual void processFrontendFinished(int, QProcess::ExitStatus);
     virtual void processFrontendStateChanged(QProcess::ProcessState);
     virtual void processFrontendDestroyed();
+    virtual void processFrontendStatisticsChanged();
 
 protected:
     virtual QProcessFrontend *createFrontend(QProcessBackend *backend);
 
+private slots:
+    void indexFrontendStarted();
+    void indexFrontendStateChanged(QProcess::ProcessState);
+    void indexFrontendDestroyed(QObject *);
+    void eventsForked(Q_PID parent, Q_PID child);
+    void eventsExited(Q_PID pid, int status);
+    void sampleStatistics();
+
 protected:
     QList<QProcessFrontend*> m_processlist;
     QProcessBackendManager  *m_backend;
+
+private:
+    struct FrontendKeys {
+        FrontendKeys() : pid(0) {}
+        QString name;
+        QString identifier;
+        qint64  pid;
+    };
+    void unindexPid(QProcessFrontend *frontend, FrontendKeys& keys);
+    void watchRoot(QProcessFrontend *frontend, qint64 pid, bool existing);
+    void unwatchRoot(qint64 pid);
+
+private:
+    QHash<QProcessFrontend*, FrontendKeys>  m_frontendKeys;
+    QHash<QString, QProcessFrontend*>       m_nameIndex;
+    QHash<qint64, QProcessFrontend*>        m_pidIndex;
+    QMultiHash<QString, QProcessFrontend*>  m_identifierIndex;
+    QHash<qint64, QProcessFrontend*>        m_watchedRoots;
+    QProcessEvents                         *m_events;
+    QTimer                                  m_samplingTimer;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
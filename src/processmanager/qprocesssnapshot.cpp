@@ -0,0 +1,559 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocesssnapshot.h"
+#include "qprocparser_p.h"
+
+#include <QtAlgorithms>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+const int kStatBufferSize     = 1024;
+const int kDefaultMaxOpenFiles = 64;
+
+/*
+  Convert clock ticks from /proc into milliseconds
+ */
+
+static qint64 ticksToMsecs(quint64 ticks)
+{
+#if defined(Q_OS_LINUX)
+    static const long hz = ::sysconf(_SC_CLK_TCK);
+    return ticks * 1000 / (hz > 0 ? hz : 100);
+#else
+    return ticks * 10;
+#endif
+}
+
+void QProcessSnapshot::Table::clear()
+{
+    // resize() keeps the capacity, so a steady state scan doesn't allocate
+    pid.resize(0);
+    ppid.resize(0);
+    pgrp.resize(0);
+    state.resize(0);
+    utime.resize(0);
+    stime.resize(0);
+    rss.resize(0);
+    threads.resize(0);
+    startTime.resize(0);
+    cpuDelta.resize(0);
+}
+
+/*!
+  \class QProcessSnapshot
+  \brief The QProcessSnapshot class holds a table of every process on the system
+  \inmodule QtProcessManager
+
+  Each call to update() reads \c{/proc} once and stores the pid,
+  parent, process group, state, CPU times, resident size, thread count
+  and start time of every process, one array per column and sorted by
+  pid.  A row is looked up with indexOf() and read with the column
+  accessors, such as ppid() or rss().
+
+  The new table is compared with the previous one.  The spawned(),
+  exited() and changed() signals report the differences, and
+  cpuDelta() and cpuUsage() give the CPU time each process used
+  during the interval.  A pid that was reused between two updates is
+  reported as both exited and spawned.
+
+  The stat files of up to \l{maxOpenFiles} processes are kept open
+  between updates and simply read again, so such a process costs one
+  read() per update.  The stat files of other processes are opened and
+  closed on each update.
+
+  Set the \l{interval} to update on a timer, or call update() directly.
+ */
+
+/*!
+  \property QProcessSnapshot::interval
+  \brief The time in milliseconds between updates, or 0 to only update on request
+ */
+
+/*!
+  \property QProcessSnapshot::maxOpenFiles
+  \brief The number of stat files kept open between updates
+
+  Every open file holds a file descriptor of the calling process.  The
+  default is 64, or a quarter of the file descriptor limit if that is
+  lower.  A value of 0 keeps no files open.
+ */
+
+/*!
+  \property QProcessSnapshot::count
+  \brief The number of processes in the snapshot
+ */
+
+/*!
+  Construct an empty QProcessSnapshot with optional \a parent.
+ */
+
+QProcessSnapshot::QProcessSnapshot(QObject *parent)
+    : QObject(parent)
+    , m_maxFiles(kDefaultMaxOpenFiles)
+    , m_elapsed(0)
+{
+#if defined(Q_OS_LINUX)
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        m_maxFiles = qMin<rlim_t>(m_maxFiles, limit.rlim_cur / 4);
+#endif
+    connect(&m_timer, SIGNAL(timeout()), SLOT(update()));
+}
+
+/*!
+  Destroy the snapshot and close the files it holds.
+ */
+
+QProcessSnapshot::~QProcessSnapshot()
+{
+#if defined(Q_OS_LINUX)
+    foreach (int fd, m_files)
+        ::close(fd);
+#endif
+}
+
+/*!
+  Return the update interval in milliseconds
+ */
+
+int QProcessSnapshot::interval() const
+{
+    return m_timer.isActive() ? m_timer.interval() : 0;
+}
+
+/*!
+  Set the update interval to \a interval milliseconds.  A value of 0
+  stops the timer.
+ */
+
+void QProcessSnapshot::setInterval(int interval)
+{
+    if (this->interval() != interval) {
+        if (interval > 0)
+            m_timer.start(interval);
+        else
+            m_timer.stop();
+        emit intervalChanged();
+    }
+}
+
+/*!
+  Return the number of stat files kept open between updates
+ */
+
+int QProcessSnapshot::maxOpenFiles() const
+{
+    return m_maxFiles;
+}
+
+/*!
+  Keep at most \a count stat files open between updates.  Files beyond
+  the new limit are closed right away.
+ */
+
+void QProcessSnapshot::setMaxOpenFiles(int count)
+{
+    count = qMax(0, count);
+    if (m_maxFiles != count) {
+        m_maxFiles = count;
+        while (m_files.size() > m_maxFiles)
+            closeFile(m_files.constBegin().key());
+        emit maxOpenFilesChanged();
+    }
+}
+
+/*!
+  Return the number of processes in the snapshot
+ */
+
+int QProcessSnapshot::count() const
+{
+    return m_current.pid.size();
+}
+
+/*!
+  Return the row of \a pid, or -1 if it is not in the snapshot
+ */
+
+int QProcessSnapshot::indexOf(Q_PID pid) const
+{
+    QVector<Q_PID>::const_iterator it = qBinaryFind(m_current.pid, pid);
+    return it == m_current.pid.constEnd() ? -1 : it - m_current.pid.constBegin();
+}
+
+/*!
+  Return the time in milliseconds between the last two updates
+ */
+
+qint64 QProcessSnapshot::elapsed() const
+{
+    return m_elapsed;
+}
+
+/*!
+  Return the pid of row \a index
+ */
+
+Q_PID QProcessSnapshot::pid(int index) const
+{
+    return m_current.pid.at(index);
+}
+
+/*!
+  Return the parent pid of row \a index
+ */
+
+Q_PID QProcessSnapshot::ppid(int index) const
+{
+    return m_current.ppid.at(index);
+}
+
+/*!
+  Return the process group of row \a index
+ */
+
+Q_PID QProcessSnapshot::pgrp(int index) const
+{
+    return m_current.pgrp.at(index);
+}
+
+/*!
+  Return the state character of row \a index, such as 'R' for running
+  or 'S' for sleeping
+ */
+
+char QProcessSnapshot::state(int index) const
+{
+    return m_current.state.at(index);
+}
+
+/*!
+  Return the user mode CPU time of row \a index in milliseconds
+ */
+
+qint64 QProcessSnapshot::userTime(int index) const
+{
+    return ticksToMsecs(m_current.utime.at(index));
+}
+
+/*!
+  Return the kernel mode CPU time of row \a index in milliseconds
+ */
+
+qint64 QProcessSnapshot::systemTime(int index) const
+{
+    return ticksToMsecs(m_current.stime.at(index));
+}
+
+/*!
+  Return the resident set size of row \a index in bytes
+ */
+
+qint64 QProcessSnapshot::rss(int index) const
+{
+    return m_current.rss.at(index);
+}
+
+/*!
+  Return the number of threads of row \a index
+ */
+
+int QProcessSnapshot::threads(int index) const
+{
+    return m_current.threads.at(index);
+}
+
+/*!
+  Return the start time of row \a index in clock ticks after boot.
+  Together with the pid this identifies a process.
+ */
+
+quint64 QProcessSnapshot::startTime(int index) const
+{
+    return m_current.startTime.at(index);
+}
+
+/*!
+  Return the CPU time in milliseconds that row \a index used since
+  the previous update.  A process that started in between is charged
+  with all of its CPU time.
+ */
+
+qint64 QProcessSnapshot::cpuDelta(int index) const
+{
+    return ticksToMsecs(m_current.cpuDelta.at(index));
+}
+
+/*!
+  Return the CPU use of row \a index over the last interval as a
+  fraction of one CPU.
+ */
+
+double QProcessSnapshot::cpuUsage(int index) const
+{
+    if (m_elapsed <= 0)
+        return 0;
+    return double(cpuDelta(index)) / m_elapsed;
+}
+
+/*!
+  Return every pid in the snapshot, in ascending order
+ */
+
+QPidList QProcessSnapshot::pids() const
+{
+    QPidList result;
+    result.reserve(m_current.pid.size());
+    foreach (Q_PID pid, m_current.pid)
+        result << pid;
+    return result;
+}
+
+/*!
+  Return the direct children of \a pid
+ */
+
+QPidList QProcessSnapshot::children(Q_PID pid) const
+{
+    QPidList result;
+    for (int i = 0 ; i < m_current.ppid.size() ; i++)
+        if (m_current.ppid.at(i) == pid)
+            result << m_current.pid.at(i);
+    return result;
+}
+
+/*
+  Read the stat file of \a pid into \a buf, through the descriptor
+  kept from the last update if there is one.  A descriptor refers to
+  the process rather than the pid, so once that process has gone the
+  read fails even if the pid has been reused.
+ */
+
+bool QProcessSnapshot::readStat(Q_PID pid, char *buf, int size)
+{
+#if defined(Q_OS_LINUX)
+    QHash<Q_PID, int>::iterator it = m_files.find(pid);
+    if (it != m_files.end()) {
+        ssize_t n = ::pread(it.value(), buf, size - 1, 0);
+        if (n > 0) {
+            buf[n] = 0;
+            return true;
+        }
+        ::close(it.value());
+        m_files.erase(it);
+    }
+
+    char path[64];
+    ::snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    if (m_files.size() >= m_maxFiles)
+        return QProcParser::readFile(path, buf, size) > 0;
+
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+    ssize_t n = ::pread(fd, buf, size - 1, 0);
+    if (n <= 0) {
+        ::close(fd);
+        return false;
+    }
+    buf[n] = 0;
+    m_files.insert(pid, fd);
+    return true;
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(buf);
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+void QProcessSnapshot::closeFile(Q_PID pid)
+{
+#if defined(Q_OS_LINUX)
+    QHash<Q_PID, int>::iterator it = m_files.find(pid);
+    if (it != m_files.end()) {
+        ::close(it.value());
+        m_files.erase(it);
+    }
+#else
+    Q_UNUSED(pid);
+#endif
+}
+
+/*!
+  Read a new snapshot of every process and report the differences
+  from the previous one.  The first update reports every process as
+  spawned.
+ */
+
+void QProcessSnapshot::update()
+{
+    bool first = !m_clock.isValid();
+    m_elapsed = first ? 0 : m_clock.restart();
+    if (first)
+        m_clock.start();
+
+    qSwap(m_current, m_previous);
+    m_current.clear();
+
+#if defined(Q_OS_LINUX)
+    DIR *dir = ::opendir("/proc");
+    if (!dir) {
+        qWarning("Unable to open /proc: %s", strerror(errno));
+        return;
+    }
+    QVector<Q_PID> scan;
+    scan.reserve(m_previous.pid.size() + 64);
+    struct dirent *entry;
+    while ((entry = ::readdir(dir)) != NULL) {
+        if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9')
+            scan << ::strtol(entry->d_name, NULL, 10);
+    }
+    ::closedir(dir);
+    qSort(scan);
+
+    static const long pageSize = ::sysconf(_SC_PAGESIZE);
+    char     buf[kStatBufferSize];
+    ProcStat stat;
+    foreach (Q_PID pid, scan) {
+        if (!readStat(pid, buf, sizeof(buf)) || !QProcParser::parseStat(buf, &stat))
+            continue;
+        m_current.pid       << pid;
+        m_current.ppid      << stat.ppid;
+        m_current.pgrp      << stat.pgrp;
+        m_current.state     << stat.state;
+        m_current.utime     << stat.tms_utime;
+        m_current.stime     << stat.tms_stime;
+        m_current.rss       << qint64(stat.rss) * pageSize;
+        m_current.threads   << stat.num_threads;
+        m_current.startTime << stat.start_time;
+        m_current.cpuDelta  << (first ? 0 : stat.tms_utime + stat.tms_stime);
+    }
+#endif
+
+    // Both tables are sorted by pid, so a single merge finds the differences
+    QPidList spawnedList, exitedList, changedList;
+    const Table& a = m_previous;
+    Table& b = m_current;
+    int i = 0, j = 0;
+    while (i < a.pid.size() || j < b.pid.size()) {
+        if (j == b.pid.size() || (i < a.pid.size() && a.pid.at(i) < b.pid.at(j))) {
+            exitedList << a.pid.at(i);
+            closeFile(a.pid.at(i));
+            i++;
+        }
+        else if (i == a.pid.size() || b.pid.at(j) < a.pid.at(i)) {
+            spawnedList << b.pid.at(j);
+            j++;
+        }
+        else {
+            if (a.startTime.at(i) != b.startTime.at(j)) {
+                exitedList << a.pid.at(i);
+                spawnedList << b.pid.at(j);
+            }
+            else {
+                b.cpuDelta[j] -= a.utime.at(i) + a.stime.at(i);
+                if (a.ppid.at(i) != b.ppid.at(j) || a.pgrp.at(i) != b.pgrp.at(j)
+                        || a.state.at(i) != b.state.at(j) || a.threads.at(i) != b.threads.at(j))
+                    changedList << b.pid.at(j);
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (!exitedList.isEmpty())
+        emit exited(exitedList);
+    if (!spawnedList.isEmpty())
+        emit spawned(spawnedList);
+    if (!changedList.isEmpty())
+        emit changed(changedList);
+    emit updated();
+}
+
+/*!
+  \fn void QProcessSnapshot::intervalChanged()
+  This signal is emitted when the update interval is changed.
+ */
+
+/*!
+  \fn void QProcessSnapshot::maxOpenFilesChanged()
+  This signal is emitted when the maxOpenFiles property is changed.
+ */
+
+/*!
+  \fn void QProcessSnapshot::updated()
+  This signal is emitted after every update, once the differences
+  have been reported.
+ */
+
+/*!
+  \fn void QProcessSnapshot::spawned(const QPidList& pids)
+  This signal is emitted when \a pids were not in the previous snapshot.
+ */
+
+/*!
+  \fn void QProcessSnapshot::exited(const QPidList& pids)
+  This signal is emitted when \a pids from the previous snapshot have gone.
+ */
+
+/*!
+  \fn void QProcessSnapshot::changed(const QPidList& pids)
+  This signal is emitted when the parent, process group, state or
+  thread count of \a pids changed since the previous snapshot.
+ */
+
+#include "moc_qprocesssnapshot.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
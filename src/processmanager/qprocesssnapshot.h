@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PROCESS_SNAPSHOT_H
+#define PROCESS_SNAPSHOT_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "qprocesslist.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QProcessSnapshot : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    Q_PROPERTY(int maxOpenFiles READ maxOpenFiles WRITE setMaxOpenFiles NOTIFY maxOpenFilesChanged)
+    Q_PROPERTY(int count READ count NOTIFY updated)
+
+public:
+    explicit QProcessSnapshot(QObject *parent = 0);
+    virtual ~QProcessSnapshot();
+
+    int     interval() const;
+    void    setInterval(int interval);
+    int     maxOpenFiles() const;
+    void    setMaxOpenFiles(int count);
+
+    int     count() const;
+    int     indexOf(Q_PID pid) const;
+    qint64  elapsed() const;
+
+    Q_PID   pid(int index) const;
+    Q_PID   ppid(int index) const;
+    Q_PID   pgrp(int index) const;
+    char    state(int index) const;
+    qint64  userTime(int index) const;
+    qint64  systemTime(int index) const;
+    qint64  rss(int index) const;
+    int     threads(int index) const;
+    quint64 startTime(int index) const;
+
+    qint64  cpuDelta(int index) const;
+    double  cpuUsage(int index) const;
+
+    QPidList pids() const;
+    QPidList children(Q_PID pid) const;
+
+public slots:
+    void update();
+
+signals:
+    void intervalChanged();
+    void maxOpenFilesChanged();
+    void updated();
+    void spawned(const QPidList& pids);
+    void exited(const QPidList& pids);
+    void changed(const QPidList& pids);
+
+private:
+    bool readStat(Q_PID pid, char *buf, int size);
+    void closeFile(Q_PID pid);
+
+private:
+    Q_DISABLE_COPY(QProcessSnapshot)
+
+    struct Table {
+        QVector<Q_PID>   pid;
+        QVector<Q_PID>   ppid;
+        QVector<Q_PID>   pgrp;
+        QVector<char>    state;
+        QVector<quint64> utime;
+        QVector<quint64> stime;
+        QVector<qint64>  rss;
+        QVector<int>     threads;
+        QVector<quint64> startTime;
+        QVector<qint64>  cpuDelta;
+        void clear();
+    };
+
+    Table              m_current;
+    Table              m_previous;
+    QHash<Q_PID, int>  m_files;
+    int                m_maxFiles;
+    QTimer             m_timer;
+    QElapsedTimer      m_clock;
+    qint64             m_elapsed;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PROCESS_SNAPSHOT_H
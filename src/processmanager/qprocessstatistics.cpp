@@ -0,0 +1,258 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocessstatistics.h"
+#include "qprocparser_p.h"
+
+#include <QFile>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+  \class QProcessStatistics
+  \brief The QProcessStatistics class holds memory and CPU figures for one process
+  \inmodule QtProcessManager
+
+  A QProcessStatistics is read from \c{/proc/<pid>/stat} and the
+  kernel's pre-summed \c{smaps_rollup}.  On kernels without
+  \c{smaps_rollup} every mapping in \c{smaps} is added up instead,
+  which is noticeably slower for large processes.
+
+  \list
+  \li rss() counts every resident page.
+  \li pss() charges shared pages to each process in proportion.
+  \li uss() only counts pages no other process maps, which is what
+      killing the process would give back.
+  \li swap() is the amount of the process that has been swapped out.
+  \endlist
+
+  Memory sizes are in bytes and cpuTime() in milliseconds of user and
+  system time.  QProcessManager samples every running process on a
+  timer (see QProcessManager::samplingInterval) and hands the results
+  to each QProcessFrontend.
+ */
+
+/*!
+  Construct an invalid QProcessStatistics with all values zero
+ */
+
+QProcessStatistics::QProcessStatistics()
+    : m_valid(false)
+    , m_rss(0)
+    , m_pss(0)
+    , m_uss(0)
+    , m_swap(0)
+    , m_majorFaults(0)
+    , m_cpuTime(0)
+{
+}
+
+/*
+  Add one "Key:   1234 kB" line of an smaps file
+ */
+
+static void addSmapsLine(const char *line, qint64 *rss, qint64 *pss, qint64 *uss, qint64 *swap)
+{
+    qint64 *field = 0;
+    if (!strncmp(line, "Rss:", 4))
+        field = rss;
+    else if (!strncmp(line, "Pss:", 4))
+        field = pss;
+    else if (!strncmp(line, "Private_Clean:", 14) || !strncmp(line, "Private_Dirty:", 14))
+        field = uss;
+    else if (!strncmp(line, "Swap:", 5))
+        field = swap;
+    if (field) {
+        const char *value = strchr(line, ':') + 1;
+        *field += strtoll(value, NULL, 10) * 1024;
+    }
+}
+
+/*!
+  Read the statistics of \a pid.  The result is invalid if the
+  process doesn't exist or belongs to another user.
+ */
+
+QProcessStatistics QProcessStatistics::forPid(pid_t pid)
+{
+    QProcessStatistics result;
+#if defined(Q_OS_LINUX)
+    ProcStat stat;
+    if (!QProcParser::readStat(pid, &stat))
+        return result;
+    static const long hz = ::sysconf(_SC_CLK_TCK);
+    result.m_majorFaults = stat.maj_flt;
+    result.m_cpuTime = qint64(stat.tms_utime + stat.tms_stime) * 1000 / (hz > 0 ? hz : 100);
+
+    char path[64];
+    char buf[QProcParser::BufferSize];
+    ::snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    if (QProcParser::readFile(path, buf, sizeof(buf)) > 0) {
+        for (const char *line = buf ; line && *line ; ) {
+            addSmapsLine(line, &result.m_rss, &result.m_pss, &result.m_uss, &result.m_swap);
+            line = strchr(line, '\n');
+            if (line)
+                line++;
+        }
+    }
+    else {
+        QFile file(QString::fromLatin1("/proc/%1/smaps").arg(pid));
+        if (!file.open(QIODevice::ReadOnly))
+            return result;
+        char line[256];
+        while (file.readLine(line, sizeof(line)) > 0)
+            addSmapsLine(line, &result.m_rss, &result.m_pss, &result.m_uss, &result.m_swap);
+    }
+    result.m_valid = true;
+#else
+    Q_UNUSED(pid);
+#endif
+    return result;
+}
+
+/*!
+  Return true if the statistics were read
+ */
+
+bool QProcessStatistics::isValid() const
+{
+    return m_valid;
+}
+
+/*!
+  Return the resident set size in bytes
+ */
+
+qint64 QProcessStatistics::rss() const
+{
+    return m_rss;
+}
+
+/*!
+  Return the proportional set size in bytes
+ */
+
+qint64 QProcessStatistics::pss() const
+{
+    return m_pss;
+}
+
+/*!
+  Return the unique set size in bytes
+ */
+
+qint64 QProcessStatistics::uss() const
+{
+    return m_uss;
+}
+
+/*!
+  Return the amount swapped out, in bytes
+ */
+
+qint64 QProcessStatistics::swap() const
+{
+    return m_swap;
+}
+
+/*!
+  Return the number of page faults that needed disk I/O
+ */
+
+qint64 QProcessStatistics::majorFaults() const
+{
+    return m_majorFaults;
+}
+
+/*!
+  Return the user plus system CPU time in milliseconds
+ */
+
+qint64 QProcessStatistics::cpuTime() const
+{
+    return m_cpuTime;
+}
+
+/*!
+  Return the statistics as a QVariantMap, or an empty map if they
+  are not valid
+ */
+
+QVariantMap QProcessStatistics::toMap() const
+{
+    QVariantMap map;
+    if (m_valid) {
+        map.insert(QStringLiteral("rss"), m_rss);
+        map.insert(QStringLiteral("pss"), m_pss);
+        map.insert(QStringLiteral("uss"), m_uss);
+        map.insert(QStringLiteral("swap"), m_swap);
+        map.insert(QStringLiteral("majorFaults"), m_majorFaults);
+        map.insert(QStringLiteral("cpuTime"), m_cpuTime);
+    }
+    return map;
+}
+
+/*!
+  Return true if every value matches \a other
+ */
+
+bool QProcessStatistics::operator==(const QProcessStatistics& other) const
+{
+    return m_valid == other.m_valid && m_rss == other.m_rss && m_pss == other.m_pss
+        && m_uss == other.m_uss && m_swap == other.m_swap
+        && m_majorFaults == other.m_majorFaults && m_cpuTime == other.m_cpuTime;
+}
+
+/*!
+  Return true if any value differs from \a other
+ */
+
+bool QProcessStatistics::operator!=(const QProcessStatistics& other) const
+{
+    return !(*this == other);
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
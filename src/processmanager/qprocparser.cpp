@@ -0,0 +1,316 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qprocparser_p.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*
+  Walk a nul terminated /proc buffer one field at a time.  Nothing is
+  copied; numbers are converted in place.  A missing or malformed
+  field clears ok() and reads as zero.
+ */
+
+class ProcTokenizer
+{
+public:
+    explicit ProcTokenizer(const char *p) : m_p(p), m_ok(true) {}
+
+    bool ok() const { return m_ok; }
+    const char *position() const { return m_p; }
+
+    char character() {
+        skipSpace();
+        if (!*m_p || *m_p == '\n') {
+            m_ok = false;
+            return 0;
+        }
+        return *m_p++;
+    }
+
+    quint64 unsignedNumber() {
+        skipSpace();
+        if (*m_p < '0' || *m_p > '9') {
+            m_ok = false;
+            return 0;
+        }
+        quint64 value = 0;
+        while (*m_p >= '0' && *m_p <= '9')
+            value = value * 10 + (*m_p++ - '0');
+        return value;
+    }
+
+    qint64 number() {
+        skipSpace();
+        if (*m_p == '-') {
+            m_p++;
+            return -qint64(unsignedNumber());
+        }
+        return qint64(unsignedNumber());
+    }
+
+    void skip(int count) {
+        while (count--)
+            unsignedNumber();
+    }
+
+private:
+    void skipSpace() {
+        while (*m_p == ' ' || *m_p == '\t')
+            m_p++;
+    }
+
+    const char *m_p;
+    bool        m_ok;
+};
+
+/*
+  Copy the rest of the line at \a p into \a out, truncating to \a size
+ */
+
+static void copyLine(const char *p, char *out, int size)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    int len = 0;
+    while (p[len] && p[len] != '\n' && len < size - 1)
+        len++;
+    memcpy(out, p, len);
+    out[len] = 0;
+}
+
+/*!
+  \class QProcParser
+  \brief The QProcParser class reads /proc files without allocating
+  \internal
+
+  Each function reads into a caller supplied buffer, normally a
+  BufferSize array on the stack that is reused for several files, and
+  fills in a plain struct.  There are no regular expressions and no
+  intermediate strings, so it is cheap enough to run over every
+  process in the system.
+ */
+
+/*!
+  Read the file at \a path into \a buf, which holds \a size bytes, and
+  nul terminate it.  Anything that doesn't fit is dropped.  Returns
+  the number of bytes read, or -1 if the file can't be read.
+ */
+
+int QProcParser::readFile(const char *path, char *buf, int size)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+    int len = 0;
+    while (len < size - 1) {
+        ssize_t n = ::read(fd, buf + len, size - 1 - len);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n == -1) {
+            len = -1;
+            break;
+        }
+        if (n == 0)
+            break;
+        len += n;
+    }
+    ::close(fd);
+    if (len >= 0)
+        buf[len] = 0;
+    return len;
+}
+
+/*!
+  Parse the contents of a /proc/<pid>/stat file in \a buf into \a stat.
+  The command name may itself contain spaces and parentheses, so it
+  runs from the first '(' to the last ')'.  Returns false if a field
+  is missing.
+ */
+
+bool QProcParser::parseStat(const char *buf, ProcStat *stat)
+{
+    const char *open = ::strchr(buf, '(');
+    const char *close = ::strrchr(buf, ')');
+    if (!open || !close || close < open)
+        return false;
+
+    ProcTokenizer pid(buf);
+    stat->pid = pid.number();
+    if (!pid.ok())
+        return false;
+    int len = qMin(int(close - open - 1), int(sizeof(stat->comm)) - 1);
+    memcpy(stat->comm, open + 1, len);
+    stat->comm[len] = 0;
+
+    ProcTokenizer t(close + 1);
+    stat->state         = t.character();
+    stat->ppid          = t.number();
+    stat->pgrp          = t.number();
+    stat->session       = t.number();
+    stat->tty_nr        = t.number();
+    stat->tty_pgrp      = t.number();
+    stat->flags         = t.unsignedNumber();
+    stat->min_flt       = t.unsignedNumber();
+    stat->cmin_flt      = t.unsignedNumber();
+    stat->maj_flt       = t.unsignedNumber();
+    stat->cmaj_flt      = t.unsignedNumber();
+    stat->tms_utime     = t.unsignedNumber();
+    stat->tms_stime     = t.unsignedNumber();
+    stat->tms_cutime    = t.number();
+    stat->tms_cstime    = t.number();
+    stat->priority      = t.number();
+    stat->nice          = t.number();
+    stat->num_threads   = t.number();
+    stat->it_real_value = t.number();
+    stat->start_time    = t.unsignedNumber();
+    stat->vsize         = t.unsignedNumber();
+    stat->rss           = t.number();
+    stat->rlim          = t.unsignedNumber();
+    stat->start_code    = t.unsignedNumber();
+    stat->end_code      = t.unsignedNumber();
+    stat->start_stack   = t.unsignedNumber();
+    stat->esp           = t.unsignedNumber();
+    stat->eip           = t.unsignedNumber();
+    t.skip(4);   // signal, blocked, sigignore, sigcatch
+    stat->wchan         = t.unsignedNumber();
+    stat->nswap         = t.unsignedNumber();
+    stat->cnswap        = t.unsignedNumber();
+    stat->exit_signal   = t.number();
+    stat->processor     = t.number();
+    return t.ok();
+}
+
+/*!
+  Parse the contents of a /proc/<pid>/status file in \a buf into
+  \a status.  Supplementary groups are appended to \a groups, if it
+  is not null.  Returns false if the name or ids are missing.
+ */
+
+bool QProcParser::parseStatus(const char *buf, ProcStatus *status, QList<gid_t> *groups)
+{
+    memset(status, 0, sizeof(ProcStatus));
+    int found = 0;
+    for (const char *line = buf ; line && *line ; ) {
+        if (!strncmp(line, "Name:", 5)) {
+            copyLine(line + 5, status->name, sizeof(status->name));
+            found++;
+        }
+        else if (!strncmp(line, "Uid:", 4)) {
+            ProcTokenizer t(line + 4);
+            status->uid  = t.unsignedNumber();
+            status->euid = t.unsignedNumber();
+            status->suid = t.unsignedNumber();
+            if (t.ok())
+                found++;
+        }
+        else if (!strncmp(line, "Gid:", 4)) {
+            ProcTokenizer t(line + 4);
+            status->gid  = t.unsignedNumber();
+            status->egid = t.unsignedNumber();
+            status->sgid = t.unsignedNumber();
+            if (t.ok())
+                found++;
+        }
+        else if (groups && !strncmp(line, "Groups:", 7)) {
+            ProcTokenizer t(line + 7);
+            forever {
+                gid_t group = t.unsignedNumber();
+                if (!t.ok())
+                    break;
+                groups->append(group);
+            }
+        }
+        else if (!strncmp(line, "Threads:", 8)) {
+            ProcTokenizer t(line + 8);
+            status->threads = t.number();
+        }
+        line = ::strchr(line, '\n');
+        if (line)
+            line++;
+    }
+    return found == 3;
+}
+
+/*!
+  Read and parse /proc/<\a pid>/stat into \a stat
+ */
+
+bool QProcParser::readStat(pid_t pid, ProcStat *stat)
+{
+    char path[64];
+    char buf[BufferSize];
+    ::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    return readFile(path, buf, sizeof(buf)) > 0 && parseStat(buf, stat);
+}
+
+/*!
+  Read and parse the stat file of thread \a tid of \a pid into \a stat
+ */
+
+bool QProcParser::readThreadStat(pid_t pid, pid_t tid, ProcStat *stat)
+{
+    char path[64];
+    char buf[BufferSize];
+    ::snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+    return readFile(path, buf, sizeof(buf)) > 0 && parseStat(buf, stat);
+}
+
+/*!
+  Read and parse /proc/<\a pid>/status into \a status, appending the
+  supplementary groups to \a groups
+ */
+
+bool QProcParser::readStatus(pid_t pid, ProcStatus *status, QList<gid_t> *groups)
+{
+    char path[64];
+    char buf[BufferSize];
+    ::snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    return readFile(path, buf, sizeof(buf)) > 0 && parseStatus(buf, status, groups);
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PROC_PARSER_P_H
+#define PROC_PARSER_P_H
+
+#include <QList>
+
+#include "qprocessmanager-global.h"
+#include "memorystatistics_p.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+// proc/pid/status
+struct ProcStatus {
+    char  name[64];
+    uid_t uid, euid, suid;
+    gid_t gid, egid, sgid;
+    int   threads;
+};
+
+class QProcParser
+{
+public:
+    enum { BufferSize = 4096 };
+
+    static int  readFile(const char *path, char *buf, int size);
+
+    static bool parseStat(const char *buf, ProcStat *stat);
+    static bool parseStatus(const char *buf, ProcStatus *status, QList<gid_t> *groups = 0);
+
+    static bool readStat(pid_t pid, ProcStat *stat);
+    static bool readThreadStat(pid_t pid, pid_t tid, ProcStat *stat);
+    static bool readStatus(pid_t pid, ProcStatus *status, QList<gid_t> *groups = 0);
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PROC_PARSER_P_H
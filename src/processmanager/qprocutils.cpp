@@ -40,24 +40,36 @@
 ****************************************************************************/
 
 #include "qprocutils.h"
+#include "qprocparser_p.h"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/resource.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QLocalSocket>
 #include <QDebug>
 
 #if defined(Q_OS_LINUX)
-#include <QRegExp>
+#include <sys/syscall.h>
+#include <poll.h>
+#ifndef __NR_pidfd_open
+#define __NR_pidfd_open 434   // Linux 5.3
+#endif
+#ifndef __NR_pidfd_send_signal
+#define __NR_pidfd_send_signal 424   // Linux 5.1
+#endif
 #elif defined(Q_OS_MAC)
 #include <sys/sysctl.h>
 #include <mach/mach.h>
@@ -84,88 +96,45 @@ QExecutingProcessInfo::QExecutingProcessInfo(pid_t pid)
     : m_data(0)
 {
 #if defined(Q_OS_LINUX)
-    static QRegExp statFile(QStringLiteral("^(\\d+) \\(.*\\) [RSDZTW] (\\d+) (\\d+) (\\d+)(?: \\d+){11} (\\d+) (\\d+)"));
-    /*
-       Index, name, format, description (from man 5 page for proc)
-       0  pid %d        The process ID.
-       1  name (%s)     The process name, surrounded by parenthesis
-       2  state %c      One of R (running), S (sleeping), D (disk sleep), ...
-       3  ppid %d       The PID of the parent.
-       4  pgrp %d       The process group ID of the process.
-       5  session %d    The session ID of the process.
-       17 priority %ld  For processes running under a non-real-time scheduling policy, this is
-                        the raw nice value (setpriority(2)) as represented in the kernel.
-                        The kernel stores nice values as numbers in the range 0 (high) to 39 (low),
-                        corresponding to the user- visible nice range of -20 to 19.
-       18 nice %ld      The nice value (see setpriority(2)), a value in the range
-                        19 (low priority) to -20 (high priority).
-     */
-
-    QFile file(QString::fromLatin1("/proc/%1/stat").arg(pid));
-    if (!file.open(QIODevice::ReadOnly))
+    // One buffer serves both files
+    char path[64];
+    char buf[QProcParser::BufferSize];
+    ::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (QProcParser::readFile(path, buf, sizeof(buf)) <= 0)
         return;
 
     m_data = new ProcessPrivateData;
     memset(m_data, 0, sizeof(ProcessPrivateData));
-    QByteArray contents = file.readAll();
-    file.close();
 
-    if (statFile.indexIn(QString::fromLocal8Bit(contents)) != 0) {
+    ProcStat stat;
+    if (!QProcParser::parseStat(buf, &stat)) {
         qWarning("Did not match pid=%d", pid);
         return;
     }
 
-    m_data->pid      = statFile.cap(1).toInt();
-    m_data->ppid     = statFile.cap(2).toInt();
-    m_data->pgrp     = statFile.cap(3).toInt();
-    m_data->sid      = statFile.cap(4).toInt();
-    m_data->priority = statFile.cap(5).toLong();
-    m_data->nice     = statFile.cap(6).toLong();
-
-    /* Some of the contents (from kernel documentation proc.txt)
-       Field       Content
-       Name        filename of the executable
-       Pid         process id
-       PPid        process id of the parent process
-       Uid         Real, effective, saved set, and  file system UIDs
-       Gid         Real, effective, saved set, and  file system GIDs
-       Groups      supplementary group list
-         ...
-     */
-    QFile status(QString::fromLatin1("/proc/%1/status").arg(pid));
-    if (!status.open(QIODevice::ReadOnly)) {
+    m_data->pid      = stat.pid;
+    m_data->ppid     = stat.ppid;
+    m_data->pgrp     = stat.pgrp;
+    m_data->sid      = stat.session;
+    m_data->priority = stat.priority;
+    m_data->nice     = stat.nice;
+
+    ::snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    if (QProcParser::readFile(path, buf, sizeof(buf)) <= 0) {
         qWarning("Unable to open status file for pid=%d", pid);
         return;
     }
 
-    char   buf[256];
-    qint64 len;
-    while ((len = status.readLine(buf, 256)) != -1) {
-        if (!strncmp("Name:", buf, 5))
-            m_name = QString::fromLocal8Bit(buf + 6, len-6);
-        else if (!strncmp("Uid:", buf, 4)) {
-            QList<QByteArray> uids = QByteArray(buf + 5, len-5).split('\t');
-            m_data->uid  = uids.at(0).toInt();
-            m_data->euid = uids.at(1).toInt();
-            m_data->suid = uids.at(2).toInt();
-        }
-        else if (!strncmp("Gid:", buf, 4)) {
-            QList<QByteArray> gids = QByteArray(buf + 5, len-5).split('\t');
-            m_data->gid  = gids.at(0).toInt();
-            m_data->egid = gids.at(1).toInt();
-            m_data->sgid = gids.at(2).toInt();
-        }
-        else if (!strncmp("Groups:", buf, 7)) {
-            QList<QByteArray> groups = QByteArray(buf+8, len-8).split(' ');
-            while (groups.size()) {
-                bool ok;
-                gid_t group = groups.takeFirst().toInt(&ok);
-                if (ok)
-                    m_groups.append(group);
-            }
-        }
+    ProcStatus status;
+    if (QProcParser::parseStatus(buf, &status, &m_groups)) {
+        m_name       = QString::fromLocal8Bit(status.name);
+        m_data->uid  = status.uid;
+        m_data->euid = status.euid;
+        m_data->suid = status.suid;
+        m_data->gid  = status.gid;
+        m_data->egid = status.egid;
+        m_data->sgid = status.sgid;
     }
-    status.close();
 #elif defined(Q_OS_MAC)
     int    name[4];
     size_t bufferSize;
@@ -291,16 +260,9 @@ qint64 QProcUtils::ppidForPid(pid_t pid)
 {
     int ppid = 0;
 #if defined(Q_OS_LINUX)
-    QFile statFile(QLatin1String("/proc/") + QString::number(pid) + QStringLiteral("/stat"));
-    statFile.open(QIODevice::ReadOnly);
-
-    QByteArray contents = statFile.readAll();
-    statFile.close();
-    // 954 (ofono-jdb-daemo) S 1
-    int readPid = 0;
-    char strDummy[64];
-    char state;
-    sscanf(contents.constData(), "%d %s %c %d %s", &readPid, strDummy, &state, &ppid, strDummy);
+    ProcStat stat;
+    if (QProcParser::readStat(pid, &stat))
+        ppid = stat.ppid;
 #else
     Q_UNUSED(pid);
 #endif
@@ -479,27 +441,322 @@ QList<qint32> QProcUtils::getThreadPriorities(pid_t pid)
 {
     QList<qint32> plist;
 #if defined(Q_OS_LINUX)
-    static QRegExp statFile(QStringLiteral("^(\\d+) \\(.*\\) [RSDZTW] (\\d+) (\\d+) (\\d+)(?: \\d+){11} (\\d+) (\\d+)"));
-
-    QDir pdir(QString::fromLatin1("/proc/%1/task").arg(pid));
-    foreach (const QString& entry, pdir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-        QFile file(QString::fromLatin1("%1/%2/stat").arg(pdir.path()).arg(entry));
-        if (!file.open(QIODevice::ReadOnly)) {
-            qWarning() << "Unable to read thread stat" << file.fileName();
-            return plist;
+    char path[64];
+    ::snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *dir = ::opendir(path);
+    if (!dir)
+        return plist;
+
+    struct dirent *entry;
+    while ((entry = ::readdir(dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+            continue;
+        ProcStat stat;
+        if (!QProcParser::readThreadStat(pid, ::strtol(entry->d_name, NULL, 10), &stat)) {
+            qWarning("Unable to read thread stat %s/%s", path, entry->d_name);
+            break;
         }
-        QByteArray contents = file.readAll();
-        if (statFile.indexIn(QString::fromLocal8Bit(contents)) != 0) {
-            qWarning("Did not match stat file expression");
-            return plist;
-        }
-        plist << statFile.cap(6).toLong();
+        plist << stat.nice;
     }
+    ::closedir(dir);
 #endif
     return plist;
 }
 
 
+/*!
+  Return a process file descriptor (a "pidfd") referring to \a pid, or -1
+  if the kernel does not support them.  The descriptor becomes readable
+  when the process exits, which lets a parent watch for the exit of an
+  individual child in its poll loop rather than catching \c{SIGCHLD}.
+  The descriptor is close-on-exec and is owned by the caller.
+ */
+
+int QProcUtils::openPidFd(pid_t pid)
+{
+#if defined(Q_OS_LINUX)
+    return ::syscall(__NR_pidfd_open, pid, 0);
+#else
+    Q_UNUSED(pid);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/*!
+  Return the proportional set size of \a pid in bytes, or -1 if it
+  cannot be read.  Pages shared with other processes are charged to
+  each of them in proportion, so the value is a fair measure of what
+  the process costs.  The kernel's pre-summed \c{smaps_rollup} file
+  is used when it exists; older kernels fall back to adding up every
+  mapping in \c{smaps}.
+ */
+
+qint64 QProcUtils::pssForPid(pid_t pid)
+{
+#if defined(Q_OS_LINUX)
+    QFile file(QString::fromLatin1("/proc/%1/smaps_rollup").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        file.setFileName(QString::fromLatin1("/proc/%1/smaps").arg(pid));
+        if (!file.open(QIODevice::ReadOnly))
+            return -1;
+    }
+
+    qint64 pss = -1;
+    char line[256];
+    while (file.readLine(line, sizeof(line)) > 0) {
+        if (strncmp(line, "Pss:", 4) == 0)
+            pss = qMax(pss, Q_INT64_C(0)) + strtoll(line + 4, NULL, 10) * 1024;
+    }
+    return pss;
+#else
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
+/*!
+  Send signal \a sig to the process referred to by \a pidfd.  Unlike
+  kill(), this can never hit an unrelated process that has reused the
+  pid.  Returns true on success.
+ */
+
+bool QProcUtils::sendSignalToPidFd(int pidfd, int sig)
+{
+#if defined(Q_OS_LINUX)
+    return ::syscall(__NR_pidfd_send_signal, pidfd, sig, NULL, 0) == 0;
+#else
+    Q_UNUSED(pidfd);
+    Q_UNUSED(sig);
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+#if defined(Q_OS_LINUX)
+/*
+  Read the parent pid and the state out of /proc/<pid>/stat.  The
+  command name may contain spaces and parentheses, so we scan from the
+  last ')'.
+ */
+
+static pid_t readParentPid(const char *pid, char *state)
+{
+    char path[64];
+    ::snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+    char buf[512];
+    ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    if (n <= 0)
+        return -1;
+    buf[n] = 0;
+    const char *p = ::strrchr(buf, ')');
+    if (!p || p[1] != ' ' || !p[2] || p[3] != ' ')
+        return -1;
+    *state = p[2];
+    return ::strtol(p + 4, NULL, 10);   // ") S 1234"
+}
+
+/*
+  Scan /proc once, filling \a children with the children of every
+  process and \a states with the state of every process.
+ */
+
+static void readProcessTable(QMultiHash<pid_t, pid_t> *children, QHash<pid_t, char> *states)
+{
+    DIR *dir = ::opendir("/proc");
+    if (!dir)
+        return;
+
+    struct dirent *entry;
+    while ((entry = ::readdir(dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+            continue;
+        char state;
+        pid_t ppid = readParentPid(entry->d_name, &state);
+        if (ppid < 0)
+            continue;
+        pid_t pid = ::strtol(entry->d_name, NULL, 10);
+        if (ppid > 0)
+            children->insert(ppid, pid);
+        if (states)
+            states->insert(pid, state);
+    }
+    ::closedir(dir);
+}
+
+/*
+  Walk \a children down from \a pid.  Children come before their own
+  children.
+ */
+
+static QList<pid_t> walkDescendants(const QMultiHash<pid_t, pid_t>& children, pid_t pid)
+{
+    QList<pid_t> result = children.values(pid);
+    for (int i = 0 ; i < result.size() ; i++)
+        result << children.values(result.at(i));
+    return result;
+}
+#endif
+
+/*!
+  Return every descendant of \a pid, walking the parent links in
+  /proc.  Children come before their own children.  A descendant that
+  has called setsid() or setpgid() is still found, as long as its
+  chain of parents back to \a pid is intact.
+ */
+
+QList<pid_t> QProcUtils::descendantsForPid(pid_t pid)
+{
+    QList<pid_t> result;
+#if defined(Q_OS_LINUX)
+    QMultiHash<pid_t, pid_t> children;
+    readProcessTable(&children, NULL);
+    result = walkDescendants(children, pid);
+#else
+    Q_UNUSED(pid);
+#endif
+    return result;
+}
+
+/*!
+  \class QProcessTree
+  \brief The QProcessTree class tracks every descendant of a process being stopped
+  \inmodule QtProcessManager
+
+  Signalling a process group misses any descendant that moved to a
+  group or session of its own.  QProcessTree freezes the tree with
+  SIGSTOP, walks it through /proc, and signals every member it finds.
+  Descendants are remembered, so later signals still reach them after
+  they have been reparented.  remaining() reports how many of them
+  have not yet exited.
+
+  On Linux each member is held through a pidfd, so a recycled pid is
+  never signalled by mistake.
+ */
+
+QProcessTree::QProcessTree()
+{
+}
+
+QProcessTree::~QProcessTree()
+{
+    clear();
+}
+
+/*!
+  Send \a sig to \a pid, its process group and every descendant.
+  Descendants found on earlier calls are signalled as well.
+ */
+
+void QProcessTree::signal(pid_t pid, int sig)
+{
+#if defined(Q_OS_LINUX)
+    // Freeze the tree so that nothing can fork while we walk it.  Each
+    // round reads /proc once; a member stopped in this round may have
+    // forked after the read, so we go round until nothing new turns up.
+    // Processes that were already stopped are left stopped afterwards.
+    QList<pid_t> frozen;
+    char name[16];
+    char state = 0;
+    ::snprintf(name, sizeof(name), "%d", pid);
+    if ((readParentPid(name, &state) < 0 || state != 'T') && ::kill(pid, SIGSTOP) == 0)
+        frozen << pid;
+    forever {
+        QMultiHash<pid_t, pid_t> children;
+        QHash<pid_t, char> states;
+        readProcessTable(&children, &states);
+        bool grew = false;
+        foreach (pid_t child, walkDescendants(children, pid)) {
+            if (m_pids.contains(child))
+                continue;
+            int fd = QProcUtils::openPidFd(child);
+            if (fd == -1 && errno == ESRCH)
+                continue;
+            m_pids << child;
+            m_fds << fd;
+            if (states.value(child) != 'T' && ::kill(child, SIGSTOP) == 0)
+                frozen << child;
+            grew = true;
+        }
+        if (!grew)
+            break;
+    }
+
+    QProcUtils::sendSignalToProcess(pid, sig);
+    signalDescendants(sig);
+    if (sig != SIGKILL) {
+        foreach (pid_t p, frozen)
+            ::kill(p, SIGCONT);
+    }
+#else
+    QProcUtils::sendSignalToProcess(pid, sig);
+#endif
+}
+
+/*!
+  Send \a sig to every tracked descendant.  This is used once the
+  process itself has exited and its pid can no longer be trusted.
+ */
+
+void QProcessTree::signalDescendants(int sig)
+{
+    // A pidfd that can't be signalled belongs to a process that has
+    // gone, and its pid may already be someone else's
+    for (int i = 0 ; i < m_pids.size() ; i++) {
+        if (m_fds.at(i) != -1)
+            QProcUtils::sendSignalToPidFd(m_fds.at(i), sig);
+        else
+            ::kill(m_pids.at(i), sig);
+    }
+}
+
+/*!
+  Forget every descendant that has exited and return the number that
+  are still alive.
+ */
+
+int QProcessTree::remaining()
+{
+    for (int i = m_pids.size() - 1 ; i >= 0 ; i--) {
+        bool gone;
+#if defined(Q_OS_LINUX)
+        if (m_fds.at(i) != -1) {
+            struct pollfd pfd;
+            pfd.fd = m_fds.at(i);
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            gone = (::poll(&pfd, 1, 0) == 1);
+        }
+        else
+#endif
+            gone = (::kill(m_pids.at(i), 0) == -1 && errno == ESRCH);
+        if (gone) {
+            if (m_fds.at(i) != -1)
+                ::close(m_fds.at(i));
+            m_pids.removeAt(i);
+            m_fds.removeAt(i);
+        }
+    }
+    return m_pids.size();
+}
+
+/*!
+  Forget every tracked descendant without signalling them.
+ */
+
+void QProcessTree::clear()
+{
+    foreach (int fd, m_fds)
+        if (fd != -1)
+            ::close(fd);
+    m_pids.clear();
+    m_fds.clear();
+}
+
 #include "moc_qprocutils.cpp"
 
 QT_END_NAMESPACE_PROCESSMANAGER
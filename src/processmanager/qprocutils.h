@@ -116,6 +116,30 @@ public:
     static void   setPriority(pid_t pid, qint32 priority);
     static int    getThreadCount(pid_t pid);
     static QList<qint32> getThreadPriorities(pid_t pid);
+
+    static int    openPidFd(pid_t pid);
+    static bool   sendSignalToPidFd(int pidfd, int sig);
+    static qint64 pssForPid(pid_t pid);
+    static QList<pid_t> descendantsForPid(pid_t pid);
+};
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QProcessTree
+{
+public:
+    QProcessTree();
+    ~QProcessTree();
+
+    void  signal(pid_t pid, int sig);
+    void  signalDescendants(int sig);
+    int   remaining();
+    void  clear();
+    bool  isEmpty() const { return m_pids.isEmpty(); }
+    QList<pid_t> pids() const { return m_pids; }
+
+private:
+    Q_DISABLE_COPY(QProcessTree)
+    QList<pid_t> m_pids;
+    QList<int>   m_fds;   // pidfd for each entry of m_pids, or -1
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,438 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QFile>
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include "qpsiidledelegate.h"
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+const int    kIdleTimerInterval = 1000;
+const int    kDefaultWindow = 2000;   // Unprivileged triggers need a multiple of 2 seconds
+const double kDefaultLoadThreshold = 0.1;
+
+/*!
+  \class QPsiIdleDelegate
+  \brief The QPsiIdleDelegate class generates \l{idleCpuAvailable()} signals from pressure stall information.
+  \inmodule QtProcessManager
+
+  The QPsiIdleDelegate decides whether the system has room for more
+  work from the kernel's pressure stall information (PSI) in
+  \c{/proc/pressure}.  Rather than sampling how busy the CPU or a disk
+  is, PSI reports how much of the time runnable tasks were actually
+  delayed waiting for the CPU, for I/O or for memory.  A busy but
+  uncontended system is therefore still considered idle.
+
+  When idle CPU resources are requested the delegate registers a PSI
+  trigger for each of the \l{resources}: the kernel wakes us when
+  tasks have been stalled for more than \l{loadThreshold} of any
+  \l{window}.  The idleCpuAvailable() signal is emitted once no trigger
+  has fired for \l{idleInterval} (or a full window, if that is longer).
+  Nothing is read while the system stays quiet.
+
+  Kernels before 5.2 and unprivileged processes on kernels before 6.5
+  can't register triggers.  The delegate then falls back to reading
+  the ten second averages once per idleInterval, and \l{eventDriven}
+  is false.
+*/
+
+/*!
+  \property QPsiIdleDelegate::idleInterval
+  \brief Time in milliseconds without pressure before a new idle CPU request will be fulfilled
+ */
+
+/*!
+  \property QPsiIdleDelegate::loadThreshold
+  \brief Fraction of the window that tasks may be stalled while we still generate idle CPU requests.
+
+  This value is a double that ranges from 0.0 to 1.0.  A value greater
+  than or equal to 1.0 guarantees that \l{idleCpuAvailable()} signals
+  will always be emitted.  A value less than 0.0 blocks all \l{idleCpuAvailable()}
+  signals.
+ */
+
+/*!
+  \property QPsiIdleDelegate::window
+  \brief The PSI trigger window in milliseconds, from 500 to 10000.
+
+  Unprivileged processes may only use multiples of 2000.
+ */
+
+/*!
+  \property QPsiIdleDelegate::resources
+  \brief The pressure files that are watched.
+
+  The default is \c{cpu}, \c{io} and \c{memory}.
+ */
+
+/*!
+  \property QPsiIdleDelegate::eventDriven
+  \brief True if the delegate is woken by PSI triggers rather than reading averages.
+ */
+
+/*!
+    Construct a QPsiIdleDelegate with an optional \a parent.
+*/
+
+QPsiIdleDelegate::QPsiIdleDelegate(QObject *parent)
+    : QIdleDelegate(parent)
+    , m_idleInterval(kIdleTimerInterval)
+    , m_window(kDefaultWindow)
+    , m_loadThreshold(kDefaultLoadThreshold)
+    , m_eventDriven(false)
+{
+    m_resources << QStringLiteral("cpu") << QStringLiteral("io") << QStringLiteral("memory");
+    connect(&m_timer, SIGNAL(timeout()), SLOT(timeout()));
+}
+
+QPsiIdleDelegate::~QPsiIdleDelegate()
+{
+    closeTriggers();
+}
+
+/*!
+    Turn on or off idle requests based on \a state.
+*/
+
+void QPsiIdleDelegate::handleStateChange(bool state)
+{
+    if (state)
+        start();
+    else
+        stop();
+}
+
+/*
+  Register the triggers (if the threshold needs them) and start
+  waiting for a quiet interval
+ */
+
+void QPsiIdleDelegate::start()
+{
+    bool triggers = m_loadThreshold >= 0 && m_loadThreshold < 1.0 && openTriggers();
+    setEventDriven(triggers);
+    m_timer.setInterval(triggers ? qMax(m_idleInterval, m_window) : m_idleInterval);
+    m_timer.start();
+}
+
+void QPsiIdleDelegate::stop()
+{
+    m_timer.stop();
+    closeTriggers();
+}
+
+/*
+  Open a trigger on each pressure file.  Return false, with nothing
+  left open, if any of them can't be registered.
+ */
+
+bool QPsiIdleDelegate::openTriggers()
+{
+    closeTriggers();
+#if defined(Q_OS_LINUX)
+    qint64 window = qint64(m_window) * 1000;
+    qint64 stall = qMax(qint64(1), qint64(m_loadThreshold * window));
+    char trigger[64];
+    int len = ::snprintf(trigger, sizeof(trigger), "some %lld %lld",
+                         (long long) stall, (long long) window);
+
+    foreach (const QString& resource, m_resources) {
+        QByteArray path = "/proc/pressure/" + resource.toLatin1();
+        int fd = ::open(path.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd != -1 && ::write(fd, trigger, len + 1) == len + 1) {
+            QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Exception, this);
+            notifier->setObjectName(resource);
+            connect(notifier, SIGNAL(activated(int)), SLOT(triggerActivated(int)));
+            m_notifiers << notifier;
+            continue;
+        }
+        if (errno != ENOENT && errno != EACCES && errno != EPERM)
+            qWarning("Unable to register PSI trigger on %s: %s", path.constData(), strerror(errno));
+        if (fd != -1)
+            ::close(fd);
+        closeTriggers();
+        return false;
+    }
+    return !m_notifiers.isEmpty();
+#else
+    return false;
+#endif
+}
+
+void QPsiIdleDelegate::closeTriggers()
+{
+    foreach (QSocketNotifier *notifier, m_notifiers) {
+        int fd = notifier->socket();
+        delete notifier;
+#if defined(Q_OS_LINUX)
+        ::close(fd);
+#else
+        Q_UNUSED(fd);
+#endif
+    }
+    m_notifiers.clear();
+}
+
+/*!
+  Return the highest ten second "some" pressure of the watched
+  resources, as a number from 0.0 to 1.0.  Returns 1.0 if the pressure
+  can't be read.
+ */
+
+double QPsiIdleDelegate::pressure() const
+{
+    double result = 1.0;  // Always report max in case of error
+#if defined(Q_OS_LINUX)
+    bool found = false;
+    foreach (const QString& resource, m_resources) {
+        QFile file(QStringLiteral("/proc/pressure/") + resource);
+        if (!file.open(QIODevice::ReadOnly))
+            return 1.0;
+        // some avg10=1.23 avg60=0.50 avg300=0.10 total=12345
+        QByteArray line = file.readLine();
+        int index = line.indexOf("avg10=");
+        if (!line.startsWith("some ") || index == -1)
+            return 1.0;
+        int end = line.indexOf(' ', index);
+        double value = line.mid(index + 6, end - index - 6).toDouble() / 100.0;
+        if (!found || value > result)
+            result = value;
+        found = true;
+    }
+#endif
+    return result;
+}
+
+/*
+  In event driven mode the timer only runs out after a quiet interval;
+  otherwise we sample the averages.
+ */
+
+void QPsiIdleDelegate::timeout()
+{
+    if (m_loadThreshold < 0)
+        return;
+    if (m_eventDriven || m_loadThreshold >= 1.0) {
+        emit idleCpuAvailable();
+        return;
+    }
+    double load = pressure();
+    if (load <= m_loadThreshold)
+        emit idleCpuAvailable();
+    emit loadUpdate(load);
+}
+
+/*
+  A trigger fired, so tasks are being held up.  Wait for another quiet interval.
+ */
+
+void QPsiIdleDelegate::triggerActivated(int)
+{
+    QSocketNotifier *notifier = qobject_cast<QSocketNotifier *>(sender());
+    m_timer.start();
+    emit loadUpdate(pressure());
+    if (notifier)
+        emit pressureStall(notifier->objectName());
+}
+
+/*!
+  Return the current idle interval in milliseconds
+ */
+
+int QPsiIdleDelegate::idleInterval() const
+{
+    return m_idleInterval;
+}
+
+/*!
+  Set the current idle interval to \a interval milliseconds
+*/
+
+void QPsiIdleDelegate::setIdleInterval(int interval)
+{
+    if (m_idleInterval != interval) {
+        m_idleInterval = interval;
+        if (enabled() && requested())
+            start();
+        emit idleIntervalChanged();
+    }
+}
+
+/*!
+  Return the current load threshold as a number from 0.0 to 1.0
+ */
+
+double QPsiIdleDelegate::loadThreshold() const
+{
+    return m_loadThreshold;
+}
+
+/*!
+  Set the current load threshold to \a threshold.  Registered
+  triggers are replaced to match.
+*/
+
+void QPsiIdleDelegate::setLoadThreshold(double threshold)
+{
+    if (m_loadThreshold != threshold) {
+        m_loadThreshold = threshold;
+        if (enabled() && requested())
+            start();
+        emit loadThresholdChanged();
+    }
+}
+
+/*!
+  Return the trigger window in milliseconds
+ */
+
+int QPsiIdleDelegate::window() const
+{
+    return m_window;
+}
+
+/*!
+  Set the trigger window to \a window milliseconds
+*/
+
+void QPsiIdleDelegate::setWindow(int window)
+{
+    window = qBound(500, window, 10000);
+    if (m_window != window) {
+        m_window = window;
+        if (enabled() && requested())
+            start();
+        emit windowChanged();
+    }
+}
+
+/*!
+  Return the watched pressure resources
+ */
+
+QStringList QPsiIdleDelegate::resources() const
+{
+    return m_resources;
+}
+
+/*!
+  Set the watched pressure \a resources.  Valid names are \c{cpu},
+  \c{io} and \c{memory}.
+*/
+
+void QPsiIdleDelegate::setResources(const QStringList& resources)
+{
+    if (m_resources != resources) {
+        m_resources = resources;
+        if (enabled() && requested())
+            start();
+        emit resourcesChanged();
+    }
+}
+
+/*!
+  Return true if the delegate is woken by PSI triggers
+ */
+
+bool QPsiIdleDelegate::eventDriven() const
+{
+    return m_eventDriven;
+}
+
+void QPsiIdleDelegate::setEventDriven(bool eventDriven)
+{
+    if (m_eventDriven != eventDriven) {
+        m_eventDriven = eventDriven;
+        emit eventDrivenChanged();
+    }
+}
+
+/*!
+  \fn void QPsiIdleDelegate::idleIntervalChanged()
+  This signal is emitted when the idleInterval is changed.
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::loadThresholdChanged()
+  This signal is emitted when the loadThreshold is changed.
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::windowChanged()
+  This signal is emitted when the window is changed.
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::resourcesChanged()
+  This signal is emitted when the resources are changed.
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::eventDrivenChanged()
+  This signal is emitted when the delegate switches between PSI
+  triggers and reading averages.
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::loadUpdate(double load)
+  This signal is emitted when the pressure is read.  It mainly
+  serves as a debugging signal.  The \a load value will
+  range between 0.0 and 1.0
+ */
+
+/*!
+  \fn void QPsiIdleDelegate::pressureStall(const QString& resource)
+  This signal is emitted when the trigger on \a resource fires.
+ */
+
+#include "moc_qpsiidledelegate.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PSI_IDLE_DELEGATE_H
+#define PSI_IDLE_DELEGATE_H
+
+#include <QTimer>
+#include <QStringList>
+#include "qidledelegate.h"
+
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QPsiIdleDelegate : public QIdleDelegate
+{
+    Q_OBJECT
+    Q_PROPERTY(int idleInterval READ idleInterval WRITE setIdleInterval NOTIFY idleIntervalChanged)
+    Q_PROPERTY(double loadThreshold READ loadThreshold WRITE setLoadThreshold NOTIFY loadThresholdChanged)
+    Q_PROPERTY(int window READ window WRITE setWindow NOTIFY windowChanged)
+    Q_PROPERTY(QStringList resources READ resources WRITE setResources NOTIFY resourcesChanged)
+    Q_PROPERTY(bool eventDriven READ eventDriven NOTIFY eventDrivenChanged)
+
+public:
+    explicit QPsiIdleDelegate(QObject *parent = 0);
+    virtual ~QPsiIdleDelegate();
+
+    int     idleInterval() const;
+    void    setIdleInterval(int interval);
+
+    double  loadThreshold() const;
+    void    setLoadThreshold(double threshold);
+
+    int     window() const;
+    void    setWindow(int window);
+
+    QStringList resources() const;
+    void        setResources(const QStringList& resources);
+
+    bool    eventDriven() const;
+
+    double  pressure() const;
+
+signals:
+    void idleIntervalChanged();
+    void loadThresholdChanged();
+    void windowChanged();
+    void resourcesChanged();
+    void eventDrivenChanged();
+    void loadUpdate(double);
+    void pressureStall(const QString& resource);
+
+protected:
+    virtual void handleStateChange(bool state);
+
+private slots:
+    void timeout();
+    void triggerActivated(int fd);
+
+private:
+    void start();
+    void stop();
+    bool openTriggers();
+    void closeTriggers();
+    void setEventDriven(bool);
+
+private:
+    Q_DISABLE_COPY(QPsiIdleDelegate)
+    QStringList               m_resources;
+    QTimer                    m_timer;
+    int                       m_idleInterval;
+    int                       m_window;
+    double                    m_loadThreshold;
+    bool                      m_eventDriven;
+    QList<QSocketNotifier *>  m_notifiers;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // PSI_IDLE_DELEGATE_H
@@ -0,0 +1,208 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qremoteframereader.h"
+
+#include <QJsonDocument>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+    \class QRemoteFrameReader
+    \brief The QRemoteFrameReader class splits a byte stream into remote protocol messages.
+    \inmodule QtProcessManager
+
+    Remote launchers and their controllers exchange QJsonDocument binary
+    data and compact QRemoteWireFormat frames back to back over a pipe
+    or socket.  Data is appended to the reader as it arrives and complete
+    messages are taken off the front with takeMessage() or takeFrame(),
+    depending on isCompact().
+
+    Consumed messages are not removed from the buffer one by one.  The
+    reader keeps an offset to the first unread byte and only moves the
+    remaining data down when more is appended and at least half the
+    buffer has been consumed, so decoding a burst of many small messages
+    takes linear rather than quadratic time.
+*/
+
+/*!
+  Construct an empty QRemoteFrameReader
+ */
+
+QRemoteFrameReader::QRemoteFrameReader()
+    : m_offset(0)
+{
+}
+
+/*!
+  Append \a data to the end of the buffer
+ */
+
+void QRemoteFrameReader::append(const QByteArray& data)
+{
+    buffer().append(data);
+}
+
+/*!
+  Return a reference to the underlying buffer so that new data can be
+  appended to it directly, for example by reading from a file descriptor.
+  Any consumed data is first discarded if that is cheap to do.  Only
+  append to the returned buffer; the reader still owns everything
+  already in it.
+ */
+
+QByteArray& QRemoteFrameReader::buffer()
+{
+    if (m_offset > 0 && m_offset >= m_buffer.size() / 2) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+    return m_buffer;
+}
+
+/*!
+  Return true if a complete message is waiting to be taken
+ */
+
+bool QRemoteFrameReader::hasFrame() const
+{
+    int n = frameSize();
+    return n > 0 && n <= size();
+}
+
+/*!
+  Return false if the next message starts with neither the binary JSON
+  tag nor the compact frame magic number, or claims an impossible size.
+  There is no way to resynchronize the stream after this, so the caller
+  should drop the connection.
+ */
+
+bool QRemoteFrameReader::isValid() const
+{
+    if (size() < (int) sizeof(uint))
+        return true;
+    const char *data = m_buffer.constData() + m_offset;
+    if (QJsonDocument::BinaryFormatTag != *((const uint *) data)
+        && !QRemoteWireFormat::isCompact(data, size()))
+        return false;
+    return frameSize() >= 0;
+}
+
+/*!
+  Return true if the next message is a compact frame, which should be
+  read with takeFrame() rather than takeMessage()
+ */
+
+bool QRemoteFrameReader::isCompact() const
+{
+    return QRemoteWireFormat::isCompact(m_buffer.constData() + m_offset, size());
+}
+
+/*!
+  Remove the next complete binary JSON message from the buffer and return
+  it.  Returns an empty object if no complete message is available.  A
+  compact frame is skipped with a warning.
+ */
+
+QJsonObject QRemoteFrameReader::takeMessage()
+{
+    if (!hasFrame())
+        return QJsonObject();
+    int n = frameSize();
+    if (isCompact()) {
+        qWarning("Skipping unexpected compact frame");
+        consume(n);
+        return QJsonObject();
+    }
+    // fromBinaryData() copies the data, so a raw view into our buffer is safe
+    QByteArray frame = QByteArray::fromRawData(m_buffer.constData() + m_offset, n);
+    QJsonObject object = QJsonDocument::fromBinaryData(frame).object();
+    consume(n);
+    return object;
+}
+
+/*!
+  Remove the next complete compact frame from the buffer and decode it
+  into \a frame.  Return false, leaving the buffer alone, if the next
+  message is not a complete compact frame.
+ */
+
+bool QRemoteFrameReader::takeFrame(QRemoteWireFormat::Frame& frame)
+{
+    if (!hasFrame() || !isCompact())
+        return false;
+    int n = frameSize();
+    if (!QRemoteWireFormat::decode(m_buffer.constData() + m_offset, n, frame))
+        return false;
+    consume(n);
+    return true;
+}
+
+/*!
+  Discard everything in the buffer
+ */
+
+void QRemoteFrameReader::clear()
+{
+    m_buffer.clear();
+    m_offset = 0;
+}
+
+/*
+  Return the size of the next message, 0 if its header hasn't arrived,
+  or -1 if the size is impossible
+ */
+
+int QRemoteFrameReader::frameSize() const
+{
+    return QRemoteWireFormat::frameSize(m_buffer.constData() + m_offset, size());
+}
+
+void QRemoteFrameReader::consume(int n)
+{
+    m_offset += n;
+    if (m_offset == m_buffer.size()) {   // Cheap reset when everything has been read
+        m_buffer.resize(0);
+        m_offset = 0;
+    }
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
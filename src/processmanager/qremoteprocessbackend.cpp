@@ -129,7 +129,7 @@ void QRemoteProcessBackend::setDesiredPriority(qint32 priority)
         object.insert(QRemoteProtocol::id(), m_id);
         object.insert(QRemoteProtocol::key(), QRemoteProtocol::priority());
         object.insert(QRemoteProtocol::value(), priority);
-        m_factory->send(object);
+        m_factory->sendCommand(object);
     }
 }
 
@@ -164,7 +164,7 @@ void QRemoteProcessBackend::setDesiredOomAdjustment(qint32 oomAdjustment)
         object.insert(QRemoteProtocol::id(), m_id);
         object.insert(QRemoteProtocol::key(), QRemoteProtocol::oomAdjustment());
         object.insert(QRemoteProtocol::value(), oomAdjustment);
-        m_factory->send(object);
+        m_factory->sendCommand(object);
     }
 }
 
@@ -185,13 +185,8 @@ QProcess::ProcessState QRemoteProcessBackend::state() const
 
 void QRemoteProcessBackend::start()
 {
-    if (m_factory) {
-        QJsonObject object;
-        object.insert(QRemoteProtocol::command(), QRemoteProtocol::start());
-        object.insert(QRemoteProtocol::id(), m_id);
-        object.insert(QRemoteProtocol::info(), QJsonValue::fromVariant(m_info.toMap()));
-        m_factory->send(object);
-    }
+    if (m_factory)
+        m_factory->sendStart(m_id, m_info.toMap());
 }
 
 /*!
@@ -202,13 +197,8 @@ void QRemoteProcessBackend::start()
 
 void QRemoteProcessBackend::stop(int timeout)
 {
-    if (m_factory) {
-        QJsonObject object;
-        object.insert(QRemoteProtocol::command(), QRemoteProtocol::stop());
-        object.insert(QRemoteProtocol::id(), m_id);
-        object.insert(QRemoteProtocol::timeout(), timeout);
-        m_factory->send(object);
-    }
+    if (m_factory)
+        m_factory->sendStop(m_id, timeout);
 }
 
 /*!
@@ -217,14 +207,8 @@ void QRemoteProcessBackend::stop(int timeout)
 */
 qint64 QRemoteProcessBackend::write(const char *data, qint64 maxSize)
 {
-    if (m_factory) {
-        QJsonObject object;
-        object.insert(QRemoteProtocol::command(), QRemoteProtocol::write());
-        object.insert(QRemoteProtocol::id(), m_id);
-        object.insert(QRemoteProtocol::data(), QString::fromLatin1(QByteArray(data, maxSize).toBase64()));
-        if (m_factory->send(object))
-            return maxSize;
-    }
+    if (m_factory && m_factory->sendWrite(m_id, data, maxSize))
+        return maxSize;
     return -1;
 }
 
@@ -269,10 +253,52 @@ void QRemoteProcessBackend::receive(const QJsonObject& message)
             handleStandardError(message.value(QRemoteProtocol::standarderror()).toString().toLocal8Bit());
         }
     }
+    else if (event == QRemoteProtocol::paused()) {
+        emit outputPaused(message.value(QRemoteProtocol::paused()).toBool());
+    }
     else
         qDebug() << Q_FUNC_INFO << "unrecognized message" << message;
 }
 
+/*!
+    \internal
+
+    The compact equivalent of receive(); see QRemoteWireFormat.
+*/
+
+void QRemoteProcessBackend::receiveFrame(const QRemoteWireFormat::Frame& frame)
+{
+    switch (frame.opcode) {
+    case QRemoteWireFormat::Started:
+        m_pid = frame.arg1;
+        emit started();
+        break;
+    case QRemoteWireFormat::Error:
+        m_errorString = QString::fromUtf8(frame.payload);
+        emit error(static_cast<QProcess::ProcessError>(frame.arg1));
+        break;
+    case QRemoteWireFormat::Finished:
+        emit finished(frame.arg1, static_cast<QProcess::ExitStatus>(frame.arg2));
+        break;
+    case QRemoteWireFormat::StateChanged:
+        m_state = static_cast<QProcess::ProcessState>(frame.arg1);
+        emit stateChanged(m_state);
+        break;
+    case QRemoteWireFormat::StandardOutput:
+        handleStandardOutput(frame.payload);
+        break;
+    case QRemoteWireFormat::StandardError:
+        handleStandardError(frame.payload);
+        break;
+    case QRemoteWireFormat::Paused:
+        emit outputPaused(frame.arg1 != 0);
+        break;
+    default:
+        qDebug() << Q_FUNC_INFO << "unrecognized frame" << frame.opcode;
+        break;
+    }
+}
+
 /*!
     \internal
 */
@@ -284,7 +310,7 @@ void QRemoteProcessBackend::killTimeout()
         object.insert(QRemoteProtocol::command(), QRemoteProtocol::signal());
         object.insert(QRemoteProtocol::id(), m_id);
         object.insert(QRemoteProtocol::signal(), SIGKILL);
-        m_factory->send(object);
+        m_factory->sendCommand(object);
     }
 }
 
@@ -301,6 +327,14 @@ void QRemoteProcessBackend::factoryDestroyed()
     }
 }
 
+/*!
+    \fn void QRemoteProcessBackend::outputPaused(bool paused)
+    This signal is emitted when the remote stops reading the child's output
+    because the manager has not kept up with it (\a paused is true), and
+    again when it starts reading once more.  No output is lost while paused;
+    the child simply blocks in write().
+*/
+
 #include "moc_qremoteprocessbackend.cpp"
 
 QT_END_NAMESPACE_PROCESSMANAGER
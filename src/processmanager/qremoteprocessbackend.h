@@ -47,6 +47,7 @@
 #include "qprocessmanager-global.h"
 #include "qprocessbackend.h"
 #include "qremoteprocessbackendfactory.h"
+#include "qremotewireformat.h"
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -74,10 +75,14 @@ public:
 
     virtual QString errorString() const;
 
+signals:
+    void outputPaused(bool paused);
+
 private:
     friend class QRemoteProcessBackendFactory;
     void killTimeout();
     void receive(const QJsonObject&);
+    void receiveFrame(const QRemoteWireFormat::Frame&);
     void factoryDestroyed();
 
 private:
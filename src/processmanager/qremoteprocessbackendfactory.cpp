@@ -42,6 +42,9 @@
 #include "qremoteprocessbackendfactory.h"
 #include "qremoteprocessbackend.h"
 #include "qremoteprotocol.h"
+#include "qremoteframereader.h"
+
+#include <QJsonArray>
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
@@ -79,11 +82,33 @@ const int kRemoteTimerInterval = 1000;
     \li \c{{ "command": "write", "id": NUM, "data": STRING }}
     \li Write a data string to the remote process.  We assume that the
        data string is a valid local 8 bit string.
+  \row
+    \li \c{{ "command": "startMany", "info": PROCESSINFO, "processes": [ { "id": NUM, "info": PROCESSINFO }, ... ] }}
+    \li Start several processes.  The outer \b{info} holds the values
+       shared by every process; each entry in \b{processes} adds (or
+       overrides) its own values.  Only sent once the remote process has
+       said it accepts batches.
+  \row
+    \li \c{{ "command": "stopMany", "ids": [ NUM, ... ], "timeout": NUM }}
+    \li Stop several processes with the same timeout.  Only sent once the
+       remote process has said it accepts batches.
   \row
     \li \c{{ "command": "memory", "restricted": bool }}
     \li Let the remote process know if memory use is restricted.
+  \row
+    \li \c{{ "remote": "wireformat", "version": NUM }}
+    \li Offer the newest wire format this factory can decode (see
+       QRemoteWireFormat).  A remote process that understands the offer
+       replies with the same message carrying the version it has switched
+       to, and \c{"batch": true} if it accepts \b{startMany} and
+       \b{stopMany}.  One that doesn't should ignore it.  The offer is
+       not sent by factories whose maxWireVersion() is JSON only.
   \endtable
 
+  Start and stop requests made during one pass of the event loop are
+  collected and sent as a single \b{startMany} or \b{stopMany} command
+  if the remote process accepts them.
+
   The following are events that are sent by the remote process
   to the QRemoteProcessBackendFactory:
 
@@ -109,6 +134,15 @@ const int kRemoteTimerInterval = 1000;
   \row
     \li \c{{ "event": "output", "id": NUM, "stdout": STRING, "stderr": STRING }}
     \li The process has written data to stdout and/or stderr.
+  \row
+    \li \c{{ "event": "batch", "events": [ EVENT, ... ] }}
+    \li Several events, handled in order as if they had been sent
+       separately.
+  \row
+    \li \c{{ "event": "paused", "id": NUM, "paused": BOOL }}
+    \li The remote end has stopped (or resumed) reading the process output
+       because too much of it is waiting to be delivered.  The process
+       blocks on its writes until it is resumed.
   \endtable
 */
 
@@ -119,6 +153,9 @@ const int kRemoteTimerInterval = 1000;
 QRemoteProcessBackendFactory::QRemoteProcessBackendFactory(QObject *parent)
     : QProcessBackendFactory(parent)
     , m_idCount(100)
+    , m_wireVersion(QRemoteWireFormat::JsonVersion)
+    , m_batchCommands(false)
+    , m_flushQueued(false)
 {
 }
 
@@ -186,6 +223,17 @@ QPidList QRemoteProcessBackendFactory::localInternalProcesses() const
 
 void QRemoteProcessBackendFactory::handleConnected()
 {
+    // Until the new peer agrees otherwise
+    m_wireVersion = QRemoteWireFormat::JsonVersion;
+    m_batchCommands = false;
+    flushBatch();
+
+    if (maxWireVersion() > QRemoteWireFormat::JsonVersion) {
+        QJsonObject object;
+        object.insert(QRemoteProtocol::remote(), QRemoteProtocol::wireformat());
+        object.insert(QRemoteProtocol::version(), maxWireVersion());
+        send(object);
+    }
     handleMemoryRestrictionChange();  // Sends command="memory" message
 }
 
@@ -211,6 +259,15 @@ void QRemoteProcessBackendFactory::receive(const QJsonObject& message)
         int value = (int) message.value(QRemoteProtocol::processError()).toDouble();
         emit internalProcessError(static_cast<QProcess::ProcessError>(value));
     }
+    else if (remote == QRemoteProtocol::wireformat()) {
+        int version = message.value(QRemoteProtocol::version()).toDouble();
+        m_wireVersion = qBound((int) QRemoteWireFormat::JsonVersion, version, maxWireVersion());
+        m_batchCommands = message.value(QRemoteProtocol::batch()).toBool();
+    }
+    else if (message.value(QRemoteProtocol::event()).toString() == QRemoteProtocol::batch()) {
+        foreach (const QJsonValue& value, message.value(QRemoteProtocol::events()).toArray())
+            receive(value.toObject());
+    }
     else {
         int id = message.value(QLatin1String("id")).toDouble();
         if (m_backendMap.contains(id))
@@ -218,6 +275,34 @@ void QRemoteProcessBackendFactory::receive(const QJsonObject& message)
     }
 }
 
+/*!
+  Dispatch every complete message waiting in \a reader, whether it is
+  binary JSON or a compact frame.  Subclasses that read the remote
+  stream themselves should call this when new data arrives.
+ */
+
+void QRemoteProcessBackendFactory::receiveFrames(QRemoteFrameReader& reader)
+{
+    while (reader.hasFrame()) {
+        QRemoteWireFormat::Frame frame;
+        if (reader.takeFrame(frame))
+            receiveFrame(frame);
+        else
+            receive(reader.takeMessage());
+    }
+}
+
+/*!
+  Dispatch a compact \a frame to the correct recipient
+ */
+
+void QRemoteProcessBackendFactory::receiveFrame(const QRemoteWireFormat::Frame& frame)
+{
+    QRemoteProcessBackend *backend = m_backendMap.value(frame.id);
+    if (backend)
+        backend->receiveFrame(frame);
+}
+
 /*!
   \fn bool QRemoteProcessBackendFactory::send(const QJsonObject& message)
 
@@ -225,6 +310,183 @@ void QRemoteProcessBackendFactory::receive(const QJsonObject& message)
   child process.  Return true if the message can be sent.
  */
 
+/*!
+  Send an already encoded compact \a frame to the remote process.  This
+  is only called once the remote process has agreed to a compact wire
+  format, so the default implementation, which returns false, is enough
+  for subclasses whose maxWireVersion() is QRemoteWireFormat::JsonVersion.
+ */
+
+bool QRemoteProcessBackendFactory::sendFrame(const QByteArray& frame)
+{
+    Q_UNUSED(frame);
+    return false;
+}
+
+/*!
+  Return the newest wire format this factory can send and receive.  The
+  default is QRemoteWireFormat::JsonVersion; subclasses that read their
+  stream through a QRemoteFrameReader and implement sendFrame() may
+  return a newer version.
+ */
+
+int QRemoteProcessBackendFactory::maxWireVersion() const
+{
+    return QRemoteWireFormat::JsonVersion;
+}
+
+/*!
+  \internal
+
+  Send \a size bytes of \a data to the stdin of remote process \a id
+ */
+
+bool QRemoteProcessBackendFactory::sendWrite(int id, const char *data, qint64 size)
+{
+    flushBatch();   // Make sure the process has been started first
+    if (m_wireVersion >= QRemoteWireFormat::CompactVersion) {
+        QByteArray frame;
+        QRemoteWireFormat::append(frame, QRemoteWireFormat::Write, id, 0, 0, data, size);
+        return sendFrame(frame);
+    }
+    QJsonObject object;
+    object.insert(QRemoteProtocol::command(), QRemoteProtocol::write());
+    object.insert(QRemoteProtocol::id(), id);
+    object.insert(QRemoteProtocol::data(), QString::fromLatin1(QByteArray(data, size).toBase64()));
+    return send(object);
+}
+
+/*!
+  \internal
+
+  Send a per-process command \a message after any batched commands
+  queued before it
+ */
+
+bool QRemoteProcessBackendFactory::sendCommand(const QJsonObject& message)
+{
+    flushBatch();
+    return send(message);
+}
+
+/*!
+  \internal
+
+  Start remote process \a id with \a info, batching it with other
+  starts requested during this pass of the event loop if possible
+ */
+
+void QRemoteProcessBackendFactory::sendStart(int id, const QVariantMap& info)
+{
+    if (!m_batchCommands) {
+        QJsonObject object;
+        object.insert(QRemoteProtocol::command(), QRemoteProtocol::start());
+        object.insert(QRemoteProtocol::id(), id);
+        object.insert(QRemoteProtocol::info(), QJsonValue::fromVariant(info));
+        send(object);
+        return;
+    }
+    if (!m_pendingStops.isEmpty())
+        flushBatch();   // Keep starts and stops in the order they were made
+    m_pendingStarts << qMakePair(id, info);
+    queueFlush();
+}
+
+/*!
+  \internal
+
+  Stop remote process \a id with \a timeout, batching it with other
+  stops requested during this pass of the event loop if possible
+ */
+
+void QRemoteProcessBackendFactory::sendStop(int id, int timeout)
+{
+    if (!m_batchCommands) {
+        QJsonObject object;
+        object.insert(QRemoteProtocol::command(), QRemoteProtocol::stop());
+        object.insert(QRemoteProtocol::id(), id);
+        object.insert(QRemoteProtocol::timeout(), timeout);
+        send(object);
+        return;
+    }
+    m_pendingStops[timeout] << id;
+    queueFlush();
+}
+
+void QRemoteProcessBackendFactory::queueFlush()
+{
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, "flushBatch", Qt::QueuedConnection);
+    }
+}
+
+/*!
+  \internal
+
+  Send the queued starts as one startMany command and the queued stops
+  as one stopMany command per timeout.  Values shared by every queued
+  start are sent once in the outer info object.
+ */
+
+void QRemoteProcessBackendFactory::flushBatch()
+{
+    m_flushQueued = false;
+    if (m_pendingStarts.isEmpty() && m_pendingStops.isEmpty())
+        return;
+
+    if (m_pendingStarts.size() == 1) {
+        QJsonObject object;
+        object.insert(QRemoteProtocol::command(), QRemoteProtocol::start());
+        object.insert(QRemoteProtocol::id(), m_pendingStarts.first().first);
+        object.insert(QRemoteProtocol::info(), QJsonValue::fromVariant(m_pendingStarts.first().second));
+        send(object);
+    }
+    else if (m_pendingStarts.size() > 1) {
+        QVariantMap common = m_pendingStarts.first().second;
+        for (int i = 1 ; i < m_pendingStarts.size() ; i++) {
+            const QVariantMap& info = m_pendingStarts.at(i).second;
+            QMutableMapIterator<QString, QVariant> iter(common);
+            while (iter.hasNext()) {
+                iter.next();
+                if (!info.contains(iter.key()) || info.value(iter.key()) != iter.value())
+                    iter.remove();
+            }
+        }
+
+        QJsonArray processes;
+        for (int i = 0 ; i < m_pendingStarts.size() ; i++) {
+            QVariantMap overrides = m_pendingStarts.at(i).second;
+            foreach (const QString& key, common.keys())
+                overrides.remove(key);
+            QJsonObject entry;
+            entry.insert(QRemoteProtocol::id(), m_pendingStarts.at(i).first);
+            entry.insert(QRemoteProtocol::info(), QJsonValue::fromVariant(overrides));
+            processes.append(entry);
+        }
+        QJsonObject object;
+        object.insert(QRemoteProtocol::command(), QRemoteProtocol::startMany());
+        object.insert(QRemoteProtocol::info(), QJsonValue::fromVariant(common));
+        object.insert(QRemoteProtocol::processes(), processes);
+        send(object);
+    }
+    m_pendingStarts.clear();
+
+    QMapIterator<int, QList<int> > iter(m_pendingStops);
+    while (iter.hasNext()) {
+        iter.next();
+        QJsonArray ids;
+        foreach (int id, iter.value())
+            ids.append(id);
+        QJsonObject object;
+        object.insert(QRemoteProtocol::command(), QRemoteProtocol::stopMany());
+        object.insert(QRemoteProtocol::ids(), ids);
+        object.insert(QRemoteProtocol::timeout(), iter.key());
+        send(object);
+    }
+    m_pendingStops.clear();
+}
+
 /*!
   \internal
  */
@@ -233,6 +495,21 @@ void QRemoteProcessBackendFactory::backendDestroyed(int id)
 {
     if (m_backendMap.remove(id) != 1)
         qCritical("Missing remote process backend");
+
+    // A process whose start is still queued is never started at all
+    for (int i = 0 ; i < m_pendingStarts.size() ; i++) {
+        if (m_pendingStarts.at(i).first == id) {
+            m_pendingStarts.removeAt(i);
+            QMutableMapIterator<int, QList<int> > iter(m_pendingStops);
+            while (iter.hasNext()) {
+                iter.next();
+                iter.value().removeAll(id);
+                if (iter.value().isEmpty())
+                    iter.remove();
+            }
+            break;
+        }
+    }
 }
 
 #include "moc_qremoteprocessbackendfactory.cpp"
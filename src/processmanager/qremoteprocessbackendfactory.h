@@ -43,12 +43,16 @@
 #define REMOTE_PROCESS_BACKEND_FACTORY_H
 
 #include "qprocessbackendfactory.h"
+#include "qremotewireformat.h"
 #include <QJsonObject>
 #include <QMap>
+#include <QPair>
+#include <QVariantMap>
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 class QRemoteProcessBackend;
+class QRemoteFrameReader;
 
 class Q_ADDON_PROCESSMANAGER_EXPORT QRemoteProcessBackendFactory : public QProcessBackendFactory
 {
@@ -68,14 +72,34 @@ protected:
     virtual void    handleMemoryRestrictionChange();
     virtual QPidList localInternalProcesses() const;
     virtual bool    send(const QJsonObject&) = 0;
+    virtual bool    sendFrame(const QByteArray&);
+    virtual int     maxWireVersion() const;
+    int             wireVersion() const { return m_wireVersion; }
+    void            receiveFrames(QRemoteFrameReader& reader);
+    void            receiveFrame(const QRemoteWireFormat::Frame& frame);
+
+private slots:
+    void flushBatch();
 
 private:
     void backendDestroyed(int);
+    bool sendCommand(const QJsonObject& message);
+    bool sendWrite(int id, const char *data, qint64 size);
+    void sendStart(int id, const QVariantMap& info);
+    void sendStop(int id, int timeout);
+    void queueFlush();
     friend class QRemoteProcessBackend;
 
 protected:
     int                              m_idCount;
     QMap<int, QRemoteProcessBackend*> m_backendMap;
+    int                              m_wireVersion;
+
+private:
+    bool                              m_batchCommands;  // Remote accepts startMany and stopMany
+    bool                              m_flushQueued;
+    QList< QPair<int, QVariantMap> >  m_pendingStarts;
+    QMap<int, QList<int> >            m_pendingStops;   // Indexed by timeout
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -50,17 +50,20 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
 class QRemoteProtocol {
 public:
+    static inline const QString batch() { return QStringLiteral("batch"); }
     static inline const QString command() { return QStringLiteral("command"); }
     static inline const QString data() { return QStringLiteral("data"); }
     static inline const QString error() { return QStringLiteral("error"); }
     static inline const QString errorString() { return QStringLiteral("errorString"); }
     static inline const QString event() { return QStringLiteral("event"); }
+    static inline const QString events() { return QStringLiteral("events"); }
     static inline const QString processError() { return QStringLiteral("processError"); }
     static inline const QString exitCode() { return QStringLiteral("exitCode"); }
     static inline const QString exitStatus() { return QStringLiteral("exitStatus"); }
     static inline const QString finished() { return QStringLiteral("finished"); }
     static inline const QString halt() { return QStringLiteral("halt"); }
     static inline const QString id() { return QStringLiteral("id"); }
+    static inline const QString ids() { return QStringLiteral("ids"); }
     static inline const QString idlecpurequested() { return QStringLiteral("idlecpurequested"); }
     static inline const QString idlecpuavailable() { return QStringLiteral("idlecpuavailable"); }
     static inline const QString info() { return QStringLiteral("info"); }
@@ -70,6 +73,7 @@ public:
     static inline const QString memory() { return QStringLiteral("memory"); }
     static inline const QString oomAdjustment() { return QStringLiteral("oomAdjustment"); }
     static inline const QString output() { return QStringLiteral("output"); }
+    static inline const QString paused() { return QStringLiteral("paused"); }
     static inline const QString pid() { return QStringLiteral("pid"); }
     static inline const QString priority() { return QStringLiteral("priority"); }
     static inline const QString processes() { return QStringLiteral("processes"); }
@@ -79,14 +83,18 @@ public:
     static inline const QString set() { return QStringLiteral("set"); }
     static inline const QString signal() { return QStringLiteral("signal"); }
     static inline const QString start() { return QStringLiteral("start"); }
+    static inline const QString startMany() { return QStringLiteral("startMany"); }
     static inline const QString started() { return QStringLiteral("started"); }
     static inline const QString stateChanged() { return QStringLiteral("stateChanged"); }
     // Under Bionic, stderr & stdout are macros, so they can't be used as function names
     static inline const QString standarderror() { return QStringLiteral("stderr"); }
     static inline const QString standardout() { return QStringLiteral("stdout"); }
     static inline const QString stop() { return QStringLiteral("stop"); }
+    static inline const QString stopMany() { return QStringLiteral("stopMany"); }
     static inline const QString timeout() { return QStringLiteral("timeout"); }
     static inline const QString value() { return QStringLiteral("value"); }
+    static inline const QString version() { return QStringLiteral("version"); }
+    static inline const QString wireformat() { return QStringLiteral("wireformat"); }
     static inline const QString write() { return QStringLiteral("write"); }
 };
 
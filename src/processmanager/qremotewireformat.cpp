@@ -0,0 +1,209 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qremotewireformat.h"
+#include "qremoteprotocol.h"
+
+#include <QJsonDocument>
+#include <QtEndian>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+    \class QRemoteWireFormat
+    \brief The QRemoteWireFormat class encodes and decodes compact remote protocol frames.
+    \inmodule QtProcessManager
+
+    The remote protocol was originally carried entirely as QJsonDocument
+    binary data.  The messages sent most often (process output, state
+    changes and writes) have a small fixed vocabulary, so version 1 of the
+    wire format sends them as compact frames instead: a fixed 24 byte
+    little endian header followed by raw bytes.
+
+    \table
+    \header
+      \li Offset
+      \li Field
+    \row
+      \li 0
+      \li The magic number "QPMC"
+    \row
+      \li 4
+      \li Opcode (16 bits)
+    \row
+      \li 6
+      \li Wire format version (16 bits)
+    \row
+      \li 8
+      \li Process id
+    \row
+      \li 12
+      \li First argument; for example the pid, state, exit code or timeout
+    \row
+      \li 16
+      \li Second argument; for example the exit status
+    \row
+      \li 20
+      \li Payload size in bytes
+    \endtable
+
+    Binary JSON documents start with a different tag, so both kinds of
+    frame may be mixed on one stream and anything without a compact
+    encoding is still sent as JSON.  A controller offers compact frames
+    by sending \c{{ "remote": "wireformat", "version": NUM }} when it
+    connects.  A launcher that understands the offer replies with the
+    version it will use and starts sending compact frames.  Launchers
+    that don't reply are sent JSON.
+*/
+
+/*!
+  \enum QRemoteWireFormat::Version
+
+  \value JsonVersion     Every message is a binary JSON document
+  \value CompactVersion  Common messages are sent as compact frames
+  \value CurrentVersion  The newest version this library understands
+*/
+
+/*!
+  Return true if the \a size bytes at \a data start a compact frame.
+  At least four bytes must be available to tell.
+ */
+
+bool QRemoteWireFormat::isCompact(const char *data, int size)
+{
+    return size >= 4 && qFromLittleEndian<quint32>((const uchar *) data) == kMagic;
+}
+
+/*!
+  Return the total size of the frame that starts at \a data, either
+  compact or binary JSON, or 0 if not enough of the \a size bytes
+  have arrived to tell.  Return -1 if the frame claims a size that is
+  negative or larger than kMaxFrameSize; the stream can't be trusted
+  after that.
+ */
+
+int QRemoteWireFormat::frameSize(const char *data, int size)
+{
+    qint32 length;
+    if (isCompact(data, size)) {
+        if (size < kHeaderSize)
+            return 0;
+        length = qFromLittleEndian<qint32>((const uchar *) data + 20);
+        if (length < 0 || length > kMaxFrameSize - kHeaderSize)
+            return -1;
+        return kHeaderSize + length;
+    }
+    if (size < 12)   // QJsonDocuments are at least this large
+        return 0;
+    length = qFromLittleEndian<qint32>((const uchar *) data + 8);
+    if (length < 0 || length > kMaxFrameSize - 8)
+        return -1;
+    return length + 8;
+}
+
+/*!
+  Decode the compact frame of \a size bytes at \a data into \a frame.
+  Return false if it isn't a complete compact frame.
+ */
+
+bool QRemoteWireFormat::decode(const char *data, int size, Frame& frame)
+{
+    if (!isCompact(data, size) || size < kHeaderSize)
+        return false;
+    const uchar *p = (const uchar *) data;
+    int payloadSize = qFromLittleEndian<qint32>(p + 20);
+    if (payloadSize < 0 || size < kHeaderSize + payloadSize)
+        return false;
+    frame.opcode  = static_cast<Opcode>(qFromLittleEndian<quint16>(p + 4));
+    frame.id      = qFromLittleEndian<qint32>(p + 8);
+    frame.arg1    = qFromLittleEndian<qint32>(p + 12);
+    frame.arg2    = qFromLittleEndian<qint32>(p + 16);
+    frame.payload = QByteArray(data + kHeaderSize, payloadSize);
+    return true;
+}
+
+/*!
+  Append a compact frame to \a out with \a opcode, process \a id, the
+  arguments \a arg1 and \a arg2 and \a size bytes of \a payload.
+ */
+
+void QRemoteWireFormat::append(QByteArray& out, Opcode opcode, qint32 id, qint32 arg1, qint32 arg2,
+                               const char *payload, int size)
+{
+    int offset = out.size();
+    out.resize(offset + kHeaderSize + size);
+    uchar *p = (uchar *) out.data() + offset;
+    qToLittleEndian<quint32>(kMagic, p);
+    qToLittleEndian<quint16>(opcode, p + 4);
+    qToLittleEndian<quint16>(CurrentVersion, p + 6);
+    qToLittleEndian<qint32>(id, p + 8);
+    qToLittleEndian<qint32>(arg1, p + 12);
+    qToLittleEndian<qint32>(arg2, p + 16);
+    qToLittleEndian<qint32>(size, p + 20);
+    if (size)
+        memcpy(p + kHeaderSize, payload, size);
+}
+
+/*!
+  Encode \a message for a peer that has agreed to wire format \a version.
+  Commands with a compact form are sent that way; everything else is
+  sent as binary JSON.  Writes are not converted here, as their data
+  would have to be base64 decoded again; senders pass the raw bytes
+  straight to append() with the Write opcode instead.
+ */
+
+QByteArray QRemoteWireFormat::encode(const QJsonObject& message, int version)
+{
+    if (version >= CompactVersion) {
+        QString command = message.value(QRemoteProtocol::command()).toString();
+        int id = message.value(QRemoteProtocol::id()).toDouble();
+        QByteArray out;
+        if (command == QRemoteProtocol::stop()) {
+            append(out, Stop, id, message.value(QRemoteProtocol::timeout()).toDouble());
+            return out;
+        }
+    }
+    return QJsonDocument(message).toBinaryData();
+}
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef REMOTE_WIRE_FORMAT_H
+#define REMOTE_WIRE_FORMAT_H
+
+#include <QByteArray>
+#include <QJsonObject>
+
+#include "qprocessmanager-global.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QRemoteWireFormat
+{
+public:
+    enum Version {
+        JsonVersion = 0,
+        CompactVersion = 1,
+        CurrentVersion = CompactVersion
+    };
+
+    enum Opcode {
+        Invalid = 0,
+        // Events sent by the remote launcher
+        Started = 1,
+        StateChanged,
+        Finished,
+        Error,
+        StandardOutput,
+        StandardError,
+        Paused,
+        // Commands sent to the remote launcher
+        Stop = 64,
+        Write
+    };
+
+    struct Frame {
+        Frame() : opcode(Invalid), id(0), arg1(0), arg2(0) {}
+        Opcode     opcode;
+        qint32     id;
+        qint32     arg1;
+        qint32     arg2;
+        QByteArray payload;
+    };
+
+    static const int     kHeaderSize = 24;
+    static const int     kMaxFrameSize = 64 * 1024 * 1024;
+    static const quint32 kMagic = 0x434d5051;  // "QPMC" in little endian order
+
+    static bool isCompact(const char *data, int size);
+    static int  frameSize(const char *data, int size);
+    static bool decode(const char *data, int size, Frame& frame);
+
+    static void append(QByteArray& out, Opcode opcode, qint32 id, qint32 arg1 = 0, qint32 arg2 = 0,
+                       const char *payload = 0, int size = 0);
+    static QByteArray encode(const QJsonObject& message, int version);
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // REMOTE_WIRE_FORMAT_H
@@ -0,0 +1,262 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QDebug>
+
+#include "qrulematchdelegate.h"
+#include "qprocessinfo.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+  \class QRuleMatchDelegate
+  \brief The QRuleMatchDelegate class matches against a list of declarative rules.
+  \inmodule QtProcessManager
+
+  The QRuleMatchDelegate class matches a QProcessInfo record against a
+  list of rules.  The record matches if every rule matches.  Each rule is
+  a map with a "key" entry naming a QProcessInfo value, and any of the
+  following conditions on that value:
+
+  \table
+  \header \li Entry \li Condition
+  \row \li equals \li The value is equal to this value
+  \row \li prefix \li The value, as a string, starts with this string
+  \row \li matches \li The value, as a string, contains a match for this regular expression
+  \row \li min \li The value, as a number, is at least this number
+  \row \li max \li The value, as a number, is at most this number
+  \endtable
+
+  A rule with only a key requires the key to be present.  Keys may use
+  dots to reach into map values, so "environment.LANG" names the LANG
+  environment variable.
+
+  The rules are compiled when they are set, including the regular
+  expressions, so matching a record costs no script evaluation.  From
+  QML the rules are written as a JavaScript array:
+
+  \qml
+  StandardProcessBackendFactory {
+      matchDelegate: RuleMatchDelegate {
+          rules: [ { key: "program", prefix: "/usr/bin/" },
+                   { key: "priority", min: 0, max: 10 } ]
+      }
+  }
+  \endqml
+
+  A rule with an "equals" condition on a plain key lets the
+  QProcessBackendManager index the factory by that value.
+*/
+
+/*!
+  \property QRuleMatchDelegate::rules
+  \brief The list of rules a QProcessInfo record must match.
+ */
+
+/*!
+  \property QRuleMatchDelegate::valid
+  \brief True if every rule compiled.  An invalid delegate matches nothing.
+ */
+
+/*!
+    Construct a QRuleMatchDelegate with an optional \a parent.
+*/
+
+QRuleMatchDelegate::QRuleMatchDelegate(QObject *parent)
+    : QMatchDelegate(parent)
+    , m_valid(true)
+{
+}
+
+/*!
+    \fn QRuleMatchDelegate::matches(const QProcessInfo& info)
+    \brief Return true if \a info matches every rule.
+*/
+
+bool QRuleMatchDelegate::matches(const QProcessInfo& info)
+{
+    if (!m_valid)
+        return false;
+    foreach (const Condition& condition, m_conditions)
+        if (!check(condition, info))
+            return false;
+    return true;
+}
+
+/*!
+    Return the first "equals" rule on a plain key as the index
+    \a key and \a value.
+*/
+
+bool QRuleMatchDelegate::indexEntry(QString *key, QVariant *value) const
+{
+    foreach (const Condition& condition, m_conditions) {
+        if (condition.hasEquals && condition.path.size() == 1) {
+            *key = condition.path.first();
+            *value = condition.equals;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+  Return the current rules
+*/
+
+QVariantList QRuleMatchDelegate::rules() const
+{
+    return m_rules;
+}
+
+/*!
+  Set and compile a new list of \a rules.  Rules that fail to
+  compile are reported with a warning and make the delegate invalid.
+ */
+
+void QRuleMatchDelegate::setRules(const QVariantList& rules)
+{
+    m_rules = rules;
+    m_conditions.clear();
+    m_valid = true;
+    foreach (const QVariant& rule, rules) {
+        Condition condition;
+        if (compile(rule, condition))
+            m_conditions.append(condition);
+        else
+            m_valid = false;
+    }
+    emit rulesChanged();
+    emit indexChanged();
+}
+
+/*!
+  Return true if all rules compiled
+*/
+
+bool QRuleMatchDelegate::isValid() const
+{
+    return m_valid;
+}
+
+/*
+  Compile a single \a rule into \a condition
+ */
+
+bool QRuleMatchDelegate::compile(const QVariant& rule, Condition& condition)
+{
+    QVariantMap map = rule.toMap();
+    QString key = map.value(QStringLiteral("key")).toString();
+    if (key.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "rule without a key" << rule;
+        return false;
+    }
+    condition.path = key.split(QLatin1Char('.'));
+
+    QVariantMap::const_iterator it;
+    for (it = map.constBegin() ; it != map.constEnd() ; ++it) {
+        bool ok = true;
+        if (it.key() == QLatin1String("key"))
+            continue;
+        else if (it.key() == QLatin1String("equals")) {
+            condition.hasEquals = true;
+            condition.equals = it.value();
+        }
+        else if (it.key() == QLatin1String("prefix"))
+            condition.prefix = it.value().toString();
+        else if (it.key() == QLatin1String("matches")) {
+            condition.regex.setPattern(it.value().toString());
+            ok = condition.regex.isValid();
+        }
+        else if (it.key() == QLatin1String("min")) {
+            condition.hasMin = true;
+            condition.min = it.value().toDouble(&ok);
+        }
+        else if (it.key() == QLatin1String("max")) {
+            condition.hasMax = true;
+            condition.max = it.value().toDouble(&ok);
+        }
+        else
+            ok = false;
+
+        if (!ok) {
+            qWarning() << Q_FUNC_INFO << "invalid condition" << it.key() << it.value() << "for" << key;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  Return true if \a info satisfies \a condition
+ */
+
+bool QRuleMatchDelegate::check(const Condition& condition, const QProcessInfo& info)
+{
+    QVariant value = info.value(condition.path.first());
+    for (int i = 1 ; i < condition.path.size() && value.isValid() ; i++)
+        value = value.toMap().value(condition.path.at(i));
+    if (!value.isValid())
+        return false;
+
+    if (condition.hasEquals && value != condition.equals)
+        return false;
+    if (!condition.prefix.isEmpty() && !value.toString().startsWith(condition.prefix))
+        return false;
+    if (!condition.regex.pattern().isEmpty() && !condition.regex.match(value.toString()).hasMatch())
+        return false;
+    if (condition.hasMin || condition.hasMax) {
+        bool ok;
+        double number = value.toDouble(&ok);
+        if (!ok || (condition.hasMin && number < condition.min) || (condition.hasMax && number > condition.max))
+            return false;
+    }
+    return true;
+}
+
+/*!
+  \fn void QRuleMatchDelegate::rulesChanged()
+  Signal emitted when the rules on this delegate have been changed.
+*/
+
+#include "moc_qrulematchdelegate.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef RULE_MATCH_DELEGATE_H
+#define RULE_MATCH_DELEGATE_H
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVariant>
+
+#include "qmatchdelegate.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QRuleMatchDelegate : public QMatchDelegate
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList rules READ rules WRITE setRules NOTIFY rulesChanged)
+    Q_PROPERTY(bool valid READ isValid NOTIFY rulesChanged)
+
+public:
+    explicit QRuleMatchDelegate(QObject *parent = 0);
+    virtual bool matches(const QProcessInfo& info);
+    virtual bool indexEntry(QString *key, QVariant *value) const;
+
+    QVariantList rules() const;
+    void         setRules(const QVariantList& rules);
+    bool         isValid() const;
+
+signals:
+    void rulesChanged();
+
+private:
+    struct Condition {
+        Condition() : hasEquals(false), hasMin(false), hasMax(false), min(0), max(0) {}
+        QStringList        path;
+        bool               hasEquals;
+        QVariant           equals;
+        QString            prefix;
+        QRegularExpression regex;
+        bool               hasMin;
+        bool               hasMax;
+        double             min;
+        double             max;
+    };
+    bool compile(const QVariant& rule, Condition& condition);
+    static bool check(const Condition& condition, const QProcessInfo& info);
+
+private:
+    Q_DISABLE_COPY(QRuleMatchDelegate)
+
+private:
+    QVariantList     m_rules;
+    QList<Condition> m_conditions;
+    bool             m_valid;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // RULE_MATCH_DELEGATE_H
@@ -0,0 +1,264 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QDebug>
+
+#include "qrulerewritedelegate.h"
+#include "qprocessinfo.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+/*!
+  \class QRuleRewriteDelegate
+  \brief The QRuleRewriteDelegate class rewrites QProcessInfo records with a list of declarative rules.
+  \inmodule QtProcessManager
+
+  The QRuleRewriteDelegate class applies a list of rules, in order, to a
+  QProcessInfo record.  Each rule is a map with a "key" entry naming a
+  QProcessInfo value and exactly one of the following operations:
+
+  \table
+  \header \li Entry \li Operation
+  \row \li set \li Replace the value with this value
+  \row \li append \li Append this value to a list value (or all elements,
+       if it is itself a list), or this string to a string value.
+       A missing value is set.
+  \row \li remove \li If \c{true}, remove the key.  Otherwise remove
+       this value (or all of its elements, if it is a list) from a list
+       value, or remove the key if its value is equal to this value.
+  \endtable
+
+  Keys may use dots to reach into map values, so "environment.LANG"
+  names the LANG environment variable.
+
+  The rules are compiled when they are set, so a rewrite costs no
+  script evaluation.  From QML the rules are written as a JavaScript
+  array:
+
+  \qml
+  StandardProcessBackendFactory {
+      rewriteDelegate: RuleRewriteDelegate {
+          rules: [ { key: "arguments", append: "--verbose" },
+                   { key: "environment.QT_DEBUG_PLUGINS", set: "1" } ]
+      }
+  }
+  \endqml
+*/
+
+/*!
+  \property QRuleRewriteDelegate::rules
+  \brief The list of rules applied to each QProcessInfo record.
+ */
+
+/*!
+  \property QRuleRewriteDelegate::valid
+  \brief True if every rule compiled.  Rules that fail to compile are not applied.
+ */
+
+/*!
+    Construct a QRuleRewriteDelegate with an optional \a parent.
+*/
+
+QRuleRewriteDelegate::QRuleRewriteDelegate(QObject *parent)
+    : QRewriteDelegate(parent)
+    , m_valid(true)
+{
+}
+
+/*!
+    \fn void QRuleRewriteDelegate::rewrite(QProcessInfo& info)
+
+    Apply the rules in order to the QProcessInfo \a info structure.
+*/
+
+void QRuleRewriteDelegate::rewrite(QProcessInfo& info)
+{
+    foreach (const Action& action, m_actions) {
+        const QString& key = action.path.first();
+        if (action.path.size() == 1) {
+            QVariant result;
+            if (apply(action, info.value(key), result))
+                info.setValue(key, result);
+            else
+                info.remove(key);
+            continue;
+        }
+
+        // Walk down the nested maps, then store them back on the way up
+        QList<QVariantMap> maps;
+        maps << info.value(key).toMap();
+        for (int i = 1 ; i < action.path.size() - 1 ; i++)
+            maps << maps.last().value(action.path.at(i)).toMap();
+
+        const QString& leaf = action.path.last();
+        QVariant result;
+        if (apply(action, maps.last().value(leaf), result))
+            maps.last().insert(leaf, result);
+        else if (maps.last().remove(leaf) == 0)
+            continue;   // Nothing changed, so don't create the maps on the way down
+        for (int i = maps.size() - 1 ; i > 0 ; i--)
+            maps[i - 1].insert(action.path.at(i), maps.at(i));
+        info.setValue(key, maps.first());
+    }
+}
+
+/*!
+  Return the current rules
+*/
+
+QVariantList QRuleRewriteDelegate::rules() const
+{
+    return m_rules;
+}
+
+/*!
+  Set and compile a new list of \a rules.  Rules that fail to
+  compile are reported with a warning and skipped.
+ */
+
+void QRuleRewriteDelegate::setRules(const QVariantList& rules)
+{
+    m_rules = rules;
+    m_actions.clear();
+    m_valid = true;
+    foreach (const QVariant& rule, rules) {
+        Action action;
+        if (compile(rule, action))
+            m_actions.append(action);
+        else
+            m_valid = false;
+    }
+    emit rulesChanged();
+}
+
+/*!
+  Return true if all rules compiled
+*/
+
+bool QRuleRewriteDelegate::isValid() const
+{
+    return m_valid;
+}
+
+/*
+  Compile a single \a rule into \a action
+ */
+
+bool QRuleRewriteDelegate::compile(const QVariant& rule, Action& action)
+{
+    QVariantMap map = rule.toMap();
+    QString key = map.take(QStringLiteral("key")).toString();
+    if (key.isEmpty() || map.size() != 1) {
+        qWarning() << Q_FUNC_INFO << "a rewrite rule needs a key and one operation" << rule;
+        return false;
+    }
+    action.path = key.split(QLatin1Char('.'));
+    action.value = map.constBegin().value();
+
+    QString operation = map.constBegin().key();
+    if (operation == QLatin1String("set"))
+        action.operation = Set;
+    else if (operation == QLatin1String("append"))
+        action.operation = Append;
+    else if (operation == QLatin1String("remove"))
+        action.operation = Remove;
+    else {
+        qWarning() << Q_FUNC_INFO << "unknown operation" << operation << "for" << key;
+        return false;
+    }
+    return true;
+}
+
+/*
+  Apply \a action to the \a current value.  Return false if the key
+  should be removed, otherwise store the new value in \a result.
+ */
+
+bool QRuleRewriteDelegate::apply(const Action& action, const QVariant& current, QVariant& result)
+{
+    bool isList = (current.type() == QVariant::List || current.type() == QVariant::StringList);
+
+    switch (action.operation) {
+    case Set:
+        result = action.value;
+        return true;
+    case Append:
+        if (isList) {
+            QVariantList list = current.toList();
+            if (action.value.type() == QVariant::List || action.value.type() == QVariant::StringList)
+                list.append(action.value.toList());
+            else
+                list.append(action.value);
+            result = list;
+        }
+        else if (current.isValid())
+            result = current.toString() + action.value.toString();
+        else
+            result = action.value;
+        return true;
+    case Remove:
+        if (action.value.type() == QVariant::Bool && action.value.toBool())
+            return false;
+        if (isList) {
+            QVariantList list = current.toList();
+            if (action.value.type() == QVariant::List || action.value.type() == QVariant::StringList) {
+                foreach (const QVariant& v, action.value.toList())
+                    list.removeAll(v);
+            }
+            else
+                list.removeAll(action.value);
+            result = list;
+            return true;
+        }
+        result = current;
+        return current.isValid() && current != action.value;
+    }
+    return true;
+}
+
+/*!
+  \fn void QRuleRewriteDelegate::rulesChanged()
+  Signal emitted when the rules on this delegate have been changed.
+*/
+
+#include "moc_qrulerewritedelegate.cpp"
+
+QT_END_NAMESPACE_PROCESSMANAGER
@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef RULE_REWRITE_DELEGATE_H
+#define RULE_REWRITE_DELEGATE_H
+
+#include <QStringList>
+#include <QVariant>
+
+#include "qrewritedelegate.h"
+
+QT_BEGIN_NAMESPACE_PROCESSMANAGER
+
+class Q_ADDON_PROCESSMANAGER_EXPORT QRuleRewriteDelegate : public QRewriteDelegate
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList rules READ rules WRITE setRules NOTIFY rulesChanged)
+    Q_PROPERTY(bool valid READ isValid NOTIFY rulesChanged)
+
+public:
+    explicit QRuleRewriteDelegate(QObject *parent = 0);
+    virtual void rewrite(QProcessInfo& info);
+
+    QVariantList rules() const;
+    void         setRules(const QVariantList& rules);
+    bool         isValid() const;
+
+signals:
+    void rulesChanged();
+
+private:
+    enum Operation { Set, Append, Remove };
+    struct Action {
+        QStringList path;
+        Operation   operation;
+        QVariant    value;
+    };
+    bool compile(const QVariant& rule, Action& action);
+    static bool apply(const Action& action, const QVariant& current, QVariant& result);
+
+private:
+    Q_DISABLE_COPY(QRuleRewriteDelegate)
+
+private:
+    QVariantList  m_rules;
+    QList<Action> m_actions;
+    bool          m_valid;
+};
+
+QT_END_NAMESPACE_PROCESSMANAGER
+
+#endif // RULE_REWRITE_DELEGATE_H
@@ -42,7 +42,6 @@
 #include <QDebug>
 #include <QLocalSocket>
 #include <QJsonDocument>
-#include <QtEndian>
 
 #include "qsocketprocessbackendfactory.h"
 
@@ -123,14 +122,12 @@ void QSocketProcessBackendFactory::setSocketName(const QString& socketname)
 
 void QSocketProcessBackendFactory::readyRead()
 {
-    m_buffer.append(m_socket->readAll());
-    while (m_buffer.size() >= 12) {   // QJsonDocuments are at least this large
-        qint32 message_size = qFromLittleEndian(((qint32 *)m_buffer.data())[2]) + 8;
-        if (m_buffer.size() < message_size)
-            break;
-        QByteArray msg = m_buffer.left(message_size);
-        m_buffer = m_buffer.mid(message_size);
-        receive(QJsonDocument::fromBinaryData(msg).object());
+    m_reader.append(m_socket->readAll());
+    receiveFrames(m_reader);
+    if (!m_reader.isValid()) {
+        qWarning("Invalid data from %s; disconnecting", qPrintable(m_socket->serverName()));
+        m_reader.clear();
+        m_socket->abort();
     }
 }
 
@@ -140,6 +137,7 @@ void QSocketProcessBackendFactory::readyRead()
 
 void QSocketProcessBackendFactory::connected()
 {
+    m_reader.clear();
     handleConnected();
 }
 
@@ -159,7 +157,25 @@ void QSocketProcessBackendFactory::disconnected()
 bool QSocketProcessBackendFactory::send(const QJsonObject& message)
 {
     return (m_socket->isValid() &&
-            m_socket->write(QJsonDocument(message).toBinaryData()) != -1);
+            m_socket->write(QRemoteWireFormat::encode(message, wireVersion())) != -1);
+}
+
+/*!
+  \internal
+ */
+
+bool QSocketProcessBackendFactory::sendFrame(const QByteArray& frame)
+{
+    return (m_socket->isValid() && m_socket->write(frame) != -1);
+}
+
+/*!
+  \internal
+ */
+
+int QSocketProcessBackendFactory::maxWireVersion() const
+{
+    return QRemoteWireFormat::CurrentVersion;
 }
 
 /*!
@@ -43,6 +43,7 @@
 #define SOCKET_PROCESS_BACKEND_FACTORY_H
 
 #include "qremoteprocessbackendfactory.h"
+#include "qremoteframereader.h"
 
 class QLocalSocket;
 
@@ -66,6 +67,8 @@ signals:
 
 protected:
     virtual bool send(const QJsonObject&);
+    virtual bool sendFrame(const QByteArray&);
+    virtual int  maxWireVersion() const;
 
 private slots:
     void readyRead();
@@ -74,7 +77,7 @@ private slots:
 
 private:
     QLocalSocket *m_socket;
-    QByteArray    m_buffer;
+    QRemoteFrameReader m_reader;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -41,14 +41,20 @@
 
 #include "qunixprocessbackend.h"
 #include "qunixsandboxprocess_p.h"
+#include "qcgroup.h"
 #include "qprocutils.h"
 #include <sys/resource.h>
 #include <errno.h>
 #include <signal.h>
+#include <QDateTime>
 #include <QDebug>
+#include <QFile>
 
 QT_BEGIN_NAMESPACE_PROCESSMANAGER
 
+const int kDrainInterval = 10;   // How often we poll for remaining descendants
+const int kDrainLimit    = 5000; // How long descendants may survive SIGKILL
+
 /*!
     \class QUnixProcessBackend
     \brief The QUnixProcessBackend class wraps a QProcess object
@@ -62,19 +68,26 @@ QT_BEGIN_NAMESPACE_PROCESSMANAGER
 QUnixProcessBackend::QUnixProcessBackend(const QProcessInfo &info, QObject *parent)
     : QProcessBackend(info, parent)
     , m_process(0)
+    , m_ownsCgroup(false)
+    , m_stopTimeout(0)
+    , m_exitCode(0)
+    , m_exitStatus(QProcess::NormalExit)
 {
+    m_drainTimer.setInterval(kDrainInterval);
+    connect(&m_drainTimer, SIGNAL(timeout()), SLOT(drainTimeout()));
 }
 
 /*!
   Destroy this process object.
   Any created QProcess is a child of this object, so it will be automatically terminated.
-  We have to do some special processing to terminate the process group.
+  We have to do some special processing to terminate the process group
+  and any descendants that left it.
 */
 
 QUnixProcessBackend::~QUnixProcessBackend()
 {
-    if (m_process && m_process->state() != QProcess::NotRunning)
-        QProcUtils::sendSignalToProcess(m_process->pid(), SIGKILL);
+    killTree(SIGKILL);
+    m_tree.signalDescendants(SIGKILL);
 }
 
 /*!
@@ -172,9 +185,20 @@ bool QUnixProcessBackend::createProcess()
 
     qint64 uid = (m_info.contains(QProcessInfoConstants::Uid) ? m_info.uid() : -1);
     qint64 gid = (m_info.contains(QProcessInfoConstants::Gid) ? m_info.gid() : -1);
-    m_process = new QUnixSandboxProcess(uid, gid, m_info.umask(), m_info.dropCapabilities(), this);
+    QUnixSandboxProcess *process = new QUnixSandboxProcess(uid, gid, m_info.umask(),
+                                                           m_info.dropCapabilities(), this);
+    if (QCgroup::needsCgroup(m_info)) {
+        m_cgroup = QCgroup::create(m_info, &m_ownsCgroup);
+        if (!m_cgroup.isEmpty())
+            process->setCgroup(QFile::encodeName(m_cgroup));
+    }
+    m_process = process;
 
     m_process->setReadChannel(QProcess::StandardOutput);
+    if (m_info.contains(QProcessInfoConstants::StandardOutputFile))
+        m_process->setStandardOutputFile(m_info.standardOutputFile(), QIODevice::Append);
+    if (m_info.contains(QProcessInfoConstants::StandardErrorFile))
+        m_process->setStandardErrorFile(m_info.standardErrorFile(), QIODevice::Append);
     connect(m_process, SIGNAL(readyReadStandardOutput()),
             this, SLOT(readyReadStandardOutput()));
     connect(m_process, SIGNAL(readyReadStandardError()),
@@ -205,6 +229,7 @@ void QUnixProcessBackend::startProcess()
     }
     m_process->setProcessEnvironment(env);
     m_process->setWorkingDirectory(m_info.workingDirectory());
+    m_runTimer.start();
     m_process->start(m_info.program(), m_info.arguments());
     // qDebug() << Q_FUNC_INFO << "Started process" << m_info.program();
 }
@@ -213,6 +238,9 @@ void QUnixProcessBackend::startProcess()
     Attempts to stop a process by giving it a \a timeout time to die, measured in milliseconds.
 
     If the process does not die in the given time limit, it is killed.
+    The signals also reach every descendant of the process, including
+    those that moved to a process group or session of their own, and
+    finished() is not emitted until all of them have exited.
 
     \sa finished()
 */
@@ -222,12 +250,16 @@ void QUnixProcessBackend::stop(int timeout)
     Q_ASSERT(m_process);
 
     if (m_process->state() != QProcess::NotRunning) {
+        if (!m_stopTimer.isValid()) {
+            m_stopTimer.start();
+            m_stopTimeout = qMax(timeout, 0);
+        }
         if (timeout > 0) {
-            QProcUtils::sendSignalToProcess(m_process->pid(), SIGTERM);
+            killTree(SIGTERM);
             m_killTimer.start(timeout);
         }
         else {
-            QProcUtils::sendSignalToProcess(m_process->pid(), SIGKILL);
+            killTree(SIGKILL);
         }
     }
 }
@@ -292,6 +324,8 @@ void QUnixProcessBackend::handleProcessStateChanged(QProcess::ProcessState state
 */
 void QUnixProcessBackend::unixProcessStarted()
 {
+    m_record.pid = m_process->pid();
+    m_record.startupTime = m_runTimer.elapsed();
     handleProcessStarted();
 }
 
@@ -300,6 +334,8 @@ void QUnixProcessBackend::unixProcessStarted()
 */
 void QUnixProcessBackend::unixProcessError(QProcess::ProcessError error)
 {
+    if (error == QProcess::FailedToStart)
+        releaseCgroup();
     handleProcessError(error);
 }
 
@@ -308,6 +344,23 @@ void QUnixProcessBackend::unixProcessError(QProcess::ProcessError error)
 */
 void QUnixProcessBackend::unixProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    m_record.finishedAt = QDateTime::currentMSecsSinceEpoch();
+    m_record.wallTime = m_runTimer.elapsed();
+    if (treeRemaining()) {
+        // Hold back finished() until the rest of the tree has gone.  Whatever
+        // is left in a cgroup of our own after an unrequested exit is killed.
+        if (!m_stopTimer.isValid()) {
+            m_stopTimer.start();
+            m_stopTimeout = 0;
+        }
+        m_exitCode = exitCode;
+        m_exitStatus = exitStatus;
+        m_drainTimer.start();
+        return;
+    }
+    m_stopTimer.invalidate();
+    writeJournal(exitCode, exitStatus);
+    releaseCgroup();
     handleProcessFinished(exitCode, exitStatus);
 }
 
@@ -325,7 +378,96 @@ void QUnixProcessBackend::unixProcessStateChanged(QProcess::ProcessState state)
 void QUnixProcessBackend::killTimeout()
 {
     if (m_process && m_process->state() == QProcess::Running)
-    m_process->kill();
+        killTree(SIGKILL);
+}
+
+/*!
+    \internal
+
+    The process has exited but some of its descendants have not.  They
+    get what is left of the stop timeout before they are killed, and we
+    give up on any that survive kDrainLimit past that.
+*/
+void QUnixProcessBackend::drainTimeout()
+{
+    if (treeRemaining()) {
+        if (!m_stopTimer.hasExpired(m_stopTimeout))
+            return;
+        m_tree.signalDescendants(SIGKILL);
+        if (m_ownsCgroup)
+            QCgroup::kill(m_cgroup);
+        if (!m_stopTimer.hasExpired(m_stopTimeout + kDrainLimit))
+            return;
+        qWarning("Giving up on %d descendants of stopped process", m_tree.remaining());
+        m_tree.clear();
+    }
+    m_drainTimer.stop();
+    m_stopTimer.invalidate();
+    writeJournal(m_exitCode, m_exitStatus);
+    releaseCgroup();
+    handleProcessFinished(m_exitCode, m_exitStatus);
+}
+
+/*
+  Send \a sig to the running process and all of its descendants.  A
+  SIGKILL also empties a cgroup that belongs to this process alone.
+ */
+
+void QUnixProcessBackend::killTree(int sig)
+{
+    if (m_process && m_process->state() != QProcess::NotRunning)
+        m_tree.signal(m_process->pid(), sig);
+    if (sig == SIGKILL && m_ownsCgroup)
+        QCgroup::kill(m_cgroup);
+}
+
+/*
+  Return true if a signalled descendant is alive or our own cgroup
+  still holds a process
+ */
+
+bool QUnixProcessBackend::treeRemaining()
+{
+    bool remaining = m_tree.remaining() > 0;
+    return remaining || (m_ownsCgroup && QCgroup::isPopulated(m_cgroup));
+}
+
+void QUnixProcessBackend::releaseCgroup()
+{
+    if (m_ownsCgroup)
+        QCgroup::remove(m_cgroup);
+    m_ownsCgroup = false;
+}
+
+/*
+  Append the accounting record of the finished process to its journal.
+  QProcess reaps the process itself, so its wait4() resource usage is
+  out of reach.  The CPU, memory and I/O figures come from the cgroup
+  instead when the process had one of its own, and cover the whole
+  process tree; otherwise they are left unknown.
+ */
+
+void QUnixProcessBackend::writeJournal(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QString fileName = m_info.accountingJournal();
+    if (fileName.isEmpty() || m_record.pid <= 0)
+        return;
+
+    QProcessJournal::Record record = m_record;
+    record.name = m_info.contains(QProcessInfoConstants::Identifier) ? m_info.identifier()
+                                                                      : m_info.program();
+    record.exitCode = exitCode;
+    record.exitStatus = exitStatus;
+    if (m_ownsCgroup) {
+        QVariantMap usage = QCgroup::usage(m_cgroup);
+        record.userTime = usage.value(QStringLiteral("cpuUser"), -1).toLongLong();
+        record.systemTime = usage.value(QStringLiteral("cpuSystem"), -1).toLongLong();
+        record.maxRss = usage.value(QStringLiteral("memoryPeak"), -1).toLongLong();
+        record.readBytes = usage.value(QStringLiteral("ioReadBytes"), -1).toLongLong();
+        record.writtenBytes = usage.value(QStringLiteral("ioWriteBytes"), -1).toLongLong();
+    }
+    QProcessJournal journal(fileName);
+    journal.append(record);
 }
 
 /*!
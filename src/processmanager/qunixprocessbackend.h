@@ -43,6 +43,9 @@
 #define UNIX_PROCESS_BACKEND_H
 
 #include "qprocessbackend.h"
+#include "qprocessjournal.h"
+#include "qprocutils.h"
+#include <QElapsedTimer>
 #include <QTimer>
 
 #include "qprocessmanager-global.h"
@@ -90,12 +93,31 @@ private slots:
     void unixProcessStateChanged(QProcess::ProcessState state);
 
     void killTimeout();
+    void drainTimeout();
     void readyReadStandardOutput();
     void readyReadStandardError();
 
+private:
+    void killTree(int sig);
+    bool treeRemaining();
+    void releaseCgroup();
+    void writeJournal(int exitCode, QProcess::ExitStatus exitStatus);
+
 protected:
     QProcess           *m_process;
     QTimer              m_killTimer;
+
+private:
+    QProcessTree         m_tree;
+    QString              m_cgroup;
+    bool                 m_ownsCgroup;
+    QTimer               m_drainTimer;
+    QElapsedTimer        m_stopTimer;
+    int                  m_stopTimeout;
+    int                  m_exitCode;
+    QProcess::ExitStatus m_exitStatus;
+    QElapsedTimer        m_runTimer;
+    QProcessJournal::Record m_record;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
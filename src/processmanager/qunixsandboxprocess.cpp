@@ -41,6 +41,7 @@
 
 
 #include "qunixsandboxprocess_p.h"
+#include "qcgroup.h"
 #include <sys/stat.h>
 #include <errno.h>
 
@@ -80,6 +81,16 @@ QUnixSandboxProcess::QUnixSandboxProcess(qint64 uid, qint64 gid, qint64 umask, q
 {
 }
 
+/*!
+  Move the child process into the cgroup at \a path before it drops
+  its privileges.  The cgroup must already exist.
+*/
+
+void QUnixSandboxProcess::setCgroup(const QByteArray& path)
+{
+    m_cgroup = path;
+}
+
 /*!
   Set up child process UID, GID, and supplementary group list.
   Also set the child process to be in its own process group and fix the umask
@@ -142,6 +153,9 @@ void QUnixSandboxProcess::setupChildProcess()
     if (::setpgid(0,0))
         qFatal("QUnixSandboxProcess setpgid(): %s", strerror(errno));
 
+    if (!m_cgroup.isEmpty() && !QCgroup::attach(m_cgroup.constData(), 0))
+        qWarning("QUnixSandboxProcess unable to join cgroup %s: %s", m_cgroup.constData(), strerror(errno));
+
     if (m_umask >= 0) {
         mode_t umask = m_umask;
         ::umask(umask);
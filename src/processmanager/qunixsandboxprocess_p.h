@@ -55,6 +55,8 @@ class QUnixSandboxProcess : public QProcess
 public:
     QUnixSandboxProcess(qint64 uid, qint64 gid, qint64 umask, qint64 dropCapabilites, QObject *parent=0);
 
+    void setCgroup(const QByteArray& path);
+
 protected:
     void setupChildProcess();
 
@@ -63,6 +65,7 @@ private:
     qint64 m_gid;
     qint64 m_umask;
     qint64 m_dropCapabilities;
+    QByteArray m_cgroup;
 };
 
 QT_END_NAMESPACE_PROCESSMANAGER
@@ -43,6 +43,7 @@
 
 #include "qinfomatchdelegate.h"
 #include "qkeymatchdelegate.h"
+#include "qrulematchdelegate.h"
 
 QT_USE_NAMESPACE_PROCESSMANAGER
 
@@ -97,6 +98,7 @@ private Q_SLOTS:
     void matchKey();
     void matchProgram();
     void matchEnvironment();
+    void matchRules();
 };
 
 void TestMatcher::matchKey()
@@ -152,5 +154,51 @@ void TestMatcher::matchEnvironment()
     _testEnvironment(matcher, true, "test", "value", "test2", "value2");  // Different order
 }
 
+static QVariantMap _rule(const char *key, const char *condition, const QVariant& value)
+{
+    QVariantMap rule;
+    rule.insert(QStringLiteral("key"), QLatin1String(key));
+    if (condition)
+        rule.insert(QLatin1String(condition), value);
+    return rule;
+}
+
+void TestMatcher::matchRules()
+{
+    QProcessInfo info;
+    info.setProgram("/usr/bin/abc");
+    info.setPriority(5);
+    _makeEnvironmentInfo(info, "LANG", "en_US.UTF-8");
+
+    QRuleMatchDelegate matcher;
+    QVERIFY(matcher.matches(info));  // No rules
+
+    matcher.setRules(QVariantList() << _rule("program", "equals", "/usr/bin/abc"));
+    QVERIFY(matcher.matches(info));
+    QString key;
+    QVariant value;
+    QVERIFY(matcher.indexEntry(&key, &value));
+    QCOMPARE(key, QStringLiteral("program"));
+    QCOMPARE(value.toString(), QStringLiteral("/usr/bin/abc"));
+
+    matcher.setRules(QVariantList() << _rule("program", "prefix", "/usr/bin/")
+                                    << _rule("priority", "min", 0)
+                                    << _rule("priority", "max", 10));
+    QVERIFY(matcher.matches(info));
+    QVERIFY(!matcher.indexEntry(&key, &value));
+    info.setPriority(11);
+    QVERIFY(!matcher.matches(info));  // Out of range
+    info.setPriority(5);
+
+    matcher.setRules(QVariantList() << _rule("environment.LANG", "matches", "^en_"));
+    QVERIFY(matcher.matches(info));
+    matcher.setRules(QVariantList() << _rule("environment.LC_ALL", 0, QVariant()));
+    QVERIFY(!matcher.matches(info));  // Missing key
+
+    matcher.setRules(QVariantList() << _rule("program", "matches", "("));
+    QVERIFY(!matcher.isValid());
+    QVERIFY(!matcher.matches(info));  // Invalid rules match nothing
+}
+
 QTEST_MAIN(TestMatcher)
 #include "tst_matcher.moc"
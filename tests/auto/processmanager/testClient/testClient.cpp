@@ -47,6 +47,7 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <fcntl.h>
 
 const int kBufSize = 100;
 
@@ -86,6 +87,41 @@ void * work(void *)
     return 0;
 }
 
+/*
+  Fork a child that moves to a session of its own, out of reach of
+  our process group, and report its pid
+ */
+
+int escape()
+{
+    int fds[2];
+    if (pipe(fds) < 0)
+        return -1;
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0) {
+        setsid();
+        int fd = open("/dev/null", O_RDWR);
+        dup2(fd, STDIN_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+        close(fds[0]);
+        close(fds[1]);   // Tells the parent that setsid() is done
+        while (1)
+            pause();
+    }
+    close(fds[1]);
+    char c;
+    read(fds[0], &c, 1);
+    close(fds[0]);
+
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "escaped %d\n", pid);
+    return writeline(buffer, len);
+}
+
 static char tough[] = "tough\n";
 const int kNumThreads = 4;
 
@@ -132,6 +168,11 @@ main(int argc, char **argv)
             return 0;
         if (strncmp("crash", buffer, 5) == 0)
             return 2;
+        if (strncmp("escape", buffer, 6) == 0) {
+            if (escape() < 0)
+                return 2;
+            continue;
+        }
 
         ssize_t result = writeline(buffer, count);
         if (result < 0)
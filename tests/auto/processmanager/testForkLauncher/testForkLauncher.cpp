@@ -54,11 +54,23 @@
 #include <unistd.h>
 #include <grp.h>
 #endif
+#include <fcntl.h>
 #include <pwd.h>
 #include <signal.h>
 
 QT_USE_NAMESPACE_PROCESSMANAGER
 
+// Numbered lines, so that the test can tell if any output was lost
+static QByteArray floodData(int size)
+{
+    QByteArray data;
+    data.reserve(size + 16);
+    for (int i = 0 ; data.size() < size ; i++)
+        data += QByteArray::number(i).rightJustified(15, '0') + '\n';
+    data.truncate(size);
+    return data;
+}
+
 class Container : public QObject
 {
     Q_OBJECT
@@ -82,6 +94,14 @@ public:
             qDebug() << "Crashing";
             exit(2);
         }
+        else if (cmd.startsWith(QLatin1String("flood "))) {
+            m_outbuf.append(floodData(cmd.mid(6).toInt()));
+            m_out->setEnabled(true);
+        }
+        else if (cmd == QLatin1String("escape")) {
+            m_outbuf.append("escaped " + QByteArray::number(escape()) + '\n');
+            m_out->setEnabled(true);
+        }
         else {
             m_outbuf.append(cmd.toLatin1());
             m_outbuf.append('\n');
@@ -89,6 +109,32 @@ public:
         }
     }
 
+    // Fork a child that moves to a session of its own, out of reach
+    // of our process group
+    pid_t escape() {
+        int fds[2];
+        if (::pipe(fds) < 0)
+            return -1;
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            ::setsid();
+            int fd = ::open("/dev/null", O_RDWR);
+            ::dup2(fd, STDIN_FILENO);
+            ::dup2(fd, STDOUT_FILENO);
+            ::dup2(fd, STDERR_FILENO);
+            ::close(fd);
+            ::close(fds[0]);
+            ::close(fds[1]);   // Tells the parent that setsid() is done
+            while (1)
+                ::pause();
+        }
+        ::close(fds[1]);
+        char c;
+        ::read(fds[0], &c, 1);
+        ::close(fds[0]);
+        return pid;
+    }
+
 public slots:
     void inReady(int fd) {
         m_in->setEnabled(false);
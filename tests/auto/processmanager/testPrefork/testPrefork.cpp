@@ -44,10 +44,16 @@
 #include "qprefork.h"
 #include <QDebug>
 
+#include <string.h>
+
 QT_USE_NAMESPACE_PROCESSMANAGER
 
 int main(int argc, char **argv)
 {
     QPrefork *prefork = QPrefork::instance();
+    // Options come before the first "--"
+    for (int i = 1 ; i < argc && ::strcmp(argv[i], "--") != 0 ; i++)
+        if (!::strcmp(argv[i], "-zygote"))
+            prefork->setZygoteEnabled(true);
     prefork->execute(&argc, &argv);  // This function never returns
 }
@@ -47,9 +47,100 @@
 
 #include "qsocketlauncher.h"
 #include "qpreforkprocessbackendfactory.h"
+#include "qprefork.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
 
 QT_USE_NAMESPACE_PROCESSMANAGER
 
+#define CHECK(cond) do { if (!(cond)) { qWarning("Check failed at line %d: %s", __LINE__, #cond); return 1; } } while (0)
+
+/*
+  True if \a pid has gone completely, not even left as a zombie
+ */
+
+static bool isGone(pid_t pid)
+{
+    return ::access(QByteArray("/proc/" + QByteArray::number(pid)).constData(), F_OK) != 0;
+}
+
+static bool waitGone(pid_t pid)
+{
+    for (int i = 0 ; i < 200 && !isGone(pid) ; i++)
+        ::usleep(10000);
+    return isGone(pid);
+}
+
+static bool killAndWait(const QPreforkChildData *data)
+{
+    ::kill(data->pid, SIGKILL);
+    struct pollfd pfd;
+    pfd.fd = data->pidfd;
+    pfd.events = POLLIN;
+    return ::poll(&pfd, 1, 2000) == 1;
+}
+
+/*
+  Exercise the zygote.  Expects two children on the command line, so
+  that one master child can be respawned and the other released.
+  Exits with 2 if there is no zygote (no pidfd support).
+ */
+
+static int zygoteSelfTest()
+{
+    QPrefork *prefork = QPrefork::instance();
+    if (prefork->zygoteFd() == -1)
+        return 2;
+    CHECK(prefork->size() == 2);
+
+    // Grow the pool
+    int index = prefork->spawn(0);
+    CHECK(index == 2);
+    CHECK(prefork->at(index)->pid > 0 && !isGone(prefork->at(index)->pid));
+    CHECK(prefork->at(index)->pidfd != -1);
+
+    // Replace a master child that was killed; it must not be left a zombie
+    pid_t old = prefork->at(0)->pid;
+    CHECK(killAndWait(prefork->at(0)));
+    CHECK(prefork->respawn(0));
+    CHECK(isGone(old));
+    CHECK(prefork->at(0)->pid != old && !isGone(prefork->at(0)->pid));
+
+    // Replace a zygote child that was killed
+    old = prefork->at(index)->pid;
+    CHECK(killAndWait(prefork->at(index)));
+    CHECK(prefork->respawn(index));
+    CHECK(prefork->at(index)->pid != old && !isGone(prefork->at(index)->pid));
+    CHECK(waitGone(old));
+
+    // Release a master child and a zygote child
+    old = prefork->at(1)->pid;
+    prefork->release(1);
+    CHECK(prefork->at(1)->pid == 0);
+    CHECK(isGone(old));
+    old = prefork->at(index)->pid;
+    prefork->release(index);
+    CHECK(prefork->at(index)->pid == 0);
+    CHECK(waitGone(old));
+
+    // A released slot is reused
+    CHECK(prefork->spawn(1) == 1);
+    CHECK(!isGone(prefork->at(1)->pid));
+
+    // A zygote child that doesn't act on SIGTERM is killed on release.
+    // A stopped process leaves SIGTERM pending until it is continued.
+    index = prefork->spawn(0);
+    CHECK(index == 2);
+    old = prefork->at(index)->pid;
+    ::kill(old, SIGSTOP);
+    ::usleep(100000);
+    prefork->release(index);
+    CHECK(waitGone(old));
+    return 0;
+}
+
 extern "C" Q_DECL_EXPORT int main(int argc, char **argv)
 {
     QtAddOn::QtJsonStream::QJsonServer::ValidatorFlags flags(QtAddOn::QtJsonStream::QJsonServer::NoValidation);
@@ -58,6 +149,8 @@ extern "C" Q_DECL_EXPORT int main(int argc, char **argv)
     QCoreApplication app(argc, argv);
     QStringList args = QCoreApplication::arguments();
     QString progname = args.takeFirst();
+    if (args.value(0) == QStringLiteral("-selftest"))
+        return zygoteSelfTest();
 
     QSocketLauncher launcher;
     QPreforkProcessBackendFactory *factory = new QPreforkProcessBackendFactory;
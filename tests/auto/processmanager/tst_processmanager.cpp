@@ -43,6 +43,7 @@
 #include <QtCore/QMetaType>
 #include <QFileInfo>
 #include <QLocalSocket>
+#include <QJsonArray>
 
 #include "qprocess.h"
 #include "qprocessbackendmanager.h"
@@ -52,16 +53,28 @@
 #include "qstandardprocessbackendfactory.h"
 #include "qprocessbackend.h"
 #include "qprocessfrontend.h"
+#include "qprocessgroup.h"
 #include "qjsondocument.h"
 #include "qpipeprocessbackendfactory.h"
 #include "qsocketprocessbackendfactory.h"
+#include "qremoteframereader.h"
+#include "qlaunchpredictor.h"
 #include "qtimeoutidledelegate.h"
+#include "qkeymatchdelegate.h"
 #include "qprocutils.h"
+#include "qcgroup.h"
+#include "qprocesssnapshot.h"
+#include "qprocessevents.h"
+#include "qprocessstatistics.h"
+#include "qprocessjournal.h"
 
 #include <signal.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <sys/prctl.h>
+#endif
 
 QT_USE_NAMESPACE_PROCESSMANAGER
 
@@ -366,6 +379,49 @@ public:
     QSignalSpy stderrSpy;
 };
 
+/*
+  Collect everything a remote backend writes to stdout, along with its
+  flow control notices
+ */
+
+class OutputRecorder : public QObject {
+    Q_OBJECT
+public:
+    OutputRecorder(QProcessBackend *process) : chunks(0) {
+        connect(process, SIGNAL(standardOutput(const QByteArray&)), SLOT(handleOutput(const QByteArray&)));
+        connect(process, SIGNAL(outputPaused(bool)), SLOT(handlePaused(bool)));
+    }
+
+    void waitFor(int size, int timeout=5000) {
+        QTime stopWatch;
+        stopWatch.start();
+        forever {
+            if (received.size() >= size)
+                break;
+            if (stopWatch.elapsed() >= timeout)
+                QFAIL("Timed out");
+            QTestEventLoop::instance().enterLoop(1);
+        }
+    }
+
+private slots:
+    void handleOutput(const QByteArray& data) {
+        received += data;
+        chunks++;
+        QTestEventLoop::instance().exitLoop();
+    }
+    void handlePaused(bool paused) {
+        pauses << paused;
+        pausedAt << received.size();
+    }
+
+public:
+    QByteArray received;
+    int        chunks;
+    QList<bool> pauses;
+    QList<int>  pausedAt;   // Bytes received before each notice
+};
+
 /******************************************************************************/
 
 static void writeLine(QProcessBackend *process, const char *command)
@@ -429,6 +485,90 @@ static void startAndStopClient(QProcessBackendManager *manager, QProcessInfo inf
     cleanupProcess(process);
 }
 
+/*
+  Check the accounting record written when the process exits
+ */
+
+static void journalClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
+{
+    QString fileName = QDir::temp().filePath(QStringLiteral("tst_processmanager.journal"));
+    QFile::remove(fileName);
+    info.setIdentifier(QStringLiteral("journalClient"));
+    info.setAccountingJournal(fileName);
+
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+    Spy spy(process);
+    process->start();
+    spy.waitStart();
+    qint64 pid = process->pid();
+    func(process, "stop");
+    spy.waitFinished();
+    spy.checkExitCode(0);
+
+    QProcessJournal journal(fileName);
+    QCOMPARE(journal.count(), 1);
+    QList<QProcessJournal::Record> records = journal.read();
+    QCOMPARE(records.size(), 1);
+    QProcessJournal::Record record = records.at(0);
+    QVERIFY(record.isValid());
+    QCOMPARE(qint64(record.pid), pid);
+    QCOMPARE(record.name, QStringLiteral("journalClient"));
+    QCOMPARE(record.exitCode, 0);
+    QCOMPARE(record.exitStatus, (int) QProcess::NormalExit);
+    QVERIFY(record.finishedAt > 0);
+    QVERIFY(record.startupTime >= 0);
+    QVERIFY(record.wallTime >= record.startupTime);
+    QVERIFY(journal.read(1).isEmpty());
+
+    cleanupProcess(process);
+    QFile::remove(fileName);
+}
+
+/*
+  True if \a pid exists and is not a zombie waiting to be reaped
+ */
+
+static bool isProcessAlive(pid_t pid)
+{
+    QFile file(QString::fromLatin1("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray contents = file.readAll();
+    int index = contents.lastIndexOf(')');
+    return index != -1 && contents.size() > index + 2 && contents.at(index + 2) != 'Z';
+}
+
+static void stopTreeClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
+{
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+
+    Spy spy(process);
+    process->start();
+    spy.waitStart();
+    verifyRunning(process);
+
+    // The descendant leaves our process group, so killpg() can't reach it
+    func(process, "escape");
+    QByteArray output;
+    while (!output.contains('\n')) {
+        spy.waitStdout();
+        output += spy.stdoutSpy.last().at(0).toByteArray();
+    }
+    QVERIFY(output.startsWith("escaped "));
+    pid_t escaped = output.mid(8).trimmed().toInt();
+    QVERIFY(escaped > 0);
+    QVERIFY(isProcessAlive(escaped));
+    QVERIFY(::getpgid(escaped) != ::getpgid(process->pid()));
+
+    process->stop();
+    spy.waitFinished();
+    QVERIFY(!isProcessAlive(escaped));
+
+    cleanupProcess(process);
+}
+
 static void startAndStopMultiple(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
 {
     QProcessBackend *plist[kProcessCount];
@@ -554,6 +694,147 @@ static void echoClient(QProcessBackendManager *manager, QProcessInfo info, Comma
     cleanupProcess(process);
 }
 
+static void redirectClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
+{
+    QString filename = QDir::tempPath() + QStringLiteral("/tst_processmanager_redirect.txt");
+    QFile::remove(filename);
+    info.setStandardOutputFile(filename);
+
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+    QVERIFY(process->state() == QProcess::NotRunning);
+
+    Spy spy(process);
+    process->start();
+    spy.waitStart();
+    verifyRunning(process);
+
+    func(process, "redirecttest");
+    func(process, "stop");
+    spy.waitFinished();
+    spy.checkExitCode(0);
+    QCOMPARE(spy.stdoutSpy.count(), 0);
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("redirecttest\n"));
+    file.remove();
+
+    cleanupProcess(process);
+}
+
+/*
+  Short writes from the child are held for outputFlushInterval and sent
+  as one chunk; output reaching outputFlushSize is sent at once
+ */
+
+static void outputFlushClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
+{
+    const int kLineCount = 10;
+    info.setOutputFlushInterval(2000);
+    info.setOutputFlushSize(64);
+
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+
+    Spy spy(process);
+    OutputRecorder recorder(process);
+    process->start();
+    spy.waitStart();
+    verifyRunning(process);
+
+    // Ten separate writes of 6 bytes each, all inside the interval and
+    // together still below the flush size
+    QByteArray expected;
+    QTime stopWatch;
+    stopWatch.start();
+    for (int i = 0 ; i < kLineCount ; i++) {
+        QByteArray line = "line" + QByteArray::number(i);
+        func(process, line.constData());
+        expected += line + '\n';
+        QTest::qWait(10);
+    }
+    recorder.waitFor(expected.size(), info.outputFlushInterval() + 2000);
+    QVERIFY(stopWatch.elapsed() >= info.outputFlushInterval() / 2);
+    QVERIFY(stopWatch.elapsed() < info.outputFlushInterval() + 1000);
+    QCOMPARE(recorder.received, expected);
+    QVERIFY(recorder.chunks < kLineCount);
+
+    // A single write past the flush size doesn't wait for the interval
+    QByteArray big(100, 'x');
+    expected += big + '\n';
+    stopWatch.restart();
+    func(process, big.constData());
+    recorder.waitFor(expected.size(), info.outputFlushInterval());
+    QVERIFY(stopWatch.elapsed() < info.outputFlushInterval() / 2);
+    QCOMPARE(recorder.received, expected);
+
+    func(process, "stop");
+    spy.waitFinished();
+    spy.checkExitCode(0);
+
+    cleanupProcess(process);
+}
+
+/*
+  Must match the "flood" command of testForkLauncher
+ */
+
+static QByteArray floodData(int size)
+{
+    QByteArray data;
+    data.reserve(size + 16);
+    for (int i = 0 ; data.size() < size ; i++)
+        data += QByteArray::number(i).rightJustified(15, '0') + '\n';
+    data.truncate(size);
+    return data;
+}
+
+/*
+  The child writes far faster than we read.  The launcher must pause it
+  rather than buffer without limit, and resume it once we catch up,
+  without losing any output.
+ */
+
+static void floodClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
+{
+    const int kFloodSize = 4 * 1024 * 1024;
+
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+
+    Spy spy(process);
+    OutputRecorder recorder(process);
+    process->start();
+    spy.waitStart();
+    verifyRunning(process);
+
+    func(process, "flood 4194304");
+    recorder.waitFor(1);
+
+    // Stop reading, so the launcher fills its send buffer and then has
+    // to hold back the child
+    int beforeSleep = recorder.received.size();
+    QTest::qSleep(1000);
+
+    recorder.waitFor(kFloodSize, 20000);
+    QCOMPARE(recorder.received.size(), kFloodSize);
+    QVERIFY(recorder.received == floodData(kFloodSize));
+
+    QVERIFY(recorder.pauses.size() >= 2);
+    QCOMPARE(recorder.pauses.first(), true);
+    QCOMPARE(recorder.pauses.last(), false);
+    // Only the send buffer and the output held for the child can be
+    // ahead of the "paused" notice
+    QVERIFY(recorder.pausedAt.first() - beforeSleep < 2 * 1024 * 1024);
+
+    func(process, "stop");
+    spy.waitFinished();
+    spy.checkExitCode(0);
+
+    cleanupProcess(process);
+}
+
 static void priorityChangeBeforeClient(QProcessBackendManager *manager, QProcessInfo info, CommandFunc func)
 {
     info.setValue("priority", 19);
@@ -841,6 +1122,26 @@ static void forkLauncherTest( clientFunc func, infoFunc infoFixup=0  )
 #endif
 }
 
+/*
+  A pipe factory that records the commands it sends, so that tests can
+  see how starts and stops were batched
+ */
+
+class CommandRecorderFactory : public QPipeProcessBackendFactory
+{
+public:
+    bool negotiated() const { return wireVersion() > QRemoteWireFormat::JsonVersion; }
+
+    QList<QJsonObject> commands;
+
+protected:
+    virtual bool send(const QJsonObject& message) {
+        if (message.contains(QLatin1String("command")))
+            commands << message;
+        return QPipeProcessBackendFactory::send(message);
+    }
+};
+
 static void preforkLauncherTest( clientFunc func, infoFunc infoFixup=0 )
 {
 #if defined(Q_OS_LINUX)
@@ -896,10 +1197,13 @@ private slots:
     void standardStartAndCrash()        { standardTest(startAndCrashClient); }
     void standardFailToStart()          { standardTest(failToStartClient); }
     void standardEcho()                 { standardTest(echoClient); }
+    void standardRedirect()             { standardTest(redirectClient); }
     void standardPriorityChangeBefore() { standardTest(priorityChangeBeforeClient); }
     void standardPriorityChangeAfter()  { standardTest(priorityChangeAfterClient); }
     void standardOomChangeBefore()      { standardTest(oomChangeBeforeClient); }
     void standardOomChangeAfter()       { standardTest(oomChangeAfterClient); }
+    void standardStopTree()             { standardTest(stopTreeClient); }
+    void standardJournal()              { standardTest(journalClient); }
 
     void prelaunchStartAndStop()         { prelaunchTest(startAndStopClient); }
     void prelaunchStartAndStopMultiple() { prelaunchTest(startAndStopMultiple); }
@@ -929,10 +1233,13 @@ private slots:
     void pipeLauncherStartAndKillTough()    { pipeLauncherTest(startAndKillClient, makeTough); }
     void pipeLauncherStartAndCrash()        { pipeLauncherTest(startAndCrashClient); }
     void pipeLauncherEcho()                 { pipeLauncherTest(echoClient); }
+    void pipeLauncherRedirect()             { pipeLauncherTest(redirectClient); }
     void pipeLauncherPriorityChangeBefore() { pipeLauncherTest(priorityChangeBeforeClient); }
     void pipeLauncherPriorityChangeAfter()  { pipeLauncherTest(priorityChangeAfterClient); }
     void pipeLauncherOomChangeBefore()      { pipeLauncherTest(oomChangeBeforeClient); }
     void pipeLauncherOomChangeAfter()       { pipeLauncherTest(oomChangeAfterClient); }
+    void pipeLauncherStopTree()             { pipeLauncherTest(stopTreeClient); }
+    void pipeLauncherJournal()              { pipeLauncherTest(journalClient); }
 
     void socketLauncherStartAndStop()         { socketLauncherTest(startAndStopClient); }
     void socketLauncherStartAndStopMultiple() { socketLauncherTest(startAndStopMultiple); }
@@ -962,10 +1269,16 @@ private slots:
     void forkLauncherStartAndKillTough()    { forkLauncherTest(startAndKillClient, makeTough); }
     void forkLauncherStartAndCrash()        { forkLauncherTest(startAndCrashClient); }
     void forkLauncherEcho()                 { forkLauncherTest(echoClient); }
+    void forkLauncherRedirect()             { forkLauncherTest(redirectClient); }
     void forkLauncherPriorityChangeBefore() { forkLauncherTest(priorityChangeBeforeClient); }
     void forkLauncherPriorityChangeAfter()  { forkLauncherTest(priorityChangeAfterClient); }
     void forkLauncherOomChangeBefore()      { forkLauncherTest(oomChangeBeforeClient); }
     void forkLauncherOomChangeAfter()       { forkLauncherTest(oomChangeAfterClient); }
+    void forkLauncherStopTree()             { forkLauncherTest(stopTreeClient); }
+    void forkLauncherJournal()              { forkLauncherTest(journalClient); }
+    void forkLauncherFlowControl()          { forkLauncherTest(floodClient); }
+    void forkLauncherOutputFlush()          { forkLauncherTest(outputFlushClient); }
+    void forkLauncherBatch();
 
     void preforkLauncherStartAndStop()         { preforkLauncherTest(startAndStopClient); }
     void preforkLauncherStartAndStopMultiple() { preforkLauncherTest(startAndStopMultiple); }
@@ -977,10 +1290,13 @@ private slots:
     void preforkLauncherPriorityChangeAfter()  { preforkLauncherTest(priorityChangeAfterClient); }
     void preforkLauncherOomChangeBefore()      { preforkLauncherTest(oomChangeBeforeClient); }
     void preforkLauncherOomChangeAfter()       { preforkLauncherTest(oomChangeAfterClient); }
+    void preforkZygote();
 
     void prelaunchChildAbort();
     void prelaunchThreadPriority();
     void prelaunchWaitIdleTest();
+    void prelaunchPool();
+    void prelaunchMemoryBudget();
 
     void prelaunchForPipeLauncherIdle();
     void prelaunchForPipeLauncherMemory();
@@ -992,7 +1308,19 @@ private slots:
 
     void frontend();
     void frontendWaitIdleTest();
+    void frontendIndex();
+    void processGroup();
+    void cgroupLimits();
+    void processSnapshot();
+    void processEvents();
+    void processStatistics();
+    void executingProcessInfo();
     void subclassFrontend();
+
+    void wireFormat();
+    void processJournal();
+    void launchPredictor();
+    void dispatchIndex();
 };
 
 
@@ -1003,6 +1331,7 @@ void tst_ProcessManager::initTestCase()
     qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
     qRegisterMetaType<QProcess::ProcessState>("QProcess::ProcessState");
     qRegisterMetaType<QProcess::ProcessState>("QProcess::ProcessError");
+    qRegisterMetaType<QPidList>("QPidList");
 }
 
 void tst_ProcessManager::prelaunchChildAbort()
@@ -1113,6 +1442,89 @@ void tst_ProcessManager::prelaunchWaitIdleTest()
     delete manager;
 }
 
+void tst_ProcessManager::prelaunchPool()
+{
+    QProcessBackendManager *manager = new QProcessBackendManager;
+    QTimeoutIdleDelegate *delegate = new QTimeoutIdleDelegate;
+    delegate->setIdleInterval(250);
+    delegate->setEnabled(false);
+    manager->setIdleDelegate(delegate);
+
+    QProcessInfo info;
+    info.setValue("program", "testPrelaunch/testPrelaunch");
+    QPrelaunchProcessBackendFactory *factory = new QPrelaunchProcessBackendFactory;
+    factory->setMaximumPoolSize(3);
+    factory->setMinimumPoolSize(2);
+    factory->setProcessInfo(info);
+    manager->addFactory(factory);
+
+    // The minimum pool fills up without any idle CPU
+    waitForInternalProcess(manager, 2);
+    QCOMPARE(factory->prelaunchedCount(), 2);
+
+    // Consuming a prelaunched process refills the pool right away
+    fixUidGid(info);
+    QProcessBackend *process = manager->create(info);
+    QVERIFY(process);
+    QCOMPARE(factory->hitCount(), 1);
+    QCOMPARE(factory->missCount(), 0);
+    waitForInternalProcess(manager, 2);
+
+    // Idle CPU tops the pool up to the maximum
+    delegate->setEnabled(true);
+    waitForInternalProcess(manager, 3, delegate->idleInterval() + 2000);
+    waitForTimeout(delegate->idleInterval() + 500);
+    QCOMPARE(manager->internalProcesses().count(), 3);
+
+    // Shrinking the maximum terminates the excess processes
+    factory->setMaximumPoolSize(1);
+    QCOMPARE(factory->minimumPoolSize(), 1);
+    QCOMPARE(manager->internalProcesses().count(), 1);
+
+    factory->resetStatistics();
+    QCOMPARE(factory->hitCount(), 0);
+
+    delete process;
+    delete manager;
+}
+
+void tst_ProcessManager::prelaunchMemoryBudget()
+{
+#if defined(Q_OS_LINUX)
+    QProcessBackendManager *manager = new QProcessBackendManager;
+    QTimeoutIdleDelegate *delegate = new QTimeoutIdleDelegate;
+    delegate->setEnabled(false);
+    manager->setIdleDelegate(delegate);
+
+    QProcessInfo info;
+    info.setValue("program", "testPrelaunch/testPrelaunch");
+    QPrelaunchProcessBackendFactory *factory = new QPrelaunchProcessBackendFactory;
+    factory->setMaximumPoolSize(2);
+    factory->setMinimumPoolSize(2);
+    factory->setProcessInfo(info);
+    manager->addFactory(factory);
+    waitForInternalProcess(manager, 2);
+
+    // A generous budget measures the pool without evicting anything
+    factory->setMemoryBudget(Q_INT64_C(1) << 40);
+    QVERIFY(factory->prelaunchMemory() > 0);
+    QCOMPARE(manager->internalProcesses().count(), 2);
+
+    // A budget smaller than one process empties the pool and keeps it empty
+    factory->setMemoryBudget(1);
+    QCOMPARE(manager->internalProcesses().count(), 0);
+    QCOMPARE(factory->prelaunchMemory(), Q_INT64_C(0));
+    waitForTimeout(1000);
+    QCOMPARE(manager->internalProcesses().count(), 0);
+
+    // Removing the budget refills the pool
+    factory->setMemoryBudget(0);
+    waitForInternalProcess(manager, 2);
+
+    delete manager;
+#endif
+}
+
 /*
   The pipe launcher holds a prelaunch backend factory
   We control the prelaunch process by turning on and off the IdleDelegate
@@ -1448,6 +1860,323 @@ void tst_ProcessManager::frontend()
     delete manager;
 }
 
+void tst_ProcessManager::frontendIndex()
+{
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    info.setIdentifier("indexed");
+    QProcessFrontend *first = manager->create(info);
+    QProcessFrontend *second = manager->create(info);
+    QVERIFY(first && second);
+
+    QCOMPARE(manager->processForName(first->name()), first);
+    QCOMPARE(manager->processForName(second->name()), second);
+    QCOMPARE(manager->names(), QStringList() << first->name() << second->name());
+    QCOMPARE(manager->processesForIdentifier("indexed"), QList<QObject *>() << first << second);
+    QVERIFY(manager->processesForIdentifier("other").isEmpty());
+
+    // Only running processes are found by pid
+    Spy spy(first);
+    first->start();
+    spy.waitStart();
+    QVERIFY(first->pid());
+    QCOMPARE(manager->processForPID(first->pid()), first);
+    Q_PID pid = first->pid();
+
+    first->write("stop\n");
+    spy.waitFinished();
+    QVERIFY(!manager->processForPID(pid));
+
+    // Destroyed processes leave every index
+    QString name = first->name();
+    delete first;
+    QVERIFY(!manager->processForName(name));
+    QCOMPARE(manager->processesForIdentifier("indexed"), QList<QObject *>() << second);
+    QCOMPARE(manager->names(), QStringList() << second->name());
+
+    delete manager;
+}
+
+void tst_ProcessManager::processGroup()
+{
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    QProcessGroup *group = manager->createGroup(info, 3);
+    QVERIFY(group);
+    QCOMPARE(group->size(), 3);
+    QCOMPARE(manager->size(), 3);
+
+    QSignalSpy startedSpy(group, SIGNAL(started()));
+    QSignalSpy finishedSpy(group, SIGNAL(finished()));
+    group->start();
+    waitForSignal(startedSpy);
+    QCOMPARE(startedSpy.count(), 1);
+    QCOMPARE(group->runningCount(), 3);
+    QCOMPARE(group->failedCount(), 0);
+
+    group->setPriority(5);
+    group->setOomAdjustment(100);
+    foreach (QProcessFrontend *frontend, group->processes()) {
+        QCOMPARE(frontend->state(), QProcess::Running);
+        QCOMPARE(frontend->priority(), 5);
+        QCOMPARE(frontend->oomAdjustment(), 100);
+    }
+
+    foreach (QProcessFrontend *frontend, group->processes())
+        QCOMPARE(frontend->stopDuration(), qint64(-1));
+    group->stop();
+    waitForSignal(finishedSpy);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(group->runningCount(), 0);
+    foreach (QProcessFrontend *frontend, group->processes())
+        QVERIFY(frontend->stopDuration() >= 0);
+
+    // Destroyed processes leave the group
+    delete group->at(0);
+    QCOMPARE(group->size(), 2);
+
+    // A group that fails to start still completes
+    info.setValue("program", "thisProgramDoesNotExist");
+    QProcessGroup *failed = manager->createGroup(info, 2);
+    QVERIFY(failed);
+    QSignalSpy failedStartedSpy(failed, SIGNAL(started()));
+    QSignalSpy failedFinishedSpy(failed, SIGNAL(finished()));
+    failed->start();
+    waitForSignal(failedStartedSpy);
+    waitForSignal(failedFinishedSpy);
+    QCOMPARE(failed->failedCount(), 2);
+    QCOMPARE(failed->runningCount(), 0);
+
+    QVERIFY(!manager->createGroup(info, 0));
+
+    delete manager;
+}
+
+void tst_ProcessManager::cgroupLimits()
+{
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    QVERIFY(!QCgroup::needsCgroup(info));
+    info.setMemoryMax(64 * 1024 * 1024);
+    info.setPidsMax(16);
+    QVERIFY(QCgroup::needsCgroup(info));
+    QCOMPARE(info.memoryMax(), qint64(64 * 1024 * 1024));
+    QCOMPARE(info.pidsMax(), 16);
+
+    // A named cgroup may not leave the root
+    QString root = QCgroup::root();
+    QStringList outside;
+    outside << "../../system.slice" << "apps/../../system.slice" << "/sys/fs/cgroup" << "";
+    foreach (const QString& name, outside) {
+        QProcessInfo escape(info);
+        escape.setCgroup(name);
+        bool owned = false;
+        QTest::ignoreMessage(QtWarningMsg, qPrintable(QString("Refusing cgroup name '%1' outside of %2").arg(name).arg(root)));
+        QVERIFY(QCgroup::create(escape, &owned).isEmpty());
+    }
+
+    if (!QFile::exists(root + "/cgroup.controllers") || !QFileInfo(root).isWritable())
+        QSKIP("No delegated cgroup v2 subtree");
+
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+    QProcessFrontend *frontend = manager->create(info);
+    QVERIFY(frontend);
+    QVERIFY(frontend->resourceUsage().isEmpty());
+
+    Spy spy(frontend);
+    frontend->start();
+    spy.waitStart();
+
+    QString cgroup = QCgroup::cgroupForPid(frontend->pid());
+    QVERIFY(cgroup.startsWith(root + "/"));
+    QFile file(cgroup + "/memory.max");
+    if (file.open(QIODevice::ReadOnly))
+        QCOMPARE(file.readAll().trimmed(), QByteArray::number(64 * 1024 * 1024));
+    QVERIFY(frontend->resourceUsage().contains("pidsCurrent")
+            || frontend->resourceUsage().contains("memoryCurrent"));
+
+    frontend->stop();
+    spy.waitFinished();
+    QVERIFY(!QFile::exists(cgroup));
+
+    delete manager;
+}
+
+void tst_ProcessManager::processSnapshot()
+{
+    QProcessSnapshot snapshot;
+    QSignalSpy spawnedSpy(&snapshot, SIGNAL(spawned(QPidList)));
+    QSignalSpy exitedSpy(&snapshot, SIGNAL(exited(QPidList)));
+
+    // The first update reports everything as spawned
+    snapshot.update();
+    QVERIFY(snapshot.count() > 0);
+    QCOMPARE(spawnedSpy.count(), 1);
+    QCOMPARE(spawnedSpy.at(0).at(0).value<QPidList>().size(), snapshot.count());
+    int index = snapshot.indexOf(::getpid());
+    QVERIFY(index >= 0);
+    QCOMPARE(snapshot.pid(index), Q_PID(::getpid()));
+    QCOMPARE(snapshot.ppid(index), Q_PID(::getppid()));
+    QVERIFY(snapshot.threads(index) >= 1);
+    QVERIFY(snapshot.rss(index) > 0);
+
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    QProcessFrontend *frontend = manager->create(info);
+    QVERIFY(frontend);
+
+    Spy spy(frontend);
+    frontend->start();
+    spy.waitStart();
+    Q_PID pid = frontend->pid();
+
+    spawnedSpy.clear();
+    snapshot.update();
+    QCOMPARE(spawnedSpy.count(), 1);
+    QVERIFY(spawnedSpy.at(0).at(0).value<QPidList>().contains(pid));
+    index = snapshot.indexOf(pid);
+    QVERIFY(index >= 0);
+    QCOMPARE(snapshot.ppid(index), Q_PID(::getpid()));
+    QVERIFY(snapshot.children(::getpid()).contains(pid));
+    QVERIFY(snapshot.cpuDelta(snapshot.indexOf(::getpid())) >= 0);
+
+    frontend->stop();
+    spy.waitFinished();
+    exitedSpy.clear();
+    snapshot.update();
+    QCOMPARE(snapshot.indexOf(pid), -1);
+    QCOMPARE(exitedSpy.count(), 1);
+    QVERIFY(exitedSpy.at(0).at(0).value<QPidList>().contains(pid));
+
+    // Without cached files every stat file is opened on each update
+    QVERIFY(snapshot.maxOpenFiles() > 0 && snapshot.maxOpenFiles() <= 64);
+    snapshot.setMaxOpenFiles(0);
+    QCOMPARE(snapshot.maxOpenFiles(), 0);
+    snapshot.update();
+    QVERIFY(snapshot.indexOf(::getpid()) >= 0);
+
+    delete manager;
+}
+
+void tst_ProcessManager::processEvents()
+{
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+    QProcessEvents *events = new QProcessEvents;
+    events->setPollInterval(100);
+    manager->setProcessEvents(events);
+    QVERIFY(events->isActive());
+
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    QProcessFrontend *frontend = manager->create(info);
+    QVERIFY(frontend);
+
+    Spy spy(frontend);
+    frontend->start();
+    spy.waitStart();
+    QVERIFY(events->isWatched(frontend->pid()));
+
+    QSignalSpy startedSpy(manager, SIGNAL(descendantStarted(QProcessFrontend*, qint64)));
+    QSignalSpy finishedSpy(manager, SIGNAL(descendantFinished(QProcessFrontend*, qint64, int)));
+    frontend->write("escape\n");
+    QByteArray output;
+    while (!output.contains('\n')) {
+        spy.waitStdout();
+        output += spy.stdoutSpy.last().at(0).toByteArray();
+    }
+    QVERIFY(output.startsWith("escaped "));
+    qint64 escaped = output.mid(8).trimmed().toLongLong();
+    QVERIFY(escaped > 0);
+
+    // The helper is found even though it left the process group
+    waitForSignal(startedSpy);
+    QCOMPARE(startedSpy.at(0).at(0).value<QProcessFrontend*>(), frontend);
+    QCOMPARE(startedSpy.at(0).at(1).toLongLong(), escaped);
+    QCOMPARE(events->rootOf(escaped), Q_PID(frontend->pid()));
+
+    ::kill(escaped, SIGKILL);
+    waitForSignal(finishedSpy);
+    QCOMPARE(finishedSpy.at(0).at(1).toLongLong(), escaped);
+    if (events->eventDriven())
+        QCOMPARE(finishedSpy.at(0).at(2).toInt(), int(SIGKILL));
+    QVERIFY(!events->isWatched(escaped));
+
+    // A helper that outlives the process is still reported, and the
+    // last exit in the tree ends the watch
+    spy.stdoutSpy.clear();
+    frontend->write("escape\n");
+    output.clear();
+    while (!output.contains('\n')) {
+        spy.waitStdout();
+        output += spy.stdoutSpy.last().at(0).toByteArray();
+    }
+    escaped = output.mid(8).trimmed().toLongLong();
+    QVERIFY(escaped > 0);
+    waitForSignal(startedSpy, 2);
+
+    Q_PID pid = frontend->pid();
+    frontend->stop();
+    spy.waitFinished();
+    ::kill(escaped, SIGKILL);
+    waitForSignal(finishedSpy, 2);
+    QCOMPARE(finishedSpy.at(1).at(0).value<QProcessFrontend*>(), frontend);
+    QCOMPARE(finishedSpy.at(1).at(1).toLongLong(), escaped);
+    QVERIFY(!events->isWatched(escaped));
+    QVERIFY(!events->isWatched(pid));
+
+    delete manager;
+}
+
+void tst_ProcessManager::processStatistics()
+{
+    QVERIFY(!QProcessStatistics().isValid());
+    QProcessStatistics self = QProcessStatistics::forPid(::getpid());
+    QVERIFY(self.isValid());
+    QVERIFY(self.rss() > 0);
+    QVERIFY(self.pss() > 0 && self.pss() <= self.rss());
+    QVERIFY(self.uss() <= self.rss());
+    QCOMPARE(self.toMap().value("rss").toLongLong(), self.rss());
+
+    QProcessManager *manager = new QProcessManager;
+    manager->addBackendFactory(new QStandardProcessBackendFactory);
+    QCOMPARE(manager->samplingInterval(), 0);
+    manager->setSamplingInterval(50);
+    QCOMPARE(manager->samplingInterval(), 50);
+
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+    QProcessFrontend *frontend = manager->create(info);
+    QVERIFY(frontend);
+    QCOMPARE(frontend->rss(), Q_INT64_C(0));
+
+    Spy spy(frontend);
+    QSignalSpy statisticsSpy(frontend, SIGNAL(statisticsChanged()));
+    frontend->start();
+    spy.waitStart();
+    waitForSignal(statisticsSpy);
+    QVERIFY(frontend->statistics().isValid());
+    QVERIFY(frontend->rss() > 0);
+    QVERIFY(frontend->pss() > 0);
+    QVERIFY(frontend->cpuTime() >= 0);
+
+    // The last sample is kept once the process has gone
+    frontend->stop();
+    spy.waitFinished();
+    QVERIFY(frontend->rss() > 0);
+
+    delete manager;
+}
+
 void tst_ProcessManager::frontendWaitIdleTest()
 {
     QProcessManager *manager = new QProcessManager;
@@ -1475,6 +2204,32 @@ void tst_ProcessManager::frontendWaitIdleTest()
     delete manager;
 }
 
+void tst_ProcessManager::executingProcessInfo()
+{
+#if defined(Q_OS_LINUX)
+    // A command name with spaces and parentheses must not shift the stat fields
+    char saved[16];
+    QVERIFY(::prctl(PR_GET_NAME, saved) == 0);
+    QVERIFY(::prctl(PR_SET_NAME, "a) (b c") == 0);
+    QExecutingProcessInfo info(::getpid());
+    qint64 ppid = QProcUtils::ppidForPid(::getpid());
+    QList<pid_t> descendants = QProcUtils::descendantsForPid(::getppid());
+    ::prctl(PR_SET_NAME, saved);
+
+    QVERIFY(info.exists());
+    QCOMPARE(info.name(), QStringLiteral("a) (b c"));
+    QCOMPARE(info.pid(), ::getpid());
+    QCOMPARE(info.ppid(), ::getppid());
+    QCOMPARE(info.pgrp(), ::getpgrp());
+    QCOMPARE(info.sid(), ::getsid(0));
+    QCOMPARE(info.nice(), ::getpriority(PRIO_PROCESS, 0));
+    QCOMPARE(ppid, qint64(::getppid()));
+    QVERIFY(descendants.contains(::getpid()));
+#else
+    QSKIP("Only Linux reads the command name out of /proc");
+#endif
+}
+
 class TestProcess : public QProcessFrontend {
     Q_OBJECT
     Q_PROPERTY(QString magic READ magic WRITE setMagic NOTIFY magicChanged)
@@ -1534,6 +2289,321 @@ void tst_ProcessManager::subclassFrontend()
     delete manager;
 }
 
+void tst_ProcessManager::wireFormat()
+{
+    QJsonObject object;
+    object.insert(QStringLiteral("command"), QStringLiteral("write"));
+    object.insert(QStringLiteral("id"), 7);
+    object.insert(QStringLiteral("data"), QString::fromLatin1(QByteArray("hello").toBase64()));
+
+    // Writes are framed from their raw bytes, never from the base64 JSON form
+    QVERIFY(!QRemoteWireFormat::isCompact(QRemoteWireFormat::encode(object, QRemoteWireFormat::CompactVersion).constData(), 4));
+
+    // JSON and compact frames may be mixed on one stream
+    QByteArray stream = QRemoteWireFormat::encode(object, QRemoteWireFormat::JsonVersion);
+    QRemoteWireFormat::append(stream, QRemoteWireFormat::Write, 7, 0, 0, "hello", 5);
+    QRemoteWireFormat::append(stream, QRemoteWireFormat::Finished, 7, 3, QProcess::CrashExit);
+
+    // Feed the stream in one byte at a time to exercise partial frames
+    QRemoteFrameReader reader;
+    QList<QRemoteWireFormat::Frame> frames;
+    QList<QJsonObject> messages;
+    for (int i = 0 ; i < stream.size() ; i++) {
+        reader.append(stream.mid(i, 1));
+        QVERIFY(reader.isValid());
+        while (reader.hasFrame()) {
+            QRemoteWireFormat::Frame frame;
+            if (reader.takeFrame(frame))
+                frames << frame;
+            else
+                messages << reader.takeMessage();
+        }
+    }
+    QCOMPARE(reader.size(), 0);
+
+    QCOMPARE(messages.size(), 1);
+    QCOMPARE(messages.at(0), object);
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE((int) frames.at(0).opcode, (int) QRemoteWireFormat::Write);
+    QCOMPARE(frames.at(0).id, 7);
+    QCOMPARE(frames.at(0).payload, QByteArray("hello"));
+    QCOMPARE((int) frames.at(1).opcode, (int) QRemoteWireFormat::Finished);
+    QCOMPARE(frames.at(1).arg1, 3);
+    QCOMPARE(frames.at(1).arg2, (int) QProcess::CrashExit);
+    QVERIFY(frames.at(1).payload.isEmpty());
+
+    // A frame claiming a negative or huge payload poisons the stream
+    QByteArray bad;
+    QRemoteWireFormat::append(bad, QRemoteWireFormat::Paused, 7);
+    qToLittleEndian<qint32>(-5, (uchar *) bad.data() + 20);
+    reader.append(bad);
+    QVERIFY(!reader.isValid());
+    QVERIFY(!reader.hasFrame());
+    reader.clear();
+    qToLittleEndian<qint32>(QRemoteWireFormat::kMaxFrameSize, (uchar *) bad.data() + 20);
+    reader.append(bad);
+    QVERIFY(!reader.isValid());
+    QVERIFY(!reader.hasFrame());
+}
+
+/*
+  Starts and stops made in one pass of the event loop reach the fork
+  launcher as a single startMany and a single stopMany command, and
+  every backend still gets its own events.  A backend destroyed while
+  its start is queued is never started.
+ */
+
+void tst_ProcessManager::forkLauncherBatch()
+{
+#if defined(Q_OS_LINUX)
+    QProcessBackendManager *manager = new QProcessBackendManager;
+    QProcessInfo info;
+    info.setValue("program", "testForkLauncher/testForkLauncher");
+    CommandRecorderFactory *factory = new CommandRecorderFactory;
+    factory->setProcessInfo(info);
+    manager->addFactory(factory);
+
+    waitForInternalProcess(manager);
+    QVERIFY(manager->internalProcesses().count() == 1);
+    pid_t launcherPid = manager->internalProcesses().first();
+
+    // Batching is only used once the launcher has answered the handshake
+    QTime stopWatch;
+    stopWatch.start();
+    while (!factory->negotiated()) {
+        if (stopWatch.elapsed() >= 5000)
+            QFAIL("Timed out");
+        QTest::qWait(10);
+    }
+
+    QProcessInfo info2;
+    fixUidGid(info2);
+
+    QProcessBackend *plist[kProcessCount];
+    Spy            *slist[kProcessCount];
+    for (int i = 0 ; i < kProcessCount ; i++) {
+        plist[i] = manager->create(info2);
+        QVERIFY(plist[i]);
+        slist[i] = new Spy(plist[i]);
+    }
+    QProcessBackend *dropped = manager->create(info2);
+    QVERIFY(dropped);
+
+    factory->commands.clear();
+    for (int i = 0 ; i < kProcessCount ; i++)
+        plist[i]->start();
+    dropped->start();
+    delete dropped;
+
+    for (int i = 0 ; i < kProcessCount ; i++) {
+        slist[i]->waitStart();
+        verifyRunning(plist[i]);
+        slist[i]->check(1,0,0,2);
+    }
+    QCOMPARE(factory->commands.size(), 1);
+    QCOMPARE(factory->commands.at(0).value(QLatin1String("command")).toString(), QStringLiteral("startMany"));
+    QCOMPARE(factory->commands.at(0).value(QLatin1String("processes")).toArray().size(), kProcessCount);
+    QCOMPARE(QProcUtils::descendantsForPid(launcherPid).size(), kProcessCount);
+
+    factory->commands.clear();
+    for (int i = 0 ; i < kProcessCount ; i++)
+        plist[i]->stop();
+
+    for (int i = 0 ; i < kProcessCount ; i++) {
+        slist[i]->waitFinished();
+        slist[i]->check(1,1,1,3);
+        slist[i]->checkExitStatus(QProcess::CrashExit);
+    }
+    QCOMPARE(factory->commands.size(), 1);
+    QCOMPARE(factory->commands.at(0).value(QLatin1String("command")).toString(), QStringLiteral("stopMany"));
+    QCOMPARE(factory->commands.at(0).value(QLatin1String("ids")).toArray().size(), kProcessCount);
+
+    for (int i = 0 ; i < kProcessCount ; i++) {
+        cleanupProcess(plist[i]);
+        delete slist[i];
+    }
+    delete manager;
+#endif
+}
+
+/*
+  The prefork launcher checks spawn(), respawn() and release() from
+  inside the master process and reports through its exit code
+ */
+
+void tst_ProcessManager::preforkZygote()
+{
+#if defined(Q_OS_LINUX)
+    QProcess remote;
+    remote.setProcessChannelMode(QProcess::ForwardedChannels);
+    QStringList args;
+    args << "-zygote"
+         << "--" << "testPreforkLauncher/testPreforkLauncher" << "-selftest"
+         << "--" << "testForkLauncher/testForkLauncher"
+         << "--" << "testForkLauncher/testForkLauncher";
+    remote.start("testPrefork/testPrefork", args);
+    QVERIFY(remote.waitForStarted());
+    QVERIFY(remote.waitForFinished(15000));
+    if (remote.exitCode() == 2)
+        QSKIP("The prefork zygote needs pidfd support");
+    QCOMPARE(remote.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(remote.exitCode(), 0);
+#endif
+}
+
+void tst_ProcessManager::processJournal()
+{
+    QProcessJournal::Record record;
+    QVERIFY(!record.isValid());
+    record.pid = 1234;
+    record.exitCode = 3;
+    record.exitStatus = QProcess::CrashExit;
+    record.userTime = Q_INT64_C(5000000000);
+    record.maxRss = Q_INT64_C(1) << 40;
+    record.name = QString(13, QChar(0xe9));   // Two bytes each in UTF-8
+
+    QByteArray data = QProcessJournal::encode(record);
+    QCOMPARE(data.size(), int(QProcessJournal::kRecordSize));
+    QProcessJournal::Record copy;
+    QVERIFY(QProcessJournal::decode(data.constData(), data.size(), copy));
+    QCOMPARE(copy.pid, 1234);
+    QCOMPARE(copy.exitCode, 3);
+    QCOMPARE(copy.exitStatus, (int) QProcess::CrashExit);
+    QCOMPARE(copy.userTime, Q_INT64_C(5000000000));
+    QCOMPARE(copy.systemTime, Q_INT64_C(-1));
+    QCOMPARE(copy.maxRss, Q_INT64_C(1) << 40);
+    QCOMPARE(copy.name, QString(12, QChar(0xe9)));   // Cut on a character boundary
+
+    // Records are appended, and a reader can start where it left off
+    QString fileName = QDir::temp().filePath(QStringLiteral("tst_processjournal.journal"));
+    QFile::remove(fileName);
+    QProcessJournal journal(fileName);
+    QCOMPARE(journal.count(), 0);
+    QVERIFY(journal.append(record));
+    record.pid = 5678;
+    QVERIFY(journal.append(record));
+    QCOMPARE(journal.count(), 2);
+    QList<QProcessJournal::Record> records = journal.read(1);
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records.at(0).pid, 5678);
+
+    // A damaged record keeps its place in the list
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.write("junk");
+    file.close();
+    records = journal.read();
+    QCOMPARE(records.size(), 2);
+    QVERIFY(!records.at(0).isValid());
+    QCOMPARE(records.at(1).pid, 5678);
+    QFile::remove(fileName);
+
+    data[0] = 'x';
+    QVERIFY(!QProcessJournal::decode(data.constData(), data.size(), copy));
+}
+
+void tst_ProcessManager::launchPredictor()
+{
+    QLaunchPredictor predictor;
+    QProcessInfo mail;
+    mail.setIdentifier(QStringLiteral("mail"));
+    QProcessInfo maps;
+    maps.setIdentifier(QStringLiteral("maps"));
+
+    // Mail is opened every morning; maps once in the afternoon
+    QDate first(2013, 3, 4);
+    for (int day = 0 ; day < 5 ; day++)
+        predictor.recordLaunch(mail, QDateTime(first.addDays(day), QTime(8, 10)));
+    predictor.recordLaunch(maps, QDateTime(first.addDays(4), QTime(14, 0)));
+    QCOMPARE(predictor.identifiers().size(), 2);
+    QVERIFY(qAbs(predictor.expectedLaunches(QStringLiteral("mail"), QDateTime(first.addDays(4), QTime(8, 0))) - 1) < 0.001);
+
+    // Shortly before the habitual launch, mail is worth prelaunching
+    QDateTime morning(first.addDays(5), QTime(7, 30));
+    QHash<QString, int> plan = predictor.prewarmPlan(morning);
+    QCOMPARE(plan.value(QStringLiteral("mail")), 1);
+    QVERIFY(!plan.contains(QStringLiteral("maps")));
+
+    // A single launch of maps is not enough once a day has passed
+    QVERIFY(predictor.prewarmPlan(QDateTime(first.addDays(4), QTime(14, 0))).contains(QStringLiteral("maps")));
+    QVERIFY(!predictor.prewarmPlan(QDateTime(first.addDays(5), QTime(14, 0))).contains(QStringLiteral("maps")));
+
+    // Opening mail twice a morning asks for two instances, within the memory budget
+    for (int day = 5 ; day < 10 ; day++) {
+        predictor.recordLaunch(mail, QDateTime(first.addDays(day), QTime(8, 10)));
+        predictor.recordLaunch(mail, QDateTime(first.addDays(day), QTime(8, 40)));
+    }
+    QDateTime busy(first.addDays(9), QTime(8, 0));
+    QCOMPARE(predictor.prewarmPlan(busy).value(QStringLiteral("mail")), 2);
+    predictor.setMemoryBudget(predictor.instanceCost());
+    QCOMPARE(predictor.prewarmPlan(busy).value(QStringLiteral("mail")), 1);
+
+    // The history survives a round trip
+    QLaunchPredictor restored;
+    restored.setHistory(predictor.history());
+    QCOMPARE(restored.prewarmPlan(morning), predictor.prewarmPlan(morning));
+    QCOMPARE(restored.launchInfo(QStringLiteral("maps")).value(QStringLiteral("identifier")).toString(), QStringLiteral("maps"));
+}
+
+static int matchCalls = 0;
+
+class CountingKeyMatchDelegate : public QKeyMatchDelegate {
+public:
+    virtual bool matches(const QProcessInfo& info) { matchCalls++; return QKeyMatchDelegate::matches(info); }
+};
+
+class CountingMatchDelegate : public QMatchDelegate {
+public:
+    virtual bool matches(const QProcessInfo&) { matchCalls++; return true; }
+};
+
+void tst_ProcessManager::dispatchIndex()
+{
+    QProcessBackendManager *manager = new QProcessBackendManager;
+    QList<CountingKeyMatchDelegate *> delegates;
+    for (int i = 0 ; i < 20 ; i++) {
+        CountingKeyMatchDelegate *delegate = new CountingKeyMatchDelegate;
+        delegate->setKey(QStringLiteral("identifier"));
+        delegate->setValue(QString::fromLatin1("app%1").arg(i));
+        QStandardProcessBackendFactory *factory = new QStandardProcessBackendFactory;
+        factory->setMatchDelegate(delegate);
+        manager->addFactory(factory);
+        delegates << delegate;
+    }
+    QStandardProcessBackendFactory *fallback = new QStandardProcessBackendFactory;
+    fallback->setMatchDelegate(new CountingMatchDelegate);
+    manager->addFactory(fallback);
+
+    QProcessInfo info;
+    info.setValue("program", "testClient/testClient");
+
+    // Only the indexed factory is asked
+    info.setIdentifier(QStringLiteral("app7"));
+    matchCalls = 0;
+    QProcessBackend *backend = manager->create(info);
+    QVERIFY(backend);
+    QCOMPARE(matchCalls, 1);
+    delete backend;
+
+    // Unknown identifiers go straight to the opaque fallback
+    info.setIdentifier(QStringLiteral("other"));
+    matchCalls = 0;
+    backend = manager->create(info);
+    QVERIFY(backend);
+    QCOMPARE(matchCalls, 1);
+    delete backend;
+
+    // Changing a delegate updates the index, and factory order still wins
+    delegates.at(3)->setValue(QStringLiteral("other"));
+    matchCalls = 0;
+    backend = manager->create(info);
+    QVERIFY(backend);
+    QCOMPARE(matchCalls, 1);
+    delete backend;
+
+    delete manager;
+}
+
 QTEST_MAIN(tst_ProcessManager)
 
 #include "tst_processmanager.moc"
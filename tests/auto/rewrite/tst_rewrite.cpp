@@ -42,6 +42,7 @@
 #include <QtTest>
 
 #include "qgdbrewritedelegate.h"
+#include "qrulerewritedelegate.h"
 #include "qprocessinfo.h"
 
 QT_USE_NAMESPACE_PROCESSMANAGER
@@ -56,6 +57,7 @@ public:
 
 private Q_SLOTS:
     void rewriteGdb();
+    void rewriteRules();
 };
 
 TestRewrite::TestRewrite(QObject *parent)
@@ -80,5 +82,55 @@ void TestRewrite::rewriteGdb()
     QCOMPARE(info.arguments().at(3), QLatin1String("b"));
 }
 
+static QVariantMap _rule(const char *key, const char *operation, const QVariant& value)
+{
+    QVariantMap rule;
+    rule.insert(QStringLiteral("key"), QLatin1String(key));
+    rule.insert(QLatin1String(operation), value);
+    return rule;
+}
+
+void TestRewrite::rewriteRules()
+{
+    QProcessInfo info;
+    info.setProgram("/usr/bin/abc");
+    info.setArguments(QStringList() << "a" << "b");
+    info.setWorkingDirectory("/tmp");
+    QVariantMap env;
+    env.insert(QStringLiteral("PATH"), QStringLiteral("/bin"));
+    env.insert(QStringLiteral("DEBUG"), QStringLiteral("1"));
+    info.setEnvironment(env);
+
+    QRuleRewriteDelegate delegate;
+    delegate.setRules(QVariantList() << _rule("program", "set", "/usr/bin/xyz")
+                                     << _rule("arguments", "append", QStringList() << "c" << "d")
+                                     << _rule("arguments", "remove", "a")
+                                     << _rule("environment.PATH", "append", ":/opt/bin")
+                                     << _rule("environment.DEBUG", "remove", true)
+                                     << _rule("environment.LANG", "set", "C")
+                                     << _rule("workingDirectory", "remove", true));
+    QVERIFY(delegate.isValid());
+    delegate.rewrite(info);
+
+    QCOMPARE(info.program(), QLatin1String("/usr/bin/xyz"));
+    QCOMPARE(info.arguments(), QStringList() << "b" << "c" << "d");
+    QCOMPARE(info.environment().value("PATH").toString(), QLatin1String("/bin:/opt/bin"));
+    QCOMPARE(info.environment().value("LANG").toString(), QLatin1String("C"));
+    QVERIFY(!info.environment().contains("DEBUG"));
+    QVERIFY(!info.contains("workingDirectory"));
+
+    // Removing from a map that isn't there must not create it; an empty
+    // environment would clear the child's environment
+    QProcessInfo bare;
+    bare.setProgram("/usr/bin/abc");
+    delegate.setRules(QVariantList() << _rule("environment.FOO", "remove", true)
+                                     << _rule("environment.BAR", "remove", "1"));
+    delegate.rewrite(bare);
+    QVERIFY(!bare.contains("environment"));
+
+    delegate.setRules(QVariantList() << _rule("program", "frobnicate", true));
+    QVERIFY(!delegate.isValid());
+}
+
 QTEST_MAIN(TestRewrite)
 #include "tst_rewrite.moc"
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET   = tst_forklatency
+CONFIG  -= app_bundle
+QT      += processmanager
+QT      -= gui
+
+SOURCES = tst_forklatency.cpp
+
+# The benchmark forks copies of itself
+QMAKE_CXXFLAGS += -fPIC
+QMAKE_LFLAGS += -pie -rdynamic
@@ -0,0 +1,203 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*
+  Measure the round trip latency of a message through the fork launcher
+  as the number of idle children grows.  The program runs itself as the
+  fork launcher (with the "-launcher" argument); each forked child simply
+  echoes lines from stdin back to stdout.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QSocketNotifier>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QDebug>
+
+#include <qprocessmanager.h>
+#include <qprocessfrontend.h>
+#include <qprocessinfo.h>
+#include <qpipeprocessbackendfactory.h>
+#include <qforklauncher.h>
+
+#include <iostream>
+#include <unistd.h>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+class Echo : public QObject
+{
+    Q_OBJECT
+
+public:
+    Echo() {
+        m_in = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+        connect(m_in, SIGNAL(activated(int)), SLOT(inReady(int)));
+    }
+
+public slots:
+    void inReady(int fd) {
+        char buf[1024];
+        int n = ::read(fd, buf, sizeof(buf));
+        if (n == 0)
+            exit(0);
+        if (n > 0 && ::write(STDOUT_FILENO, buf, n) != n)
+            exit(-1);
+    }
+
+private:
+    QSocketNotifier *m_in;
+};
+
+class Bench : public QObject
+{
+    Q_OBJECT
+
+public:
+    Bench(QProcessManager *manager) : m_manager(manager), m_started(0) {}
+
+    void grow(int count) {
+        while (m_processes.size() < count) {
+            QProcessFrontend *frontend = m_manager->create(QProcessInfo());
+            connect(frontend, SIGNAL(started()), SLOT(started()));
+            connect(frontend, SIGNAL(standardOutput(const QByteArray&)),
+                    &m_loop, SLOT(quit()));
+            m_processes << frontend;
+            frontend->start();
+        }
+        while (m_started < count)
+            m_loop.exec();
+    }
+
+    // Return the mean round trip time in microseconds
+    double measure(int rounds) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0 ; i < rounds ; i++) {
+            m_processes.at(i % m_processes.size())->write("ping\n");
+            m_loop.exec();
+        }
+        return timer.nsecsElapsed() / 1000.0 / rounds;
+    }
+
+    void stopAll() {
+        foreach (QProcessFrontend *frontend, m_processes)
+            frontend->stop(0);
+    }
+
+public slots:
+    void started() {
+        m_started++;
+        m_loop.quit();
+    }
+
+private:
+    QProcessManager         *m_manager;
+    QList<QProcessFrontend*> m_processes;
+    QEventLoop               m_loop;
+    int                      m_started;
+};
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS]\n"
+             "\n"
+             "   -max N      Largest number of idle children (default 1024)\n"
+             "   -rounds N   Messages sent for each measurement (default 1000)\n"
+             "\n"
+             "Large child counts may need a higher open file limit (ulimit -n)\n"
+             , qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    for (int i = 1 ; i < argc ; i++) {
+        if (!strcmp(argv[i], "-launcher")) {
+            qForkLauncher(&argc, &argv);
+            QCoreApplication app(argc, argv);
+            Echo echo;
+            return app.exec();
+        }
+    }
+
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int max = 1024;
+    int rounds = 1000;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-max") && args.size())
+            max = args.takeFirst().toInt();
+        else if (arg == QLatin1String("-rounds") && args.size())
+            rounds = args.takeFirst().toInt();
+        else
+            usage();
+    }
+
+    QProcessInfo info;
+    info.setProgram(QCoreApplication::applicationFilePath());
+    info.setArguments(QStringList() << QStringLiteral("-launcher"));
+    QPipeProcessBackendFactory *factory = new QPipeProcessBackendFactory;
+    factory->setProcessInfo(info);
+
+    QProcessManager manager;
+    manager.addBackendFactory(factory);
+    while (manager.internalProcesses().isEmpty())
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+
+    Bench bench(&manager);
+    std::cout << "children\tusec/message" << std::endl;
+    for (int count = 1 ; count <= max ; count *= 2) {
+        bench.grow(count);
+        std::cout << count << "\t" << bench.measure(rounds) << std::endl;
+    }
+    bench.stopAll();
+    return 0;
+}
+
+#include "tst_forklatency.moc"
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET   = tst_framedecode
+CONFIG  -= app_bundle
+QT      += processmanager
+QT      -= gui
+
+SOURCES = tst_framedecode.cpp
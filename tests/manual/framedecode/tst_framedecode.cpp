@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*
+  Measure how fast a burst of queued messages is split out of a receive
+  buffer.  The "mid" column is the old approach of copying the rest of
+  the buffer after every message; the "reader" column uses
+  QRemoteFrameReader.  Both decode the same buffer of back to back
+  binary JSON frames.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <QDebug>
+
+#include <qremoteframereader.h>
+
+#include <iostream>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+/*
+  Build a buffer holding count frames of roughly size bytes each
+ */
+
+static QByteArray makeBurst(int count, int size)
+{
+    QJsonObject object;
+    object.insert(QStringLiteral("event"), QStringLiteral("output"));
+    object.insert(QStringLiteral("id"), 1);
+    object.insert(QStringLiteral("stdout"), QString());
+    int overhead = QJsonDocument(object).toBinaryData().size();
+    object.insert(QStringLiteral("stdout"), QString(qMax(0, size - overhead), QLatin1Char('x')));
+    QByteArray frame = QJsonDocument(object).toBinaryData();
+
+    QByteArray burst;
+    burst.reserve(frame.size() * count);
+    for (int i = 0 ; i < count ; i++)
+        burst.append(frame);
+    return burst;
+}
+
+static int decodeWithMid(const QByteArray& burst)
+{
+    QByteArray buffer = burst;
+    int count = 0;
+    while (buffer.size() >= 12) {
+        qint32 message_size = qFromLittleEndian(((qint32 *)buffer.data())[2]) + 8;
+        if (buffer.size() < message_size)
+            break;
+        QByteArray msg = buffer.left(message_size);
+        buffer = buffer.mid(message_size);
+        if (!QJsonDocument::fromBinaryData(msg).object().isEmpty())
+            count++;
+    }
+    return count;
+}
+
+static int decodeWithReader(const QByteArray& burst)
+{
+    QRemoteFrameReader reader;
+    reader.append(burst);
+    int count = 0;
+    while (reader.hasFrame()) {
+        if (!reader.takeMessage().isEmpty())
+            count++;
+    }
+    return count;
+}
+
+/*
+  Return the decode rate in messages per second, taking the best of
+  several rounds
+ */
+
+static double measure(int (*decode)(const QByteArray&), const QByteArray& burst, int count, int rounds)
+{
+    qint64 best = -1;
+    for (int i = 0 ; i < rounds ; i++) {
+        QElapsedTimer timer;
+        timer.start();
+        int n = decode(burst);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (n != count)
+            qFatal("Decoded %d messages, expected %d", n, count);
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    return count * 1e9 / qMax(best, Q_INT64_C(1));
+}
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS]\n"
+             "\n"
+             "   -count N    Messages in each burst (default 10000)\n"
+             "   -size N     Approximate size of each message in bytes (default 100)\n"
+             "   -rounds N   Decodes of each burst; the best is reported (default 5)\n"
+             , qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int count = 10000;
+    int size = 100;
+    int rounds = 5;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-count") && args.size())
+            count = args.takeFirst().toInt();
+        else if (arg == QLatin1String("-size") && args.size())
+            size = args.takeFirst().toInt();
+        else if (arg == QLatin1String("-rounds") && args.size())
+            rounds = args.takeFirst().toInt();
+        else
+            usage();
+    }
+
+    QByteArray burst = makeBurst(count, size);
+    std::cout << "messages\tbytes\tmid msg/s\treader msg/s" << std::endl;
+    std::cout << count << "\t" << burst.size() << "\t"
+              << (qint64) measure(decodeWithMid, burst, count, rounds) << "\t"
+              << (qint64) measure(decodeWithReader, burst, count, rounds) << std::endl;
+    return 0;
+}
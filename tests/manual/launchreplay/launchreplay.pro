@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET   = tst_launchreplay
+CONFIG  -= app_bundle
+QT      += processmanager
+QT      -= gui
+
+SOURCES = tst_launchreplay.cpp
@@ -0,0 +1,283 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+/*
+  Replay a recorded launch trace through QLaunchPredictor and score it.
+
+  Each line of the trace holds an ISO 8601 time and a process identifier,
+  for example "2013-03-04T08:10:00 mail".  Blank lines and lines starting
+  with '#' are ignored.  Before each launch the tool asks the predictor
+  for its prewarm plan, counts a hit if a prelaunched instance for that
+  identifier is available, and then records the launch.  A consumed
+  instance is assumed to be ready again after the refill time.
+
+  For comparison the same trace is scored with no prelaunching, a single
+  generic prelaunched process that serves every launch, and one instance
+  of every identifier seen so far.  The "warm" column is the average
+  number of prelaunched instances at the time of a launch, which is a
+  proxy for the memory spent.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDateTime>
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QTextStream>
+#include <QDebug>
+
+#include <qlaunchpredictor.h>
+#include <qprocessinfo.h>
+
+#include <iostream>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+struct Launch {
+    QDateTime when;
+    QString   identifier;
+};
+
+enum Policy { NoPrelaunch, Generic, Everything, Predicted };
+
+static const char *policyName(Policy policy)
+{
+    switch (policy) {
+    case NoPrelaunch: return "none";
+    case Generic:     return "generic";
+    case Everything:  return "all";
+    case Predicted:   return "predictor";
+    }
+    return "";
+}
+
+static QList<Launch> readTrace(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        qFatal("Unable to open trace file '%s'", qPrintable(filename));
+
+    QList<Launch> trace;
+    QTextStream stream(&file);
+    int lineno = 0;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine().trimmed();
+        lineno++;
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+        QStringList fields = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+        Launch launch;
+        if (fields.size() == 2)
+            launch.when = QDateTime::fromString(fields.at(0), Qt::ISODate);
+        if (!launch.when.isValid())
+            qFatal("%s:%d: expected '<time> <identifier>'", qPrintable(filename), lineno);
+        launch.identifier = fields.at(1);
+        trace << launch;
+    }
+    return trace;
+}
+
+/*
+  Write a synthetic trace covering a number of days: a few habitual
+  launches with some jitter, plus occasional random ones.
+ */
+
+static void generateTrace(int days)
+{
+    qsrand(1);
+    QTextStream out(stdout);
+    QDate first(2013, 3, 4);
+    for (int day = 0 ; day < days ; day++) {
+        QDate date = first.addDays(day);
+        bool weekday = date.dayOfWeek() <= 5;
+        QList<Launch> launches;
+        Launch launch;
+
+        launch.when = QDateTime(date, QTime(7, 50)).addSecs(qrand() % 1800);
+        launch.identifier = QStringLiteral("mail");
+        launches << launch;
+        if (weekday) {
+            launch.when = QDateTime(date, QTime(7, 20)).addSecs(qrand() % 1200);
+            launch.identifier = QStringLiteral("news");
+            launches << launch;
+            launch.when = QDateTime(date, QTime(17, 30)).addSecs(qrand() % 1800);
+            launch.identifier = QStringLiteral("music");
+            launches << launch;
+            launch.when = launch.when.addSecs(60 + qrand() % 600);
+            launch.identifier = QStringLiteral("maps");
+            launches << launch;
+        }
+        int extra = qrand() % 4;
+        for (int i = 0 ; i < extra ; i++) {
+            launch.when = QDateTime(date, QTime(9 + qrand() % 12, qrand() % 60));
+            launch.identifier = QStringLiteral("camera");
+            launches << launch;
+        }
+        if (qrand() % 7 == 0) {
+            launch.when = QDateTime(date, QTime(qrand() % 24, qrand() % 60));
+            launch.identifier = QStringLiteral("settings");
+            launches << launch;
+        }
+
+        QMap<QDateTime, QString> sorted;
+        foreach (const Launch& l, launches)
+            sorted.insertMulti(l.when, l.identifier);
+        QMap<QDateTime, QString>::const_iterator it;
+        for (it = sorted.constBegin() ; it != sorted.constEnd() ; ++it)
+            out << it.key().toString(Qt::ISODate) << " " << it.value() << "\n";
+    }
+}
+
+struct Score {
+    Score() : hits(0), launches(0), warm(0) {}
+    int    hits;
+    int    launches;
+    qint64 warm;
+};
+
+static Score replay(const QList<Launch>& trace, Policy policy, QLaunchPredictor *predictor, int refill)
+{
+    Score score;
+    QHash<QString, QList<QDateTime> > busy;   // Times at which consumed instances are ready again
+    QSet<QString> seen;
+
+    foreach (const Launch& launch, trace) {
+        QHash<QString, int> plan;
+        switch (policy) {
+        case NoPrelaunch:
+            break;
+        case Generic:
+            plan.insert(QString(), 1);
+            break;
+        case Everything:
+            foreach (const QString& identifier, seen)
+                plan.insert(identifier, 1);
+            break;
+        case Predicted:
+            plan = predictor->prewarmPlan(launch.when);
+            break;
+        }
+
+        foreach (int count, plan)
+            score.warm += count;
+
+        QString key = (policy == Generic) ? QString() : launch.identifier;
+        QList<QDateTime>& pending = busy[key];
+        for (int i = pending.size() - 1 ; i >= 0 ; i--)
+            if (pending.at(i) <= launch.when)
+                pending.removeAt(i);
+        if (plan.value(key) > pending.size()) {
+            score.hits++;
+            pending << launch.when.addSecs(refill);
+        }
+        score.launches++;
+
+        seen.insert(launch.identifier);
+        if (predictor) {
+            QProcessInfo info;
+            info.setIdentifier(launch.identifier);
+            predictor->recordLaunch(info, launch.when);
+        }
+    }
+    return score;
+}
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS] TRACE\n"
+             "       %s -generate DAYS\n"
+             "\n"
+             "   -generate N   Write a synthetic trace of N days to stdout\n"
+             "   -budget N     Number of instances the predictor may keep (default unlimited)\n"
+             "   -threshold F  Predictor threshold (default 0.5)\n"
+             "   -refill N     Seconds before a consumed instance is ready again (default 10)\n"
+             , qPrintable(progname), qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int budget = 0;
+    qreal threshold = 0.5;
+    int refill = 10;
+    QString filename;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-generate") && args.size()) {
+            generateTrace(args.takeFirst().toInt());
+            return 0;
+        }
+        else if (arg == QLatin1String("-budget") && args.size())
+            budget = args.takeFirst().toInt();
+        else if (arg == QLatin1String("-threshold") && args.size())
+            threshold = args.takeFirst().toDouble();
+        else if (arg == QLatin1String("-refill") && args.size())
+            refill = args.takeFirst().toInt();
+        else if (!arg.startsWith(QLatin1Char('-')) && filename.isEmpty())
+            filename = arg;
+        else
+            usage();
+    }
+    if (filename.isEmpty())
+        usage();
+
+    QList<Launch> trace = readTrace(filename);
+    std::cout << "policy\tlaunches\thits\thit rate\twarm" << std::endl;
+    for (int p = NoPrelaunch ; p <= Predicted ; p++) {
+        Policy policy = static_cast<Policy>(p);
+        QLaunchPredictor predictor;
+        predictor.setThreshold(threshold);
+        predictor.setMemoryBudget(budget * predictor.instanceCost());
+        Score score = replay(trace, policy, &predictor, refill);
+        std::cout << policyName(policy) << "\t" << score.launches << "\t" << score.hits << "\t"
+                  << (score.launches ? 100.0 * score.hits / score.launches : 0.0) << "%\t"
+                  << (score.launches ? double(score.warm) / score.launches : 0.0) << std::endl;
+    }
+    return 0;
+}
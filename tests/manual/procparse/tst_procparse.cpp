@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*
+  Measure how many processes per second can be read from /proc.  Each
+  pass reads the stat and status file of every process on the host.
+  The "regex" column repeats the QRegExp and QByteArray::split parsing
+  that QExecutingProcessInfo used to do; the "parser" column constructs
+  a QExecutingProcessInfo, which now uses the allocation free tokenizer.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QFile>
+#include <QDebug>
+
+#include <qprocutils.h>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <iostream>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+static QList<pid_t> allPids()
+{
+    QList<pid_t> pids;
+    DIR *dir = ::opendir("/proc");
+    if (!dir)
+        qFatal("Unable to open /proc");
+    struct dirent *entry;
+    while ((entry = ::readdir(dir)) != NULL) {
+        if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9')
+            pids << ::strtol(entry->d_name, NULL, 10);
+    }
+    ::closedir(dir);
+    return pids;
+}
+
+/*
+  The old parser, kept here for comparison
+ */
+
+static bool regexParse(pid_t pid)
+{
+    static QRegExp statFile(QStringLiteral("^(\\d+) \\(.*\\) [RSDZTW] (\\d+) (\\d+) (\\d+)(?: \\d+){11} (\\d+) (\\d+)"));
+    QFile file(QString::fromLatin1("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    if (statFile.indexIn(QString::fromLocal8Bit(file.readAll())) != 0)
+        return false;
+    struct { int pid, ppid, pgrp, sid, priority, nice, uid, euid, suid, gid, egid, sgid; } data;
+    data.pid      = statFile.cap(1).toInt();
+    data.ppid     = statFile.cap(2).toInt();
+    data.pgrp     = statFile.cap(3).toInt();
+    data.sid      = statFile.cap(4).toInt();
+    data.priority = statFile.cap(5).toLong();
+    data.nice     = statFile.cap(6).toLong();
+
+    QFile status(QString::fromLatin1("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly))
+        return false;
+    char   buf[256];
+    qint64 len;
+    QList<gid_t> groups;
+    QString name;
+    while ((len = status.readLine(buf, 256)) != -1) {
+        if (!strncmp("Name:", buf, 5))
+            name = QString::fromLocal8Bit(buf + 6, len-6);
+        else if (!strncmp("Uid:", buf, 4)) {
+            QList<QByteArray> uids = QByteArray(buf + 5, len-5).split('\t');
+            data.uid  = uids.at(0).toInt();
+            data.euid = uids.at(1).toInt();
+            data.suid = uids.at(2).toInt();
+        }
+        else if (!strncmp("Gid:", buf, 4)) {
+            QList<QByteArray> gids = QByteArray(buf + 5, len-5).split('\t');
+            data.gid  = gids.at(0).toInt();
+            data.egid = gids.at(1).toInt();
+            data.sgid = gids.at(2).toInt();
+        }
+        else if (!strncmp("Groups:", buf, 7)) {
+            QList<QByteArray> list = QByteArray(buf+8, len-8).split(' ');
+            while (list.size()) {
+                bool ok;
+                gid_t group = list.takeFirst().toInt(&ok);
+                if (ok)
+                    groups.append(group);
+            }
+        }
+    }
+    return true;
+}
+
+static bool parserParse(pid_t pid)
+{
+    QExecutingProcessInfo info(pid);
+    return info.exists();
+}
+
+/*
+  Return the number of processes read per second
+ */
+
+static double measure(bool (*parse)(pid_t), const QList<pid_t>& pids, int passes, int *failed)
+{
+    *failed = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0 ; i < passes ; i++) {
+        foreach (pid_t pid, pids) {
+            if (!parse(pid))
+                (*failed)++;
+        }
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    return pids.size() * passes * 1e9 / qMax(elapsed, Q_INT64_C(1));
+}
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS]\n"
+             "\n"
+             "   -passes N     Number of passes over /proc (default 50)\n"
+             , qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int passes = 50;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-passes") && args.size())
+            passes = qMax(1, args.takeFirst().toInt());
+        else
+            usage();
+    }
+
+    QList<pid_t> pids = allPids();
+    int regexFailed, parserFailed;
+    double regex = measure(regexParse, pids, passes, &regexFailed);
+    double parser = measure(parserParse, pids, passes, &parserFailed);
+
+    std::cout << "pids\tregex/s\tparser/s\tregex failed\tparser failed" << std::endl;
+    std::cout << pids.size() << "\t"
+              << (qint64) regex << "\t"
+              << (qint64) parser << "\t"
+              << regexFailed << "\t"
+              << parserFailed << std::endl;
+    return 0;
+}
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET   = tst_psiload
+CONFIG  -= app_bundle
+QT      += processmanager
+QT      -= gui
+
+SOURCES = tst_psiload.cpp
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET   = tst_rulebench
+CONFIG  -= app_bundle
+QT      += qml processmanager processmanager-declarative
+QT      -= gui
+
+SOURCES = tst_rulebench.cpp
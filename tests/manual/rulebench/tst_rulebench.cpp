@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+/*
+  Measure how many processes per second QProcessBackendManager::create()
+  can hand out when every factory carries a match and a rewrite delegate.
+  The "script" column uses PmScriptMatch and PmScriptRewrite, which
+  evaluate JavaScript for each call.  The "rules" column uses the compiled
+  RuleMatchDelegate and RuleRewriteDelegate with an "equals" rule, which
+  also lets the backend manager index the factories.  The "regex" column
+  uses a regular expression rule instead, so every factory is still asked
+  and only the cost of the compiled rules is measured.  Processes are
+  created but never started.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QDebug>
+
+#include <qdeclarativeprocessmanager.h>
+#include <qprocessbackendmanager.h>
+#include <qstandardprocessbackendfactory.h>
+#include <qprocessbackend.h>
+#include <qprocessinfo.h>
+#include <qmatchdelegate.h>
+#include <qrewritedelegate.h>
+
+#include <iostream>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+enum Mode { Script, Rules, Regex };
+
+static QObject *createObject(QQmlEngine& engine, const QString& qml)
+{
+    QQmlComponent component(&engine);
+    component.setData(qml.toUtf8(), QUrl());
+    QObject *object = component.create();
+    if (!object)
+        qFatal("Unable to create object: %s", qPrintable(component.errorString()));
+    return object;
+}
+
+static QProcessBackendManager *makeManager(QQmlEngine& engine, Mode mode, int factories)
+{
+    QProcessBackendManager *manager = new QProcessBackendManager;
+    manager->setIdleDelegate(0);
+    for (int i = 0 ; i < factories ; i++) {
+        QString match, rewrite;
+        switch (mode) {
+        case Script:
+            match = QString::fromLatin1("PmScriptMatch { script: model.identifier == \"app%1\" }").arg(i);
+            rewrite = QStringLiteral("PmScriptRewrite { script: { var args = model.arguments; "
+                                     "args.push(\"--verbose\"); model.arguments = args; } }");
+            break;
+        case Rules:
+            match = QString::fromLatin1("RuleMatchDelegate { rules: [ { key: \"identifier\", equals: \"app%1\" } ] }").arg(i);
+            rewrite = QStringLiteral("RuleRewriteDelegate { rules: [ { key: \"arguments\", append: \"--verbose\" } ] }");
+            break;
+        case Regex:
+            match = QString::fromLatin1("RuleMatchDelegate { rules: [ { key: \"identifier\", matches: \"^app%1$\" } ] }").arg(i);
+            rewrite = QStringLiteral("RuleRewriteDelegate { rules: [ { key: \"arguments\", append: \"--verbose\" } ] }");
+            break;
+        }
+        const QString header = QStringLiteral("import Test 1.0; ");
+        QStandardProcessBackendFactory *factory = new QStandardProcessBackendFactory;
+        factory->setMatchDelegate(qobject_cast<QMatchDelegate *>(createObject(engine, header + match)));
+        factory->setRewriteDelegate(qobject_cast<QRewriteDelegate *>(createObject(engine, header + rewrite)));
+        manager->addFactory(factory);
+    }
+    return manager;
+}
+
+/*
+  Return the number of processes created per second
+ */
+
+static double measure(QQmlEngine& engine, Mode mode, int factories, int count)
+{
+    QProcessBackendManager *manager = makeManager(engine, mode, factories);
+    QProcessInfo info;
+    info.setProgram(QStringLiteral("/bin/true"));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0 ; i < count ; i++) {
+        info.setIdentifier(QString::fromLatin1("app%1").arg(i % factories));
+        QProcessBackend *backend = manager->create(info);
+        if (!backend)
+            qFatal("No factory for %s", qPrintable(info.identifier()));
+        delete backend;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    delete manager;
+    return count * 1e9 / qMax(elapsed, Q_INT64_C(1));
+}
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS]\n"
+             "\n"
+             "   -factories N  Number of factories (default 20)\n"
+             "   -count N      Number of processes to create (default 2000)\n"
+             , qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int factories = 20;
+    int count = 2000;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-factories") && args.size())
+            factories = qMax(1, args.takeFirst().toInt());
+        else if (arg == QLatin1String("-count") && args.size())
+            count = args.takeFirst().toInt();
+        else
+            usage();
+    }
+
+    QDeclarativeProcessManager::registerTypes("Test");
+    QQmlEngine engine;
+
+    std::cout << "factories\tscript/s\trules/s\tregex/s" << std::endl;
+    std::cout << factories << "\t"
+              << (qint64) measure(engine, Script, factories, count) << "\t"
+              << (qint64) measure(engine, Rules, factories, count) << "\t"
+              << (qint64) measure(engine, Regex, factories, count) << std::endl;
+    return 0;
+}
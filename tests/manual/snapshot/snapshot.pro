@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET   = tst_snapshot
+CONFIG  -= app_bundle
+QT      += processmanager
+QT      -= gui
+
+SOURCES = tst_snapshot.cpp
@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtAddOn.JsonStream module of the Qt.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*
+  Update a QProcessSnapshot on a timer and print what changed, how
+  long each update took and how much CPU this program used.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+
+#include <qprocesssnapshot.h>
+#include <iostream>
+#include <unistd.h>
+
+QT_USE_NAMESPACE_PROCESSMANAGER
+
+QString progname;
+
+class Target : public QObject {
+    Q_OBJECT
+
+public:
+    Target(QProcessSnapshot *snapshot, bool verbose)
+        : m_snapshot(snapshot), m_verbose(verbose), m_spawned(0), m_exited(0), m_changed(0) {}
+
+    void update() {
+        QElapsedTimer timer;
+        timer.start();
+        m_snapshot->update();
+        qint64 elapsed = timer.nsecsElapsed() / 1000;
+        int self = m_snapshot->indexOf(::getpid());
+        std::cout << m_snapshot->count() << " processes, "
+                  << m_spawned << " spawned, " << m_exited << " exited, "
+                  << m_changed << " changed, update " << elapsed << " us, "
+                  << "self " << (self >= 0 ? m_snapshot->cpuUsage(self) * 100 : 0) << "% cpu"
+                  << std::endl;
+        m_spawned = m_exited = m_changed = 0;
+    }
+
+public slots:
+    void timeout() { update(); }
+    void spawned(const QPidList& pids) { m_spawned = pids.size(); print("spawned", pids); }
+    void exited(const QPidList& pids) { m_exited = pids.size(); print("exited", pids); }
+    void changed(const QPidList& pids) { m_changed = pids.size(); print("changed", pids); }
+
+private:
+    void print(const char *what, const QPidList& pids) {
+        if (!m_verbose)
+            return;
+        std::cout << what << ":";
+        foreach (Q_PID pid, pids)
+            std::cout << " " << pid;
+        std::cout << std::endl;
+    }
+
+    QProcessSnapshot *m_snapshot;
+    bool m_verbose;
+    int  m_spawned, m_exited, m_changed;
+};
+
+static void usage()
+{
+    qWarning("Usage: %s [ARGS]\n"
+             "\n"
+             "   -interval MSEC  Time between updates (default 1000)\n"
+             "   -verbose        Print the pids that changed\n"
+             , qPrintable(progname));
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = QCoreApplication::arguments();
+    progname = args.takeFirst();
+    int interval = 1000;
+    bool verbose = false;
+    while (args.size()) {
+        QString arg = args.takeFirst();
+        if (arg == QLatin1String("-interval") && args.size())
+            interval = qMax(1, args.takeFirst().toInt());
+        else if (arg == QLatin1String("-verbose"))
+            verbose = true;
+        else
+            usage();
+    }
+
+    QProcessSnapshot snapshot;
+    Target t(&snapshot, verbose);
+    QObject::connect(&snapshot, SIGNAL(spawned(const QPidList&)), &t, SLOT(spawned(const QPidList&)));
+    QObject::connect(&snapshot, SIGNAL(exited(const QPidList&)), &t, SLOT(exited(const QPidList&)));
+    QObject::connect(&snapshot, SIGNAL(changed(const QPidList&)), &t, SLOT(changed(const QPidList&)));
+
+    QTimer timer;
+    QObject::connect(&timer, SIGNAL(timeout()), &t, SLOT(timeout()));
+    timer.start(interval);
+    t.update();
+    return app.exec();
+}
+
+#include "tst_snapshot.moc"